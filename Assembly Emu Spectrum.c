@@ -1,5221 +1,8092 @@
-#define _CRT_SECURE_NO_WARNINGS
-#define MEMORY_SIZE 10000  // Adjust this value as needed
-#define INITIAL_CAPACITY 1000 // Initial capacity for instructions and labels
-#include <ctype.h> // Added to fix 'toupper' undefined
-#include <inttypes.h>
-#include <math.h>
-#include <stdbool.h>
-#include <stdint.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <windows.h>
-#include <assert.h>
-
-#ifndef MEMORY_H
-#define MEMORY_H
-
-#include <stdint.h>
-#define MEMORY_H
-
-#ifdef _WIN32
-#include <string.h>
-#define strcasecmp _stricmp
-#else
-#include <strings.h>
-#endif
-
-// Enum to represent number formats
-typedef enum {
-    Decimal,
-    HEX
-} NumberFormat;
-
-// Instruction types (expanded)
-typedef enum {
-    // Data Movement
-    INST_MOV,       // Move data
-    INST_PUSH,      // Push to stack
-    INST_POP,       // Pop from stack
-    INST_XCHG,      // Exchange register values
-
-    // Arithmetic
-    INST_ADD,       // Addition
-    INST_SUB,       // Subtraction
-    INST_MUL,       // Multiplication
-    INST_DIV,       // Division
-    INST_INC,       // Increment
-    INST_DEC,       // Decrement
-    INST_NEG,       // Negate
-    INST_CMP,       // Compare
-
-    // Logical
-    INST_AND,       // Bitwise AND
-    INST_OR,        // Bitwise OR
-    INST_XOR,       // Bitwise XOR
-    INST_NOT,       // Bitwise NOT
-
-    // Shift and Rotate
-    INST_SHL,       // Shift Left
-    INST_SHR,       // Shift Right
-    INST_ROL,       // Rotate Left
-    INST_ROR,       // Rotate Right
-
-    // Control Flow
-    INST_JMP,       // Unconditional Jump
-    INST_JE,        // Jump if Equal
-    INST_JNE,       // Jump if Not Equal
-    INST_JG,        // Jump if Greater
-    INST_JGE,       // Jump if Greater or Equal
-    INST_JL,        // Jump if Less
-    INST_JLE,       // Jump if Less or Equal
-    INST_JA,        // Jump if Above (Unsigned Greater)
-    INST_JAE,       // Jump if Above or Equal (Unsigned Greater or Equal)
-    INST_JB,        // Jump if Below (Unsigned Less)
-    INST_JBE,       // Jump if Below or Equal (Unsigned Less or Equal)
-    INST_JO,        // Jump if Overflow
-    INST_JNO,       // Jump if No Overflow
-    INST_JS,        // Jump if Sign (Negative)
-    INST_JNS,       // Jump if No Sign (Non-Negative)
-    INST_JP,        // Jump if Parity Even
-    INST_JNP,       // Jump if No Parity (Parity Odd)
-
-    // Custom Instructions
-    INST_POW,       // Power operation
-    INST_ROOT,      // Root operation
-    INST_AVG,       // Average operation
-    INST_MOD,       // Mod operation
-    INST_MIRROR,    // Mirror operation
-    INST_ISPRIME,   // Check if the num is prime operation
-    INST_MAX,       // Choose the max num of 3 PARAMETERS
-    INST_MIN,       // Choose the min num of 3 parameters
-
-    // Misc
-    INST_LABEL,     // Label for jumps
-    INST_COMMENT,
-    INST_NOP,        // No operation
-    INST_INT         // INT
-} InstructionType;
-
-#define MEMORY_SIZE 1024 * 1024  // Memory size is 1MB
-uint8_t memory[MEMORY_H];
-void write_memory(void* emu, uint64_t address, uint64_t value,size_t size);
-uint64_t read_memory(void* emu, uint64_t address, size_t size) {
-    // Check if the address is within valid memory bounds
-    if (address >= MEMORY_SIZE || address + size > MEMORY_SIZE) {
-        fprintf(stderr, "Error: Memory access out of bounds at address 0x%llx\n", address);
-        return 0;
-    }
-
-    // Handle different size reads
-    uint64_t result = 0;
-    switch (size) {
-        case sizeof(uint8_t):
-            result = *(uint8_t*)&memory[address];
-        break;
-        case sizeof(uint16_t):
-            result = *(uint16_t*)&memory[address];
-        break;
-        case sizeof(uint32_t):
-            result = *(uint32_t*)&memory[address];
-        break;
-        case sizeof(uint64_t):
-            result = *(uint64_t*)&memory[address];
-        break;
-        default:
-            fprintf(stderr, "Error: Unsupported memory read size %zu\n", size);
-        return 0;
-    }
-
-    return result;
-}
-
-// Comprehensive Emulator Structure with Multiple Register Sizes
-typedef struct {
-    // General-purpose registers with multiple sizes
-    union {
-        struct {
-            union {
-                uint64_t rax;   // 64-bit
-                struct {
-                    uint32_t eax;   // 32-bit
-                };
-            };
-            union {
-                uint64_t rbx;
-                struct {
-                    uint32_t ebx;
-
-                };
-            };
-            union {
-                uint64_t rcx;
-                struct {
-                    uint32_t ecx;
-
-                };
-            };
-            union {
-                uint64_t rdx;
-                struct {
-                    uint32_t edx;
-
-                };
-            };
-            union {
-                uint64_t rsi;
-                struct {
-                    uint32_t esi;
-
-                };
-            };
-            union {
-                uint64_t rdi;
-                struct {
-                    uint32_t edi;
-
-                };
-            };
-            union {
-                uint64_t rsp;
-                struct {
-                    uint32_t esp;
-
-                };
-            };
-            union {
-                uint64_t rbp;
-                struct {
-                    uint32_t ebp;
-
-                };
-            };
-            // Additional general-purpose registers
-            union {
-                uint64_t r8;
-                struct {
-                    uint32_t r8d;
-
-                };
-            };
-            union {
-                uint64_t r9;
-                struct {
-                    uint32_t r9d;
-
-                };
-            };
-            union {
-                uint64_t r10;
-                struct {
-                    uint32_t r10d;
-
-                };
-            };
-            union {
-                uint64_t r11;
-                struct {
-                    uint32_t r11d;
-
-                };
-            };
-            union {
-                uint64_t r12;
-                struct {
-                    uint32_t r12d;
-
-                };
-            };
-            union {
-                uint64_t r13;
-                struct {
-                    uint32_t r13d;
-
-                };
-            };
-            union {
-                uint64_t r14;
-                struct {
-                    uint32_t r14d;
-
-                };
-            };
-            union {
-                uint64_t r15;
-                struct {
-                    uint32_t r15d;
-
-                };
-            };
-        };
-        uint64_t registers[16];  // Allow indexing by number
-    };
-
-    // Instruction pointer
-    uint64_t rip;
-
-    // Flags register (more comprehensive)
-    struct {
-        uint8_t carry : 1;      // CF: Carry flag
-        uint8_t reserved1 : 1;  // Reserved
-        uint8_t parity : 1;     // PF: Parity flag
-        uint8_t reserved2 : 1;  // Reserved
-        uint8_t auxiliary : 1;  // AF: Auxiliary carry flag
-        uint8_t reserved3 : 1;  // Reserved
-        uint8_t zero : 1;       // ZF: Zero flag
-        uint8_t sign : 1;       // SF: Sign flag
-        uint8_t trap : 1;       // TF: Trap flag
-        uint8_t interrupt : 1;  // IF: Interrupt flag
-        uint8_t direction : 1;  // DF: Direction flag
-        uint8_t overflow : 1;   // OF: Overflow flag
-        uint8_t reserved4 : 4;  // Reserved for future use
-        uint8_t alignment : 1;  // Alignment check flag
-    } flags;
-
-    // Segment registers
-    uint16_t cs, ds, ss, es, fs, gs;
-
-    // Memory representation
-    uint8_t* memory;
-    size_t memory_size;
-
-    // Stack
-    uint8_t* stack;
-    size_t stack_size;
-} Emulator;
-
-
-// Instruction structure with NumberFormat
-typedef struct {
-    InstructionType type;
-    char label[32];        // Label name (for INST_LABEL)
-    uint64_t* dest_reg;    // Destination register
-    uint64_t* src_reg;     // Source register (if applicable)
-    uint64_t* aux_reg;     // Auxiliary register (for some operations)
-    uint64_t immediate;    // Immediate value
-    bool dest_is_memory;   // True if destination is memory
-    bool src_is_memory;    // True if source is memory
-    bool jump_is_memory;
-    bool aux_is_memory;
-    uint64_t memory_address;
-    uint64_t target_address;
-    NumberFormat format;   // Number format of the immediate value
-    uint64_t rd;           // Instruction index
-    uint64_t dest_mem_address;
-    uint64_t src_mem_address;
-    uint64_t aux_mem_address;
-    uint64_t jump_mem_address;
-    uint64_t aux_immediate;
-    uint64_t src_immediate;
-    char dest_reg_name[32]; // Original destination register name
-    char src_reg_name[32];  // Original source register name
-    char aux_reg_name[32];  // Original Aux Register Name
-    uint64_t function;
-    char* immediate_string;
-    bool src_is_string;     // Added: True if source is a string literal
-    char src_string[256];   // Added: Buffer to hold the string literal
-} Instruction;
-
-//Function to parse labels and map them to instruction indices
-typedef struct {
-    char label[32];
-    size_t index;
-} Label;
-
-
-// Global interrupt handler map
-typedef void (*InterruptHandler)(Emulator*, Instruction*);
-InterruptHandler interrupt_handlers[256] = { NULL };
-
-// Global tracing flag
-bool tracing_enabled = false;
-
-// Function prototypes
-Emulator* create_emulator(size_t memory_size, size_t stack_size);
-void destroy_emulator(Emulator* emu);
-void execute_instruction(Emulator* emu, Instruction* inst, size_t inst_num, Label* labels, size_t label_count);
-void print_emulator_state(Emulator* emu, const char* phase);
-void print_reg(const char* name, uint64_t value, NumberFormat format, size_t size);
-const char* get_register_name(Emulator* emu, uint64_t* reg_ptr);
-uint64_t* get_register_pointer(Emulator* emu, const char* reg_name);
-InstructionType get_instruction_type(const char* instr_str);
-void execute_file_instructions(Emulator* emu, const char* filename);
-void run_comprehensive_example(Emulator* emu);
-void resize_instructions(Instruction** instructions, size_t* capacity);
-void resize_labels(Label** labels, size_t* capacity);
-void demonstrate_memory_operations(Emulator* emu);
-void int_21h_handler(Emulator* emu, Instruction* inst);
-void int_22h_handler(Emulator* emu, Instruction* inst);
-void int_23h_handler(Emulator* emu, Instruction* inst);
-void initialize_interrupt_handlers() {
-    interrupt_handlers[0x21] = int_21h_handler; // Map INT 21h to the MessageBox handler
-    interrupt_handlers[0x22] = int_22h_handler; // Map INT 22h to the WriteConsole handler
-    interrupt_handlers[0x23] = int_23h_handler; // Map INT 23h to the ReadConsole handler
-}
-
-uint64_t pop(Emulator* emu);
-void push(Emulator* emu, uint64_t value);
-void push_to_stack(Emulator* emu, uint64_t value);
-uint64_t pop_from_stack(Emulator* emu);
-
-// Custom instruction implementations
-void execute_root_instruction(Emulator* emu, Instruction* inst);
-void execute_avg_instruction(Emulator* emu, Instruction* inst);
-void execute_pow_instruction(Emulator* emu, Instruction* inst);
-void execute_mod_instruction(Emulator* emu, Instruction* inst);
-bool is_prime(uint64_t n);
-void execute_isprime_instruction(Emulator* emu, Instruction* inst);
-uint64_t mirror_decimal(uint64_t decimal_value);
-void execute_mirror_instruction(Emulator* emu, Instruction* inst);
-void execute_min_instruction(Emulator* emu, Instruction* inst);
-void execute_max_instruction(Emulator* emu, Instruction* inst);
-
-// Create a new emulator instance
-Emulator* create_emulator(size_t memory_size, size_t stack_size) {
-    Emulator* emu = malloc(sizeof(Emulator));
-    if (!emu) {
-        fprintf(stderr, "Memory allocation failed for emulator\n");
-        exit(1);
-    }
-
-    // Zero out all registers
-    memset(emu->registers, 0, sizeof(emu->registers));
-
-    // Initialize flags
-    memset(&emu->flags, 0, sizeof(emu->flags));
-
-    // Initialize segment registers
-    emu->cs = emu->ds = emu->ss = emu->es = emu->fs = emu->gs = 0;
-
-    // Allocate memory
-    emu->memory = calloc(memory_size, sizeof(uint8_t));
-    if (!emu->memory) {
-        fprintf(stderr, "Memory allocation failed for emulator memory\n");
-        free(emu);
-        exit(1);
-    }
-    emu->memory_size = memory_size;
-
-    // Allocate stack
-    emu->stack = calloc(stack_size, sizeof(uint8_t));
-    if (!emu->stack) {
-        fprintf(stderr, "Memory allocation failed for stack\n");
-        free(emu->memory);
-        free(emu);
-        exit(1);
-    }
-    emu->stack_size = stack_size;
-
-    // Initialize stack pointer (pointing to the top of the stack)
-    emu->rsp = (uint64_t)(uintptr_t)(emu->stack) + stack_size - sizeof(uint64_t);
-
-    // Initialize instruction pointer
-    emu->rip = 0;
-
-    return emu;
-}
-
-
-
-void initialize_emulator(Emulator* emu, size_t memory_size, size_t stack_size) {
-    // Allocate memory for main memory
-    emu->memory = (uint8_t*)malloc(memory_size);
-    if (!emu->memory) {
-        fprintf(stderr, "Failed to allocate emulator memory!\n");
-        exit(1);
-    }
-    emu->memory_size = memory_size;
-    memset(emu->memory, 0, memory_size); // Initialize memory to zero
-
-    // Allocate memory for the stack
-    emu->stack = (uint8_t*)malloc(stack_size);
-    if (!emu->stack) {
-        fprintf(stderr, "Failed to allocate stack memory!\n");
-        free(emu->memory); // Clean up memory if stack allocation fails
-        exit(1);
-    }
-    emu->stack_size = stack_size;
-    memset(emu->stack, 0, stack_size); // Initialize stack to zero
-
-    // Initialize the stack pointer (RSP) to the top of the stack
-    emu->rsp = stack_size;
-
-    printf("Emulator initialized with %zu bytes of memory and %zu bytes of stack.\n", memory_size, stack_size);
-}
-
-
-void push(Emulator* emu, uint64_t value) {
-    if (emu->rsp < sizeof(uint64_t)) {
-        fprintf(stderr, "Stack overflow!\n");
-        exit(1);
-    }
-    emu->rsp -= sizeof(uint64_t); // Decrement stack pointer
-    memcpy(&emu->stack[emu->rsp], &value, sizeof(uint64_t)); // Write to stack
-}
-
-uint64_t pop(Emulator* emu) {
-    if (emu->rsp >= emu->stack_size) {
-        fprintf(stderr, "Stack underflow!\n");
-        exit(1);
-    }
-    uint64_t value = 0;
-    memcpy(&value, &emu->stack[emu->rsp], sizeof(uint64_t)); // Read from stack
-    emu->rsp += sizeof(uint64_t); // Increment stack pointer
-    return value;
-}
-
-
-// Function to resize the instruction array
-void resize_instructions(Instruction** instructions, size_t* capacity) {
-    *capacity *= 2;
-    *instructions = realloc(*instructions, *capacity * sizeof(Instruction));
-    if (*instructions == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for instructions\n");
-        exit(1);
-    }
-}
-
-// Function to resize the label array
-void resize_labels(Label** labels, size_t* capacity) {
-    *capacity *= 2;
-    *labels = realloc(*labels, *capacity * sizeof(Label));
-    if (*labels == NULL) {
-        fprintf(stderr, "Error: Memory allocation failed for labels\n");
-        exit(1);
-    }
-}
-
-void int_21h_handler(Emulator* emu, Instruction* inst) {
-    if (inst->immediate == 0x09) { // Display a message
-        // Read the value from memory starting at the address in RAX
-        uint64_t message_address = emu->rax;
-        if (message_address >= MEMORY_SIZE) { // Check bounds
-            fprintf(stderr, "Error: Message address out of bounds\n");
-            exit(EXIT_FAILURE);
-        }
-
-        // Read the ASCII string from memory
-        char message[256]; // Buffer to hold the message
-        size_t i = 0;
-        while (i < sizeof(message) - 1) {
-            uint8_t byte = read_memory(emu, message_address + i, sizeof(uint8_t));
-            message[i++] = byte;
-            if (byte == '\0') break; // Stop at null terminator
-        }
-        message[i] = '\0'; // Ensure null-termination
-
-        // Display the message in a message box
-        MessageBoxA(NULL, message, "Message from Emulator", MB_OK);
-    }
-}
-void int_22h_handler(Emulator* emu, Instruction* inst) {
-    if (inst->immediate == 0x01) { // Write a text value to the console
-        // Read the value from memory starting at the address in RAX
-        uint64_t value_address = emu->rax;
-        if (value_address >= MEMORY_SIZE) { // Check bounds
-            fprintf(stderr, "Error: Value address out of bounds\n");
-            exit(EXIT_FAILURE);
-        }
-
-        // Read the ASCII string from memory
-        char message[256]; // Buffer to hold the message
-        size_t i = 0;
-        while (i < sizeof(message) - 1) {
-            uint8_t byte = read_memory(emu, value_address + i, sizeof(uint8_t));
-            if (byte == '\0') break; // Stop at null terminator
-            message[i++] = byte;
-        }
-        message[i] = '\0'; // Null-terminate the string
-
-        // Write the ASCII string to the console
-        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        DWORD bytesWritten;
-        WriteConsole(hConsole, message, strlen(message), &bytesWritten, NULL);
-    }
-}
-void int_23h_handler(Emulator* emu, Instruction* inst) {
-    if (inst->immediate == 0x01) { // Read from console
-        char buffer[256];
-        // Read input from the console
-        printf("Enter Input: ");  // Added space here
-        HANDLE hConsole = GetStdHandle(STD_INPUT_HANDLE);
-        DWORD bytesRead;
-        ReadConsole(hConsole, buffer, 255, &bytesRead, NULL);
-        buffer[bytesRead] = '\0'; // Null-terminate the string
-
-        // Debug log: Print the input string
-        printf("INT 23h: Read input value: '0x%llX' \n", buffer);  // Added newline here
-
-        // Write the input string to memory starting at the address in RAX
-        uint64_t value_address = emu->rax;
-
-        // Debug log: Print the memory address
-        printf("INT 23h: Writing to memory address: 0x%llX\n", value_address);  // Added newline here
-
-        // Check if the memory address is valid
-        if (value_address >= MEMORY_SIZE) {
-            fprintf(stderr, "Error: Memory address 0x%llX is out of bounds\n", value_address);
-            exit(EXIT_FAILURE);
-        }
-
-        // Check if the input string fits in memory
-        if (value_address + bytesRead > MEMORY_SIZE) {
-            fprintf(stderr, "Error: Input string too large for memory\n");
-            exit(EXIT_FAILURE);
-        }
-
-        // Write each character to memory
-        for (size_t i = 0; i < bytesRead; ++i) {
-            write_memory(emu, value_address + i, buffer[i], sizeof(uint8_t));
-        }
-
-        // Null-terminate the string in memory
-        write_memory(emu, value_address + bytesRead, '\0', sizeof(uint8_t));
-
-        // Debug log: Confirm the write operation
-       printf("INT 23h: Wrote value 0x%llX to memory address 0x%llX\n", buffer, value_address);  // Added newline here
-    }
-}
-
-// Free emulator resources
-void destroy_emulator(Emulator* emu) {
-    if (emu) {
-        free(emu->memory);
-        free(emu->stack);
-        free(emu);
-    }
-}
-
-// Function to get register name from pointer (Updated)
-const char* get_register_name(Emulator* emu, uint64_t* reg_ptr) {
-    void* ptr = (void*)reg_ptr; // Cast to void* to allow comparison
-
-    // Check 32-bit registers first
-    if (ptr == (void*)&emu->eax) return "EAX";
-    if (ptr == (void*)&emu->ebx) return "EBX";
-    if (ptr == (void*)&emu->ecx) return "ECX";
-    if (ptr == (void*)&emu->edx) return "EDX";
-    if (ptr == (void*)&emu->esi) return "ESI";
-    if (ptr == (void*)&emu->edi) return "EDI";
-    if (ptr == (void*)&emu->esp) return "ESP";
-    if (ptr == (void*)&emu->ebp) return "EBP";
-    if (ptr == (void*)&emu->r8d) return "R8D";
-    if (ptr == (void*)&emu->r9d) return "R9D";
-    if (ptr == (void*)&emu->r10d) return "R10D";
-    if (ptr == (void*)&emu->r11d) return "R11D";
-    if (ptr == (void*)&emu->r12d) return "R12D";
-    if (ptr == (void*)&emu->r13d) return "R13D";
-    if (ptr == (void*)&emu->r14d) return "R14D";
-    if (ptr == (void*)&emu->r15d) return "R15D";
-
-    // Then check 64-bit registers
-    if (ptr == (void*)&emu->rax) return "RAX";
-    if (ptr == (void*)&emu->rbx) return "RBX";
-    if (ptr == (void*)&emu->rcx) return "RCX";
-    if (ptr == (void*)&emu->rdx) return "RDX";
-    if (ptr == (void*)&emu->rsi) return "RSI";
-    if (ptr == (void*)&emu->rdi) return "RDI";
-    if (ptr == (void*)&emu->rsp) return "RSP";
-    if (ptr == (void*)&emu->rbp) return "RBP";
-    if (ptr == (void*)&emu->r8) return "R8";
-    if (ptr == (void*)&emu->r9) return "R9";
-    if (ptr == (void*)&emu->r10) return "R10";
-    if (ptr == (void*)&emu->r11) return "R11";
-    if (ptr == (void*)&emu->r12) return "R12";
-    if (ptr == (void*)&emu->r13) return "R13";
-    if (ptr == (void*)&emu->r14) return "R14";
-    if (ptr == (void*)&emu->r15) return "R15";
-
-    return "UNKNOWN";
-}
-
-
-
-// Function to get register pointer from name
-uint64_t* get_register_pointer(Emulator* emu, const char* reg_name) {
-    // Convert register name to uppercase for case-insensitive comparison
-    char reg_upper[16];
-    size_t len = strlen(reg_name);
-    if (len >= sizeof(reg_upper)) len = sizeof(reg_upper) - 1;
-    for (size_t i = 0; i < len; i++) {
-        reg_upper[i] = toupper((unsigned char)reg_name[i]);
-    }
-    reg_upper[len] = '\0';
-
-    if (strcmp(reg_upper, "RAX") == 0) return &emu->rax;
-    if (strcmp(reg_upper, "EAX") == 0) return (uint64_t*)&emu->eax;
-
-    if (strcmp(reg_upper, "RBX") == 0) return &emu->rbx;
-    if (strcmp(reg_upper, "EBX") == 0) return (uint64_t*)&emu->ebx;
-
-    if (strcmp(reg_upper, "RCX") == 0) return &emu->rcx;
-    if (strcmp(reg_upper, "ECX") == 0) return (uint64_t*)&emu->ecx;
-
-
-    if (strcmp(reg_upper, "RDX") == 0) return &emu->rdx;
-    if (strcmp(reg_upper, "EDX") == 0) return (uint64_t*)&emu->edx;
-
-
-    if (strcmp(reg_upper, "RSI") == 0) return &emu->rsi;
-    if (strcmp(reg_upper, "ESI") == 0) return (uint64_t*)&emu->esi;
-
-
-    if (strcmp(reg_upper, "RDI") == 0) return &emu->rdi;
-    if (strcmp(reg_upper, "EDI") == 0) return (uint64_t*)&emu->edi;
-
-
-
-    if (strcmp(reg_upper, "RSP") == 0) return &emu->rsp;
-    if (strcmp(reg_upper, "ESP") == 0) return (uint64_t*)&emu->esp;
-
-
-    if (strcmp(reg_upper, "RBP") == 0) return &emu->rbp;
-    if (strcmp(reg_upper, "EBP") == 0) return (uint64_t*)&emu->ebp;
-
-
-    if (strcmp(reg_upper, "R8") == 0) return &emu->r8;
-    if (strcmp(reg_upper, "R8D") == 0) return (uint64_t*)&emu->r8d;
-
-
-    if (strcmp(reg_upper, "R9") == 0) return &emu->r9;
-    if (strcmp(reg_upper, "R9D") == 0) return (uint64_t*)&emu->r9d;
-
-
-    if (strcmp(reg_upper, "R10") == 0) return &emu->r10;
-    if (strcmp(reg_upper, "R10D") == 0) return (uint64_t*)&emu->r10d;
-
-    if (strcmp(reg_upper, "R11") == 0) return &emu->r11;
-    if (strcmp(reg_upper, "R11D") == 0) return (uint64_t*)&emu->r11d;
-
-    if (strcmp(reg_upper, "R12") == 0) return &emu->r12;
-    if (strcmp(reg_upper, "R12D") == 0) return (uint64_t*)&emu->r12d;
-
-    if (strcmp(reg_upper, "R13") == 0) return &emu->r13;
-    if (strcmp(reg_upper, "R13D") == 0) return (uint64_t*)&emu->r13d;
-
-    if (strcmp(reg_upper, "R14") == 0) return &emu->r14;
-    if (strcmp(reg_upper, "R14D") == 0) return (uint64_t*)&emu->r14d;
-
-
-    if (strcmp(reg_upper, "R15") == 0) return &emu->r15;
-    if (strcmp(reg_upper, "R15D") == 0) return (uint64_t*)&emu->r15d;
-
-    return NULL;
-}
-
-// Function to determine register size based on register name
-size_t get_register_size(const char* reg_name) {
-    // Convert register name to uppercase for case-insensitive comparison
-    char reg_upper[16];
-    size_t len = strlen(reg_name);
-    if (len >= sizeof(reg_upper)) len = sizeof(reg_upper) - 1;
-    for (size_t i = 0; i < len; i++) {
-        reg_upper[i] = toupper((unsigned char)reg_name[i]);
-    }
-    reg_upper[len] = '\0';
-
-    // Determine size based on suffix
-    if (strstr(reg_upper, "D")) return 32;
-    if (strlen(reg_upper) >= 2 && reg_upper[1] == 'D') return 32;
-    if (strlen(reg_upper) >= 2 && reg_upper[1] == 'I') return 16;
-    return 64;
-}
-
-// Function to map instruction string to enum (case-insensitive)
-InstructionType get_instruction_type(const char* instr_str) {
-    if (strcasecmp(instr_str, "MOV") == 0) return INST_MOV;
-    if (strcasecmp(instr_str, "PUSH") == 0) return INST_PUSH;
-    if (strcasecmp(instr_str, "POP") == 0) return INST_POP;
-    if (strcasecmp(instr_str, "XCHG") == 0) return INST_XCHG;
-    if (strcasecmp(instr_str, "ADD") == 0) return INST_ADD;
-    if (strcasecmp(instr_str, "SUB") == 0) return INST_SUB;
-    if (strcasecmp(instr_str, "MUL") == 0) return INST_MUL;
-    if (strcasecmp(instr_str, "DIV") == 0) return INST_DIV;
-    if (strcasecmp(instr_str, "INC") == 0) return INST_INC;
-    if (strcasecmp(instr_str, "DEC") == 0) return INST_DEC;
-    if (strcasecmp(instr_str, "NEG") == 0) return INST_NEG;
-    if (strcasecmp(instr_str, "CMP") == 0) return INST_CMP;
-    if (strcasecmp(instr_str, "AND") == 0) return INST_AND;
-    if (strcasecmp(instr_str, "OR") == 0) return INST_OR;
-    if (strcasecmp(instr_str, "XOR") == 0) return INST_XOR;
-    if (strcasecmp(instr_str, "NOT") == 0) return INST_NOT;
-    if (strcasecmp(instr_str, "SHL") == 0) return INST_SHL;
-    if (strcasecmp(instr_str, "SHR") == 0) return INST_SHR;
-    if (strcasecmp(instr_str, "ROL") == 0) return INST_ROL;
-    if (strcasecmp(instr_str, "ROR") == 0) return INST_ROR;
-    if (strcasecmp(instr_str, "JMP") == 0) return INST_JMP;
-    if (strcasecmp(instr_str, "JE") == 0) return INST_JE;
-    if (strcasecmp(instr_str, "JNE") == 0) return INST_JNE;
-    if (strcasecmp(instr_str, "JG") == 0) return INST_JG;
-    if (strcasecmp(instr_str, "JGE") == 0) return INST_JGE;
-    if (strcasecmp(instr_str, "JL") == 0) return INST_JL;
-    if (strcasecmp(instr_str, "JLE") == 0) return INST_JLE;
-    if (strcasecmp(instr_str, "JA") == 0) return INST_JA;
-    if (strcasecmp(instr_str, "JAE") == 0) return INST_JAE;
-    if (strcasecmp(instr_str, "JB") == 0) return INST_JB;
-    if (strcasecmp(instr_str, "JBE") == 0) return INST_JBE;
-    if (strcasecmp(instr_str, "JO") == 0) return INST_JO;
-    if (strcasecmp(instr_str, "JNO") == 0) return INST_JNO;
-    if (strcasecmp(instr_str, "JS") == 0) return INST_JS;
-    if (strcasecmp(instr_str, "JNS") == 0) return INST_JNS;
-    if (strcasecmp(instr_str, "JP") == 0) return INST_JP;
-    if (strcasecmp(instr_str, "JNP") == 0) return INST_JNP;
-    if (strcasecmp(instr_str, "POW") == 0) return INST_POW;
-    if (strcasecmp(instr_str, "ROOT") == 0) return INST_ROOT;
-    if (strcasecmp(instr_str, "AVG") == 0) return INST_AVG;
-    if (strcasecmp(instr_str, "MOD") == 0) return INST_MOD;
-    if (strcasecmp(instr_str, "MIRROR") == 0) return INST_MIRROR;
-    if (strcasecmp(instr_str, "ISPRIME") == 0) return INST_ISPRIME;
-    if (strcasecmp(instr_str, "MAX") == 0) return INST_MAX;
-    if (strcasecmp(instr_str, "MIN") == 0) return INST_MIN;
-    if (strcasecmp(instr_str, "INT") == 0) return INST_INT;
-    if (instr_str[0] == ';') return INST_COMMENT; // Handle comments starting with ';'
-    if (strcasecmp(instr_str, "NOP") == 0) return INST_NOP;
-    if (strchr(instr_str, ':') != NULL) return INST_LABEL; // Handle labels ending with ':'
-    return INST_NOP; // Default to NOP for unknown instructions
-}
-
-// Function to find a label in the label array
-size_t find_label(const Label* labels, size_t label_count, const char* label) {
-    for (size_t i = 0; i < label_count; i++) {
-        if (strcmp(labels[i].label, label) == 0) {
-            return labels[i].index;
-        }
-    }
-    return -1; // Label not found
-}
-
-// Function to write a 64-bit value to memory
-void write_memory(void* emu, uint64_t address, uint64_t value, size_t size) {
-    // Check if the address is within valid memory bounds
-    if (address >= MEMORY_SIZE || address + size > MEMORY_SIZE) {
-        fprintf(stderr, "Error: Memory access out of bounds at address 0x%llx\n", address);
-        return;
-    }
-
-    // Handle different size writes
-    switch (size) {
-        case sizeof(uint8_t):
-            *(uint8_t*)&memory[address] = (uint8_t)value;
-        break;
-        case sizeof(uint16_t):
-            *(uint16_t*)&memory[address] = (uint16_t)value;
-        break;
-        case sizeof(uint32_t):
-            *(uint32_t*)&memory[address] = (uint32_t)value;
-        break;
-        case sizeof(uint64_t):
-            *(uint64_t*)&memory[address] = value;
-        break;
-        default:
-            fprintf(stderr, "Error: Unsupported memory write size %zu\n", size);
-        return;
-    }
-}
-
-
-// Custom ROOT instruction implementation
-void execute_root_instruction(Emulator* emu, Instruction* inst) {
-    // Get base value
-    uint64_t base;
-    if (inst->src_reg) {
-        base = *inst->src_reg;
-        printf("ROOT: Using base value from register: %lu\n", base);
-    }
-    else if (inst->src_is_memory) {
-        base = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("ROOT: Using base value from memory [0x%lx]: %lu\n", inst->src_mem_address, base);
-    }
-    else {
-        base = inst->immediate;
-        printf("ROOT: Using immediate base value: %lu\n", base);
-    }
-
-    // Get exponent value
-    uint64_t exponent;
-    if (inst->aux_reg) {
-        exponent = *inst->aux_reg;
-        printf("ROOT: Using exponent from register: %lu\n", exponent);
-    }
-    else if (inst->aux_is_memory) {
-        exponent = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
-        printf("ROOT: Using exponent from memory [0x%lx]: %lu\n", inst->aux_mem_address, exponent);
-    }
-    else {
-        exponent = inst->aux_immediate;
-        printf("ROOT: Using immediate exponent value: %lu\n", exponent);
-    }
-
-    // Check for zero exponent
-    if (exponent == 0) {
-        fprintf(stderr, "ROOT: Division by zero (exponent is zero)\n");
-        return;
-    }
-
-    // Calculate the root
-    double result = pow((double)base, 1.0 / (double)exponent);
-    uint64_t final_result = (uint64_t)result;
-
-    // Store result
-    if (inst->dest_reg) {
-        *inst->dest_reg = final_result;
-        printf("ROOT: Stored result in register: %lu\n", final_result);
-    }
-    else if (inst->dest_is_memory) {
-        write_memory(emu, inst->dest_mem_address, final_result, sizeof(uint64_t));
-        printf("ROOT: Stored result in memory [0x%lx]: %lu\n", inst->dest_mem_address, final_result);
-    }
-
-    // Update flags
-    emu->flags.zero = (final_result == 0);
-    emu->flags.sign = (final_result & (1ULL << 63)) != 0;
-}
-
-// Custom AVG instruction implementation
-void execute_avg_instruction(Emulator* emu, Instruction* inst) {
-    uint64_t val1 = 0, val2 = 0, val3 = 0;
-
-    // Get first value (always from destination register)
-    if (!inst->dest_reg) {
-        fprintf(stderr, "AVG: First operand must be a register\n");
-        return;
-    }
-    val1 = *inst->dest_reg;
-    printf("AVG: First value from register: 0x%llX\n", (unsigned long long)val1);
-
-    // Get second value (from register, memory, or immediate)
-    if (inst->src_reg) {
-        val2 = *inst->src_reg;
-        printf("AVG: Second value from register: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_is_memory) {
-        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("AVG: Second value from memory: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_immediate) {
-        val2 = inst->immediate;
-        printf("AVG: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
-    }
-    else {
-        fprintf(stderr, "AVG: Invalid second operand\n");
-        return;
-    }
-
-    // Get third value (from register, memory, or immediate)
-    if (inst->aux_reg) {
-        val3 = *inst->aux_reg;
-        printf("AVG: Third value from register: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_is_memory) {
-        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
-        printf("AVG: Third value from memory: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_immediate) {
-        val3 = inst->aux_immediate;
-        printf("AVG: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
-    }
-    else {
-        fprintf(stderr, "AVG: Invalid third operand\n");
-        return;
-    }
-
-    // Calculate average
-    uint64_t sum = val1 + val2 + val3;
-    uint64_t avg = sum / 3;
-
-    // Store result in destination register
-    *inst->dest_reg = avg;
-    printf("AVG: Result 0x%llX stored in destination register\n", (unsigned long long)avg);
-
-    // Update flags
-    emu->flags.zero = (avg == 0);
-    emu->flags.sign = (avg & (1ULL << 63)) ? 1 : 0;
-}
-
-// Custom POW instruction implementation
-
-void execute_pow_instruction(Emulator* emu, Instruction* inst) {
-    uint64_t base = 0, exponent = 0;
-
-    // Determine the base value (from memory or register)
-    if (inst->dest_is_memory) {
-        base = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-        printf("POW: Reading base value 0x%llX from memory address 0x%llX\n",
-               base, inst->dest_mem_address);
-    } else if (inst->dest_reg) {
-        base = (*inst->dest_reg);
-        printf("POW: Using base value 0x%llX from destination register\n",
-               base);
-    } else {
-        fprintf(stderr, "POW: Invalid destination operand\n");
-        return;
-    }
-
-    // Determine the exponent value (from memory, register, or immediate)
-    if (inst->src_is_memory) {
-        exponent = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("POW: Reading exponent value 0x%llX from memory address 0x%llX\n",
-               exponent, inst->src_mem_address);
-    } else if (inst->src_reg) {
-        exponent = (*inst->src_reg);
-        printf("POW: Using exponent value 0x%llX from source register\n",
-               exponent);
-    } else {
-        exponent = (inst->immediate);
-        printf("POW: Using immediate exponent value 0x%llX\n", exponent);
-    }
-
-    // Perform the power operation
-    double result = pow((double)base, (double)exponent);
-
-    // Check if the result is within the valid range for uint64_t
-    if (result > (double)UINT64_MAX || result < 0) {
-        fprintf(stderr, "POW: Result overflow or invalid (result = %lf)\n", result);
-        return;
-    }
-
-    // Check if the result is an exact integer
-    if (result != floor(result)) {
-        fprintf(stderr, "POW: Result is not an exact integer (result = %lf)\n", result);
-        return;
-    }
-
-    // Convert the result to uint64_t
-    uint64_t res = (uint64_t)result;
-
-    // Handle result based on destination operand type
-    if (inst->dest_is_memory) {
-        write_memory(emu, inst->dest_mem_address, res, sizeof(uint64_t));
-        printf("POW: Writing result 0x%llX to memory address 0x%llX\n",
-               res, inst->dest_mem_address);
-    } else if (inst->dest_reg) {
-        *inst->dest_reg = res;
-        printf("POW: Writing result 0x%llX to destination register\n", res);
-    }
-}
-
-// Custom MOD instruction implementation
-void execute_mod_instruction(Emulator* emu, Instruction* inst) {
-    uint64_t dividend = 0, divisor = 0;
-
-    // Determine the dividend (destination operand)
-    if (inst->dest_is_memory) {
-        dividend = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-        printf("MOD: Reading dividend value 0x%llX from memory address 0x%llX\n",
-            (uint64_t)dividend, inst->dest_mem_address);
-    }
-    else if (inst->dest_reg) {
-        dividend = (*inst->dest_reg);
-        printf("MOD: Using dividend value 0x%llX from destination register\n",
-            (uint64_t)dividend);
-    }
-    else {
-        fprintf(stderr, "MOD: Invalid destination operand\n");
-        return;
-    }
-
-    // Determine the divisor (source operand)
-    if (inst->src_is_memory) {
-        divisor = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("MOD: Reading divisor value 0x%llX from memory address 0x%llX\n",
-            (uint64_t)divisor, inst->src_mem_address);
-    }
-    else if (inst->src_reg) {
-        divisor = (*inst->src_reg);
-        printf("MOD: Using divisor value 0x%llX from source register\n",
-            (uint64_t)divisor);
-    }
-    else {
-        divisor = (inst->immediate);
-        printf("MOD: Using immediate divisor value 0x%llX\n", (uint64_t)divisor);
-    }
-
-    // Handle division by zero
-    if (divisor == 0) {
-        fprintf(stderr, "MOD: Division by zero error\n");
-        return;
-    }
-
-    // Perform the modulus operation
-    uint64_t result = dividend % divisor;
-
-    // Handle result based on destination operand type
-    if (inst->dest_is_memory) {
-        write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        printf("MOD: Writing result 0x%llX to memory address 0x%llX\n",
-            (uint64_t)result, inst->dest_mem_address);
-    }
-    else if (inst->dest_reg) {
-        *inst->dest_reg = result;
-        printf("MOD: Writing result 0x%llX to destination register\n", (uint64_t)result);
-    }
-
-    // Set flags (optional, if flags are implemented in the emulator)
-    emu->flags.zero = (result == 0) ? 1 : 0;         // Zero Flag (ZF)
-    emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0; // Sign Flag (SF)
-}
-
-// Function to check if a number is prime
-bool is_prime(uint64_t n) {
-    if (n <= 1) return false;
-    if (n <= 3) return true;
-    if (n % 2 == 0 || n % 3 == 0) return false;
-    for (uint64_t i = 5; i * i <= n; i += 6) {
-        if (n % i == 0 || n % (i + 2) == 0) return false;
-    }
-    return true;
-}
-
-// Function to execute the isprime instruction
-void execute_isprime_instruction(Emulator* emu, Instruction* inst) {
-    if (!inst->src_reg && !inst->src_is_memory) {
-        fprintf(stderr, "ISPRIME: Invalid source operand\n");
-        return;
-    }
-
-    uint64_t src_value = 0;
-
-    // Determine the source operand value (memory or register)
-    if (inst->src_is_memory) {
-        src_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("ISPRIME: Reading source value 0x%llX from memory address 0x%llX\n",
-            (uint64_t)src_value, inst->src_mem_address);
-    }
-    else if (inst->src_reg) {
-        src_value = *inst->src_reg;
-        printf("ISPRIME: Using source value 0x%llX from source register\n",
-            (uint64_t)src_value);
-    }
-
-    bool prime = is_prime(src_value);
-
-    if (inst->dest_reg) {
-        *inst->dest_reg = prime ? 1 : 0;
-        printf("ISPRIME: Writing result 0x%llX to destination register\n", (uint64_t)(prime ? 1 : 0));
-    }
-    else if (inst->dest_is_memory) {
-        write_memory(emu, inst->dest_mem_address, prime ? 1 : 0, sizeof(uint64_t));
-        printf("ISPRIME: Writing result 0x%llX to memory address 0x%llX\n",
-            (uint64_t)(prime ? 1 : 0), inst->dest_mem_address);
-    }
-    else {
-        fprintf(stderr, "ISPRIME: Invalid destination operand\n");
-        return;
-    }
-
-    printf("Executed ISPRIME Instruction: %" PRIu64 " is %s\n",
-        src_value, prime ? "TRUE" : "FALSE");
-
-    // Determine register size and ensure the result fits if the destination is a register
-    if (inst->dest_reg) {
-        const char* dest_name = get_register_name(emu, inst->dest_reg);
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && *inst->dest_reg > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: Result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n",
-                *inst->dest_reg, dest_name);
-        }
-    }
-}
-
-// Function to mirror decimal bits
-uint64_t mirror_decimal(uint64_t decimal_value) {
-    uint64_t mirrored = 0;
-    uint64_t temp = decimal_value;
-
-    // Calculate the bit-width of the decimal value
-    int bit_width = 0;
-    if (decimal_value == 0) bit_width = 1;
-    while (temp > 0) {
-        temp >>= 1;
-        bit_width++;
-    }
-
-    // Perform bit mirroring
-    for (int i = 0; i < bit_width; ++i) {
-        mirrored <<= 1;                         // Shift mirrored value left
-        mirrored |= (decimal_value & 1);        // Add the least significant bit of value to mirrored
-        decimal_value >>= 1;                    // Shift decimal_value right to process the next bit
-    }
-
-    return mirrored;
-}
-
-// Custom MIRROR instruction implementation
-void execute_mirror_instruction(Emulator* emu, Instruction* inst) {
-    if (!inst->src_reg && !inst->src_is_memory) {
-        fprintf(stderr, "MIRROR: Invalid source operand\n");
-        return;
-    }
-
-    uint64_t src_value = 0;
-
-    // Determine the source operand value (memory or register)
-    if (inst->src_is_memory) {
-        src_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("MIRROR: Reading source value 0x%llX from memory address 0x%llX\n",
-            (uint64_t)src_value, inst->src_mem_address);
-    }
-    else if (inst->src_reg) {
-        src_value = *inst->src_reg;
-        printf("MIRROR: Using source value 0x%llX from source register\n",
-            (uint64_t)src_value);
-    }
-
-    uint64_t mirrored_value = mirror_decimal(src_value);
-
-    // Store the result
-    if (inst->dest_reg) {
-        *inst->dest_reg = mirrored_value;
-        printf("MIRROR: Writing result 0x%llX to destination register\n", (uint64_t)mirrored_value);
-    }
-    else if (inst->dest_is_memory) {
-        write_memory(emu, inst->dest_mem_address, mirrored_value, sizeof(uint64_t));
-        printf("MIRROR: Writing result 0x%llX to memory address 0x%llX\n",
-            (uint64_t)mirrored_value, inst->dest_mem_address);
-    }
-    else {
-        fprintf(stderr, "MIRROR: Invalid destination operand\n");
-        return;
-    }
-
-    printf("Executed MIRROR Instruction: Mirror of %" PRIu64 " = %" PRIu64 "\n", src_value, mirrored_value);
-
-    // Ensure the result fits in the destination register size
-    if (inst->dest_reg) {
-        const char* dest_name = get_register_name(emu, inst->dest_reg);
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && mirrored_value > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: Mirrored value 0x%016" PRIx64 " exceeds 32-bit register size for %s\n",
-                mirrored_value, dest_name);
-        }
-    }
-}
-
-// Execute MIN with three parameters
-void execute_min_instruction(Emulator* emu, Instruction* inst) {
-    uint64_t val1 = 0, val2 = 0, val3 = 0;
-
-    // Get first value (always from destination register)
-    if (!inst->dest_reg) {
-        fprintf(stderr, "MIN: First operand must be a register\n");
-        return;
-    }
-    val1 = *inst->dest_reg;
-    printf("MIN: First value from register: 0x%llX\n", (unsigned long long)val1);
-
-    // Get second value (from register, memory, or immediate)
-    if (inst->src_reg) {
-        val2 = *inst->src_reg;
-        printf("MIN: Second value from register: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_is_memory) {
-        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("MIN: Second value from memory: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_immediate) {
-        val2 = inst->immediate;
-        printf("MIN: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
-    }
-    else {
-        fprintf(stderr, "MIN: Invalid second operand\n");
-        return;
-    }
-
-    // Get third value (from register, memory, or immediate)
-    if (inst->aux_reg) {
-        val3 = *inst->aux_reg;
-        printf("MIN: Third value from register: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_is_memory) {
-        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
-        printf("MIN: Third value from memory: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_immediate) {
-        val3 = inst->aux_immediate;
-        printf("MIN: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
-    }
-    else {
-        fprintf(stderr, "MIN: Invalid third operand\n");
-        return;
-    }
-
-    // Find minimum value
-    uint64_t min_val = val1;
-    if (val2 < min_val) min_val = val2;
-    if (val3 < min_val) min_val = val3;
-
-    // Store result in destination register
-    *inst->dest_reg = min_val;
-    printf("MIN: Result 0x%llX stored in destination register\n", (unsigned long long)min_val);
-
-    // Update flags
-    emu->flags.zero = (min_val == 0);
-    emu->flags.sign = (min_val & (1ULL << 63)) ? 1 : 0;
-}
-
-void execute_max_instruction(Emulator* emu, Instruction* inst) {
-    uint64_t val1 = 0, val2 = 0, val3 = 0;
-
-    // Get first value (always from destination register)
-    if (!inst->dest_reg) {
-        fprintf(stderr, "MAX: First operand must be a register\n");
-        return;
-    }
-    val1 = *inst->dest_reg;
-    printf("MAX: First value from register: 0x%llX\n", (unsigned long long)val1);
-
-    // Get second value (from register, memory, or immediate)
-    if (inst->src_reg) {
-        val2 = *inst->src_reg;
-        printf("MAX: Second value from register: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_is_memory) {
-        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-        printf("MAX: Second value from memory: 0x%llX\n", (unsigned long long)val2);
-    }
-    else if (inst->src_immediate) {
-        val2 = inst->immediate;
-        printf("MAX: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
-    }
-    else {
-        fprintf(stderr, "MAX: Invalid second operand\n");
-        return;
-    }
-
-    // Get third value (from register, memory, or immediate)
-    if (inst->aux_reg) {
-        val3 = *inst->aux_reg;
-        printf("MAX: Third value from register: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_is_memory) {
-        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
-        printf("MAX: Third value from memory: 0x%llX\n", (unsigned long long)val3);
-    }
-    else if (inst->aux_immediate) {
-        val3 = inst->aux_immediate;
-        printf("MAX: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
-    }
-    else {
-        fprintf(stderr, "MAX: Invalid third operand\n");
-        return;
-    }
-
-    // Find maximum value
-    uint64_t max_val = val1;
-    if (val2 > max_val) max_val = val2;
-    if (val3 > max_val) max_val = val3;
-
-    // Store result in destination register
-    *inst->dest_reg = max_val;
-    printf("MAX: Result 0x%llX stored in destination register\n", (unsigned long long)max_val);
-
-    // Update flags
-    emu->flags.zero = (max_val == 0);
-    emu->flags.sign = (max_val & (1ULL << 63)) ? 1 : 0;
-}
-
-// Function to print a register in specified format
-void print_reg(const char* name, uint64_t value, NumberFormat format, size_t size) {
-    if (format == HEX) {
-        switch (size) {
-        case 32:
-            printf("%-6s: 0x%08" PRIx64 "    ", name, value);
-            break;
-        case 64:
-            printf("%-6s: 0x%016" PRIx64 "    ", name, value);
-            break;
-        default:
-            printf("%-6s: 0x%016" PRIx64 "    ", name, value);
-            break;
-        }
-    }
-    else {
-        switch (size) {
-        case 32:
-            printf("%-6s: %" PRIu32 "    ", name, (uint32_t)value);
-            break;
-        case 64:
-            printf("%-6s: %" PRIu64 "    ", name, value);
-            break;
-        default:
-            printf("%-6s: %" PRIu64 "    ", name, value);
-            break;
-        }
-    }
-}
-
-// Print current emulator state
-void print_emulator_state(Emulator* emu, const char* phase) {
-    // Allow printing if tracing is enabled or if it's the final state
-    if (!tracing_enabled && strcmp(phase, "Final State") != 0) return;
-
-    printf("\n--- Emulator State: %s ---\n", phase);
-    printf("Registers:\n");
-
-    NumberFormat format = HEX; // Set format to HEX for all registers
-
-    // Print primary registers
-    print_reg("RAX", emu->rax, format, 64);
-    print_reg("EAX", emu->eax, format, 32);
-    printf("\n");
-
-    print_reg("RBX", emu->rbx, format, 64);
-    print_reg("EBX", emu->ebx, format, 32);
-    printf("\n");
-
-    print_reg("RCX", emu->rcx, format, 64);
-    print_reg("ECX", emu->ecx, format, 32);
-    printf("\n");
-
-    print_reg("RDX", emu->rdx, format, 64);
-    print_reg("EDX", emu->edx, format, 32);
-    printf("\n");
-
-    print_reg("RSI", emu->rsi, format, 64);
-    print_reg("ESI", emu->esi, format, 32);
-    printf("\n");
-
-    print_reg("RDI", emu->rdi, format, 64);
-    print_reg("EDI", emu->edi, format, 32);
-    printf("\n");
-
-    print_reg("RSP", emu->rsp, format, 64);
-    print_reg("ESP", emu->esp, format, 32);
-    printf("\n");
-
-    print_reg("RBP", emu->rbp, format, 64);
-    print_reg("EBP", emu->ebp, format, 32);
-    printf("\n");
-
-    print_reg("R8", emu->r8, format, 64);
-    print_reg("R8D", emu->r8d, format, 32);
-    printf("\n");
-
-    print_reg("R9", emu->r9, format, 64);
-    print_reg("R9D", emu->r9d, format, 32);
-    printf("\n");
-
-    print_reg("R10", emu->r10, format, 64);
-    print_reg("R10D", emu->r10d, format, 32);
-    printf("\n");
-
-    print_reg("R11", emu->r11, format, 64);
-    print_reg("R11D", emu->r11d, format, 32);
-    printf("\n");
-
-    print_reg("R12", emu->r12, format, 64);
-    print_reg("R12D", emu->r12d, format, 32);
-    printf("\n");
-
-    print_reg("R13", emu->r13, format, 64);
-    print_reg("R13D", emu->r13d, format, 32);
-    printf("\n");
-
-    print_reg("R14", emu->r14, format, 64);
-    print_reg("R14D", emu->r14d, format, 32);
-    printf("\n");
-
-    print_reg("R15", emu->r15, format, 64);
-    print_reg("R15D", emu->r15d, format, 32);
-    printf("\n");
-
-    printf("\nFlags:\n");
-    printf("Carry: %d\tZero: %d\tSign: %d\tOverflow: %d\tDirection: %d\tInterrupt: %d\tTrap: %d\tAlignment: %d\n",
-        emu->flags.carry, emu->flags.zero, emu->flags.sign, emu->flags.overflow,
-        emu->flags.direction, emu->flags.interrupt, emu->flags.trap, emu->flags.alignment);
-
-    printf("\nSegment Registers:\n");
-    printf("CS: 0x%04X\tDS: 0x%04X\tSS: 0x%04X\tES: 0x%04X\tFS: 0x%04X\tGS: 0x%04X\n",
-        emu->cs, emu->ds, emu->ss, emu->es, emu->fs, emu->gs);
-
-    printf("\nInstruction Pointer (RIP): 0x%016" PRIx64 "\n", emu->rip);
-    printf("----------------------------------------\n");
-}
-
-void push_to_stack(Emulator* emu, uint64_t value) {
-    if (emu->rsp < 8) {
-        fprintf(stderr, "Stack overflow!\n");
-        exit(EXIT_FAILURE);
-    }
-    emu->rsp -= 8;  // Adjust stack pointer
-    write_memory(emu, emu->rsp, value, sizeof(uint64_t));
-}
-
-uint64_t pop_from_stack(Emulator* emu) {
-    if (emu->rsp >= emu->memory_size) {
-        fprintf(stderr, "Stack underflow!\n");
-        exit(EXIT_FAILURE);
-    }
-    uint64_t value = read_memory(emu, emu->rsp, sizeof(uint64_t));
-    emu->rsp += 8;  // Adjust stack pointer
-    return value;
-}
-
-// Comprehensive instruction execution
-void execute_instruction(Emulator* emu, Instruction* inst, size_t inst_num, Label* labels, size_t label_count) {  // Comprehensive instruction execution
-    if (tracing_enabled) {
-        // Print the current instruction being executed with actual register names
-        printf("\n=== Executing Instruction %zu ===\n", inst_num + 1);
-        printf("Instruction: ");
-
-        // Get instruction name
-        switch (inst->type) {
-            case INST_INT:
-                if (inst->function) {
-                    printf("INT 0x%02" PRIx64 ", 0x%02" PRIx64, inst->immediate, inst->function);
-                }
-                else {
-                    printf("INT 0x%02" PRIx64, inst->immediate);
-                }
-            break;
-            case INST_MOV:
-                if (inst->dest_is_memory) {
-                    if (inst->src_is_memory) {
-                        printf("MOV [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                    } else if (inst->src_reg) {
-                        printf("MOV [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                    } else if (inst->src_is_string) {
-                        printf("MOV [0x%llX], \"%s\"", inst->dest_mem_address, inst->src_string);
-                    } else {
-                        printf("MOV [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                    }
-                } else if (inst->dest_reg) {
-                    if (inst->src_is_memory) {
-                        printf("MOV %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                    } else if (inst->src_reg) {
-                        printf("MOV %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                    } else {
-                        printf("MOV %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                    }
-                } else {
-                    printf("MOV UNKNOWN");
-                }
-            break;
-        case INST_PUSH:
-            printf("PUSH %s", inst->dest_reg_name);
-            break;
-        case INST_POP:
-            printf("POP %s", inst->dest_reg_name);
-            break;
-        case INST_XCHG:
-            printf("XCHG %s, %s", inst->dest_reg_name, inst->src_reg_name);
-            break;
-        case INST_ADD:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("ADD [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ADD [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("ADD [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("ADD %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ADD %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("ADD %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("ADD UNKNOWN");
-            }
-            break;
-        case INST_SUB:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("SUB [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SUB [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("SUB [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("SUB %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SUB %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("SUB %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("SUB UNKNOWN");
-            }
-            break;
-        case INST_MUL:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("MUL [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MUL [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("MUL [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("MUL %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MUL %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("MUL %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("MUL UNKNOWN");
-            }
-            break;
-        case INST_DIV:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("DIV [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("DIV [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("DIV [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("DIV %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("DIV %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("DIV %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("DIV UNKNOWN");
-            }
-            break;
-        case INST_INC:
-            printf("INC %s", inst->dest_reg_name);
-            break;
-        case INST_DEC:
-            printf("DEC %s", inst->dest_reg_name);
-            break;
-        case INST_NEG:
-            printf("NEG %s", inst->dest_reg_name);
-            break;
-        case INST_CMP:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("CMP [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("CMP [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("CMP [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("CMP %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("CMP %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("CMP %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("CMP UNKNOWN");
-            }
-            break;
-        case INST_AND:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("AND [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("AND [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("AND [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("AND %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("AND %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("AND %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("AND UNKNOWN");
-            }
-            break;
-        case INST_OR:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("OR [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("OR [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("OR [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("OR %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("OR %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("OR %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("OR UNKNOWN");
-            }
-            break;
-        case INST_XOR:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("XOR [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("XOR [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("XOR [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("XOR %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("XOR %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("XOR %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("XOR UNKNOWN");
-            }
-            break;
-        case INST_NOT:
-            printf("NOT %s", inst->dest_reg_name);
-            break;
-        case INST_SHL:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("SHL [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SHL [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("SHL [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("SHL %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SHL %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("SHL %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("SHL UNKNOWN");
-            }
-            break;
-        case INST_SHR:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("SHR [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SHR [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("SHR [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("SHR %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("SHR %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("SHR %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("SHR UNKNOWN");
-            }
-            break;
-        case INST_ROL:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("ROL [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ROL [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("ROL [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("ROL %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ROL %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("ROL %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("ROL UNKNOWN");
-            }
-            break;
-        case INST_ROR:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("ROR [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ROR [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("ROR [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("ROR %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ROR %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("ROR %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("ROR UNKNOWN");
-            }
-            break;
-        case INST_JMP:
-            printf("JMP %s", inst->label);
-            break;
-        case INST_JE:
-            printf("JE %s", inst->label);
-            break;
-        case INST_JNE:
-            printf("JNE %s", inst->label);
-            break;
-        case INST_JG:
-            printf("JG %s", inst->label);
-            break;
-        case INST_JGE:
-            printf("JGE %s", inst->label);
-            break;
-        case INST_JL:
-            printf("JL %s", inst->label);
-            break;
-        case INST_JLE:
-            printf("JLE %s", inst->label);
-            break;
-        case INST_JA:
-            printf("JA %s", inst->label);
-            break;
-        case INST_JAE:
-            printf("JAE %s", inst->label);
-            break;
-        case INST_JB:
-            printf("JB %s", inst->label);
-            break;
-        case INST_JBE:
-            printf("JBE %s", inst->label);
-            break;
-        case INST_JO:
-            printf("JO %s", inst->label);
-            break;
-        case INST_JNO:
-            printf("JNO %s", inst->label);
-            break;
-        case INST_JS:
-            printf("JS %s", inst->label);
-            break;
-        case INST_JNS:
-            printf("JNS %s", inst->label);
-            break;
-        case INST_JP:
-            printf("JP %s", inst->label);
-            break;
-        case INST_JNP:
-            printf("JNP %s", inst->label);
-            break;
-        case INST_POW:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("POW [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("POW [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("POW [0x%llX], 0x%016" PRIx64 , inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("POW %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("POW %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("POW %s, 0x%016" PRIx64 , inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("MOV UNKNOWN");
-            }
-            break;
-        case INST_ROOT:
-    if (inst->dest_is_memory) {
-        if (inst->src_is_memory) {
-            printf("ROOT [0x%llX], [0x%llX], ",
-                inst->dest_mem_address,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("ROOT [0x%llX], %s, ",
-                inst->dest_mem_address,
-                inst->src_reg_name);
-        } else {
-            printf("ROOT [0x%llX], 0x%016" PRIx64 ", ",
-                inst->dest_mem_address,
-                inst->immediate);
-        }
-    } else if (inst->dest_reg) {
-        if (inst->src_is_memory) {
-            printf("ROOT %s, [0x%llX], ",
-                inst->dest_reg_name,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("ROOT %s, %s, ",
-                inst->dest_reg_name,
-                inst->src_reg_name);
-        } else {
-            printf("ROOT %s, 0x%016" PRIx64 ", ",
-                inst->dest_reg_name,
-                inst->immediate);
-        }
-    } else {
-        printf("ROOT UNKNOWN, ");
-    }
-
-    // Handle the third parameter (exponent)
-    if (inst->aux_is_memory) {
-        printf("[0x%llX]", inst->aux_mem_address);
-    } else if (inst->aux_reg) {
-        printf("%s", inst->aux_reg_name);
-    } else {
-        printf("0x%016" PRIx64, inst->aux_immediate);
-    }
-
-    printf("\n");
-    break;
-
-        case INST_AVG:
-    if (inst->dest_is_memory) {
-        if (inst->src_is_memory) {
-            printf("AVG [0x%llX], [0x%llX], ",
-                inst->dest_mem_address,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("AVG [0x%llX], %s, ",
-                inst->dest_mem_address,
-                inst->src_reg_name);
-        } else {
-            printf("AVG [0x%llX], 0x%016" PRIx64 ", ",
-                inst->dest_mem_address,
-                inst->immediate);
-        }
-    } else if (inst->dest_reg) {
-        if (inst->src_is_memory) {
-            printf("AVG %s, [0x%llX], ",
-                inst->dest_reg_name,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("AVG %s, %s, ",
-                inst->dest_reg_name,
-                inst->src_reg_name);
-        } else {
-            printf("AVG %s, 0x%016" PRIx64 ", ",
-                inst->dest_reg_name,
-                inst->immediate);
-        }
-    } else {
-        printf("AVG UNKNOWN, ");
-    }
-
-    // Handle the third parameter (auxiliary value)
-    if (inst->aux_is_memory) {
-        printf("[0x%llX]", inst->aux_mem_address);
-    } else if (inst->aux_reg) {
-        printf("%s", inst->aux_reg_name);
-    } else {
-        printf("0x%016" PRIx64, inst->aux_immediate);
-    }
-
-    printf("\n");
-    break;
-        case INST_MAX:
-    if (inst->dest_is_memory) {
-        if (inst->src_is_memory) {
-            printf("MAX [0x%llX], [0x%llX], ",
-                inst->dest_mem_address,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("MAX [0x%llX], %s, ",
-                inst->dest_mem_address,
-                inst->src_reg_name);
-        } else {
-            printf("MAX [0x%llX], 0x%016" PRIx64 ", ",
-                inst->dest_mem_address,
-                inst->immediate);
-        }
-    } else if (inst->dest_reg) {
-        if (inst->src_is_memory) {
-            printf("MAX %s, [0x%llX], ",
-                inst->dest_reg_name,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("MAX %s, %s, ",
-                inst->dest_reg_name,
-                inst->src_reg_name);
-        } else {
-            printf("MAX %s, 0x%016" PRIx64 ", ",
-                inst->dest_reg_name,
-                inst->immediate);
-        }
-    } else {
-        printf("MAX UNKNOWN, ");
-    }
-
-    // Handle the third parameter (auxiliary value)
-    if (inst->aux_is_memory) {
-        printf("[0x%llX]", inst->aux_mem_address);
-    } else if (inst->aux_reg) {
-        printf("%s", inst->aux_reg_name);
-    } else {
-        printf("0x%016" PRIx64, inst->aux_immediate);
-    }
-
-    printf("\n");
-    break;
-        case INST_MIN:
-    if (inst->dest_is_memory) {
-        if (inst->src_is_memory) {
-            printf("MIN [0x%llX], [0x%llX], ",
-                inst->dest_mem_address,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("MIN [0x%llX], %s, ",
-                inst->dest_mem_address,
-                inst->src_reg_name);
-        } else {
-            printf("MIN [0x%llX], 0x%016" PRIx64 ", ",
-                inst->dest_mem_address,
-                inst->immediate);
-        }
-    } else if (inst->dest_reg) {
-        if (inst->src_is_memory) {
-            printf("MIN %s, [0x%llX], ",
-                inst->dest_reg_name,
-                inst->src_mem_address);
-        } else if (inst->src_reg) {
-            printf("MIN %s, %s, ",
-                inst->dest_reg_name,
-                inst->src_reg_name);
-        } else {
-            printf("MIN %s, 0x%016" PRIx64 ", ",
-                inst->dest_reg_name,
-                inst->immediate);
-        }
-    } else {
-        printf("MIN UNKNOWN, ");
-    }
-
-    // Handle the third parameter (auxiliary value)
-    if (inst->aux_is_memory) {
-        printf("[0x%llX]", inst->aux_mem_address);
-    } else if (inst->aux_reg) {
-        printf("%s", inst->aux_reg_name);
-    } else {
-        printf("0x%016" PRIx64, inst->aux_immediate);
-    }
-
-    printf("\n");
-    break;
-        case INST_MOD:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("MOD [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MOD [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("MOD [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("MOD %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MOD %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("MOD %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("MOD UNKNOWN");
-            }
-            break;
-        case INST_MIRROR:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("MIRROR [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MIRROR [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("MIRROR [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("MIRROR %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("MIRROR %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("MIRROR %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("MIRROR UNKNOWN");
-            }
-            break;
-        case INST_ISPRIME:
-            if (inst->dest_is_memory) {
-                if (inst->src_is_memory) {
-                    printf("ISPRIME [0x%llX], [0x%llX]", inst->dest_mem_address, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ISPRIME [0x%llX], %s", inst->dest_mem_address, inst->src_reg_name);
-                } else {
-                    printf("ISPRIME [0x%llX], 0x%016" PRIx64, inst->dest_mem_address, inst->immediate);
-                }
-            } else if (inst->dest_reg) {
-                if (inst->src_is_memory) {
-                    printf("ISPRIME %s, [0x%llX]", inst->dest_reg_name, inst->src_mem_address);
-                } else if (inst->src_reg) {
-                    printf("ISPRIME %s, %s",inst->dest_reg_name, inst->src_reg_name);
-                } else {
-                    printf("ISPRIME %s, 0x%016" PRIx64, inst->dest_reg_name, inst->immediate);
-                }
-            } else {
-                printf("ISPRIME UNKNOWN");
-            }
-            break;
-        case INST_LABEL:
-            printf("LABEL %s", inst->label);
-            break;
-        case INST_COMMENT:
-            // Comments are ignored in execution
-            break;
-        case INST_NOP:
-            printf("NOP");
-            break;
-        default:
-            printf("UNKNOWN");
-            break;
-        }
-        printf("\n");
-
-        // Print registers before execution
-        print_emulator_state(emu, "Before Execution");
-    }
-
-    // Execute the instruction based on its type
-    switch (inst->type) {
-        // Data Movement Instructions
-        case INST_INT:
-            if (inst->immediate < 256 && interrupt_handlers[inst->immediate]) {
-                // Store the function number in the immediate field before calling handler
-                uint64_t original_immediate = inst->immediate;
-                inst->immediate = inst->function;  // Set the function number (09 in your case)
-                interrupt_handlers[original_immediate](emu, inst);
-                inst->immediate = original_immediate;  // Restore original immediate if needed
-            } else {
-                fprintf(stderr, "Error: Unsupported interrupt number 0x%I64X\n", inst->immediate);
-            }
-        break;
-case INST_MOV:
-    if (inst->dest_is_memory) {
-        // Writing to memory
-        uint64_t value = 0;
-        if (inst->src_is_string) {
-            // Source is a string literal
-            const char* string = inst->src_string;
-            uint64_t address = inst->dest_mem_address;
-            size_t str_len = strlen(string);
-
-            // Write string to memory
-            for (size_t i = 0; i < str_len; ++i) {
-                write_memory(emu, address + i, string[i], sizeof(uint8_t));
-            }
-
-            // Null-terminate the string in memory
-            write_memory(emu, address + str_len, '\0', sizeof(uint8_t));
-
-            printf("MOV: Wrote string \"%s\" to memory address 0x%llX\n", string, address);
-        }
-        else if (inst->src_is_memory) {
-            // Source is memory
-            uint64_t value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
-
-            printf("MOV: Copied value 0x%016" PRIx64 " from memory address 0x%llX to 0x%llX\n",
-                   value, inst->src_mem_address, inst->dest_mem_address);
-        }
-        else if (inst->src_reg) {
-            // Source is a register
-            uint64_t value = *inst->src_reg;
-            printf("MOV: Copied value 0x%016" PRIx64 " from source register %s to memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
-        }
-        else {
-            // Source is an immediate value
-            uint64_t value = inst->immediate;
-            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
-
-            printf("MOV: Wrote immediate value 0x%016" PRIx64 " to memory address 0x%llX\n",
-                   value, inst->dest_mem_address);
-        }
-    }
-    else if (inst->dest_reg) {
-        // Writing to a register
-        uint64_t value = 0;
-
-        if (inst->src_is_memory) {
-            // Source is memory
-            value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-
-            printf("MOV: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64
-                   " into destination register %s\n",
-                   value, inst->src_mem_address, inst->dest_reg_name);
-        }
-        else if (inst->src_reg) {
-            // Source is another register
-            uint64_t value = *inst->src_reg;
-            printf("MOV: Moving value 0x%016" PRIx64 " from source register %s to destination register %s\n",
-                   value, inst->src_reg_name, inst->dest_reg_name);
-        }
-        else if (inst->src_is_string) {
-            // Convert first character of string to its ASCII value
-            value = (uint64_t)inst->src_string[0];
-
-            printf("MOV: Moving first character '%c' (ASCII 0x%016" PRIx64 ") from string to register %s\n",
-                   inst->src_string[0], value, inst->dest_reg_name);
-        }
-        else {
-            // Source is an immediate value
-            value = inst->immediate;
-
-            printf("MOV: Moving immediate value 0x%016" PRIx64 " to destination register %s\n",
-                   value, inst->dest_reg_name);
-        }
-
-        // Move the value to the destination register
-        *inst->dest_reg = value;
-    }
-    else {
-        // Invalid instruction format
-        fprintf(stderr, "MOV: Invalid instruction format\n");
-        // Consider adding more detailed error logging
-        exit(EXIT_FAILURE);
-    }
-    break;
-
-    case INST_PUSH:
-    {
-        // Determine the value to push onto the stack
-        uint64_t value = 0;
-
-        if (inst->dest_is_memory) {
-            // Push the value from memory to the stack
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("PUSH: Pushing value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 " onto the stack\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            // Push the value from a register to the stack
-            value = *inst->dest_reg;
-            printf("PUSH: Pushing value 0x%016" PRIx64 " from register %s onto the stack\n", value, inst->dest_reg_name);
-        }
-        else {
-            fprintf(stderr, "PUSH: Invalid operand (must be a register or memory)\n");
-            exit(EXIT_FAILURE);
-        }
-
-        // Check for stack overflow
-        if (emu->rsp < (uint64_t)(uintptr_t)(emu->stack)) {
-            fprintf(stderr, "Stack overflow\n");
-            exit(1);
-        }
-
-        // Decrement the stack pointer
-        emu->rsp -= sizeof(uint64_t);
-
-        // Calculate the stack offset
-        size_t stack_offset = emu->rsp - (uint64_t)(uintptr_t)(emu->stack);
-
-        // Ensure stack_offset is within stack_size
-        if (stack_offset + sizeof(uint64_t) > emu->stack_size) {
-            fprintf(stderr, "Stack overflow (invalid stack offset)\n");
-            exit(1);
-        }
-
-        // Push the value onto the stack
-        memcpy(emu->stack + stack_offset, &value, sizeof(uint64_t));
-
-        printf("Executed PUSH Instruction: Pushed 0x%016" PRIx64 " to stack\n", value);
-    }
-    break;
-
-    case INST_POP:
-    {
-        // Check for stack underflow
-        if (emu->rsp >= (uint64_t)(uintptr_t)(emu->stack) + emu->stack_size) {
-            fprintf(stderr, "Stack underflow\n");
-            exit(1);
-        }
-
-        // Calculate the stack offset
-        size_t stack_offset = emu->rsp - (uint64_t)(uintptr_t)(emu->stack);
-
-        // Ensure stack_offset is within stack_size
-        if (stack_offset + sizeof(uint64_t) > emu->stack_size) {
-            fprintf(stderr, "Stack underflow (invalid stack offset)\n");
-            exit(1);
-        }
-
-        // Pop the value from the stack
-        uint64_t value;
-        memcpy(&value, emu->stack + stack_offset, sizeof(uint64_t));
-        emu->rsp += sizeof(uint64_t);
-
-        // Determine where to store the popped value
-        if (inst->dest_is_memory) {
-            // Pop a value from the stack into memory
-            printf("POP: Popping value 0x%016" PRIx64 " from the stack into memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            // Pop a value from the stack into a register
-            printf("POP: Popping value 0x%016" PRIx64 " from the stack into register %s\n", value, inst->dest_reg_name);
-            *inst->dest_reg = value;
-
-            // Determine register size
-            const char* reg_name = inst->dest_reg_name;
-            size_t size = get_register_size(reg_name);
-
-            // Check if the popped value fits in the register size
-            if (size == 32 && value > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Popped value 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", value, inst->dest_reg_name);
-            }
-            // 64-bit can hold all values
-        }
-        else {
-            fprintf(stderr, "POP: Invalid operand (must be a register or memory)\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed POP Instruction: Popped 0x%016" PRIx64 " from stack\n", value);
-    }
-    break;
-
-    case INST_XCHG:
-    {
-        // Check for invalid memory-to-memory exchange
-        if (inst->dest_is_memory && inst->src_is_memory) {
-            fprintf(stderr, "XCHG: Invalid instruction format (memory-to-memory exchange is not supported)\n");
-            exit(EXIT_FAILURE);
-        }
-
-        uint64_t temp_value = 0;
-
-        // If the destination is memory
-        if (inst->dest_is_memory) {
-            // Read the current value from the destination memory
-            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("XCHG: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
-
-            // Determine the source value
-            if (inst->src_is_memory) {
-                // Source is memory, read value from memory
-                temp_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("XCHG: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", temp_value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                // Source is a register, swap with memory
-                temp_value = *inst->src_reg;
-                printf("XCHG: Reading value 0x%016" PRIx64 " from source register %s and swapping with memory address 0x%016" PRIx64 "\n", temp_value, inst->src_reg_name, inst->dest_mem_address);
-            }
-            else {
-                // Source is an immediate value
-                temp_value = inst->immediate;
-                printf("XCHG: Swapping immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", temp_value, inst->dest_mem_address);
-            }
-
-            // Write the source value (temp_value) to the destination memory
-            write_memory(emu, inst->dest_mem_address, temp_value, sizeof(uint64_t));
-
-            // Write the original memory value to the source memory (or register)
-            if (inst->src_is_memory) {
-                write_memory(emu, inst->src_mem_address, mem_value, sizeof(uint64_t));
-            }
-            else if (inst->src_reg) {
-                *inst->src_reg = mem_value;
-            }
-            else {
-                // Immediate case, should not happen for memory-based XCHG
-                fprintf(stderr, "XCHG: Invalid operand handling\n");
-                exit(EXIT_FAILURE);
-            }
-        }
-        // If the destination is a register
-        else if (inst->dest_reg) {
-            // Determine the source value
-            if (inst->src_is_memory) {
-                // Source is memory
-                temp_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("XCHG: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 " into destination register %s\n", temp_value, inst->src_mem_address, inst->dest_reg_name);
-            }
-            else if (inst->src_reg) {
-                // Source is another register
-                temp_value = *inst->src_reg;
-                printf("XCHG: Reading value 0x%016" PRIx64 " from source register %s and swapping with destination register %s\n", temp_value, inst->src_reg_name, inst->dest_reg_name);
-            }
-            else {
-                // Source is an immediate value
-                temp_value = inst->immediate;
-                printf("XCHG: Swapping immediate value 0x%016" PRIx64 " with destination register %s\n", temp_value, inst->dest_reg_name);
-            }
-
-            // Swap the values between source and destination
-            uint64_t temp = *inst->dest_reg;
-            *inst->dest_reg = temp_value;
-
-            if (inst->src_is_memory) {
-                write_memory(emu, inst->src_mem_address, temp, sizeof(uint64_t));
-            }
-            else if (inst->src_reg) {
-                *inst->src_reg = temp;
-            }
-
-            printf("XCHG: Swapped value 0x%016" PRIx64 " with destination register %s\n", temp, inst->dest_reg_name);
-        }
-        else {
-            // Invalid instruction format
-            fprintf(stderr, "XCHG: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    break;
-
-        // Arithmetic Instructions
-    case INST_ADD:
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-        uint64_t original_value = 0;
-        uint64_t result = 0;
-
-        if (inst->dest_is_memory) {
-            // Destination is memory
-            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("ADD: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("ADD: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("ADD: Adding value 0x%016" PRIx64 " from source register %s to memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
-            }
-            else {
-                value = inst->immediate;
-                printf("ADD: Adding immediate value 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-            }
-
-            // Perform the addition
-            result = mem_value + value;
-            printf("ADD: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < mem_value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((mem_value ^ result) & (value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Destination is a register
-            original_value = *inst->dest_reg;
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("ADD: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("ADD: Adding value 0x%016" PRIx64 " from source register %s to destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
-            }
-            else {
-                value = inst->immediate;
-                printf("ADD: Adding immediate value 0x%016" PRIx64 " to destination register %s\n", value, inst->dest_reg_name);
-            }
-
-            // Perform the addition
-            result = original_value + value;
-            printf("ADD: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
-
-            // Write the result to the destination register
-            *inst->dest_reg = result;
-
-            // Check for overflow
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Addition result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-                return;
-            }
-            // 64-bit can hold all results
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < original_value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((original_value ^ result) & (value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else {
-            fprintf(stderr, "ADD: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed ADD Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
-    }
-    break;
-
-    case INST_SUB:
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-        uint64_t original_value = 0;
-        uint64_t result = 0;
-
-        if (inst->dest_is_memory) {
-            // Destination is memory
-            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("SUB: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("SUB: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("SUB: Subtracting value 0x%016" PRIx64 " from source register %s from memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
-            }
-            else {
-                value = inst->immediate;
-                printf("SUB: Subtracting immediate value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-            }
-
-            // Perform the subtraction
-            result = mem_value - value;
-            printf("SUB: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (mem_value < value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((mem_value ^ value) & (mem_value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Destination is a register
-            original_value = *inst->dest_reg;
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("SUB: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("SUB: Subtracting value 0x%016" PRIx64 " from source register %s from destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
-            }
-            else {
-                value = inst->immediate;
-                printf("SUB: Subtracting immediate value 0x%016" PRIx64 " from destination register %s\n", value, inst->dest_reg_name);
-            }
-
-            // Perform the subtraction
-            result = original_value - value;
-            printf("SUB: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
-
-            // Write the result to the destination register
-            *inst->dest_reg = result;
-
-            // Check for underflow
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Subtraction result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-                return;
-            }
-            // 64-bit can hold all results
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (original_value < value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((original_value ^ value) & (original_value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else {
-            fprintf(stderr, "SUB: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed SUB Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
-    }
-    break;
-
-    case INST_MUL:
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-        uint64_t original_value = 0;
-        uint64_t result = 0;
-
-        if (inst->dest_is_memory) {
-            // Destination is memory
-            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("MUL: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("MUL: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("MUL: Multiplying value 0x%016" PRIx64 " from source register %s with memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
-            }
-            else {
-                value = inst->immediate;
-                printf("MUL: Multiplying immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-            }
-
-            // Perform the multiplication
-            result = mem_value * value;
-            printf("MUL: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < mem_value || result < value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((mem_value ^ result) & (value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Destination is a register
-            original_value = *inst->dest_reg;
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("MUL: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("MUL: Multiplying value 0x%016" PRIx64 " from source register %s with destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
-            }
-            else {
-                value = inst->immediate;
-                printf("MUL: Multiplying immediate value 0x%016" PRIx64 " with destination register %s\n", value, inst->dest_reg_name);
-            }
-
-            // Perform the multiplication
-            result = original_value * value;
-            printf("MUL: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
-
-            // Write the result to the destination register
-            *inst->dest_reg = result;
-
-            // Check for overflow
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Multiplication result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-                return;
-            }
-            // 64-bit can hold all results
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < original_value || result < value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((original_value ^ result) & (value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else {
-            fprintf(stderr, "MUL: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed MUL Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
-    }
-    break;
-
-    case INST_DIV:
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-        uint64_t original_value = 0;
-        uint64_t result = 0;
-
-        if (inst->dest_is_memory) {
-            // Destination is memory
-            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("DIV: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("DIV: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("DIV: Dividing value 0x%016" PRIx64 " from source register %s with memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
-            }
-            else {
-                value = inst->immediate;
-                printf("DIV: Dividing immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-            }
-
-            // Perform the division, ensuring no divide by zero
-            if (value == 0) {
-                fprintf(stderr, "DIV: Division by zero error\n");
-                exit(EXIT_FAILURE);
-            }
-
-            // Perform the division
-            result = mem_value / value;
-            printf("DIV: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = 0;  // Carry Flag (CF) is not applicable for division
-            emu->flags.overflow = 0;  // Overflow Flag (OF) is not applicable for division
-        }
-        else if (inst->dest_reg) {
-            // Destination is a register
-            original_value = *inst->dest_reg;
-
-            // Get the value from the source operand
-            uint64_t value = 0;
-            if (inst->src_is_memory) {
-                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-                printf("DIV: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
-            }
-            else if (inst->src_reg) {
-                value = *inst->src_reg;
-                printf("DIV: Dividing value 0x%016" PRIx64 " from source register %s with destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
-            }
-            else {
-                value = inst->immediate;
-                printf("DIV: Dividing immediate value 0x%016" PRIx64 " with destination register %s\n", value, inst->dest_reg_name);
-            }
-
-            // Perform the division, ensuring no divide by zero
-            if (value == 0) {
-                fprintf(stderr, "DIV: Division by zero error\n");
-                exit(EXIT_FAILURE);
-            }
-
-            // Perform the division
-            result = original_value / value;
-            printf("DIV: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
-
-            // Write the result to the destination register
-            *inst->dest_reg = result;
-
-            // Check if result fits in the register size
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Division result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-            }
-            // 64-bit can hold all results
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = 0;  // Carry Flag (CF) is not applicable for division
-            emu->flags.overflow = 0;  // Overflow Flag (OF) is not applicable for division
-        }
-        else {
-            fprintf(stderr, "DIV: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed DIV Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
-    }
-    break;
-
-    case INST_INC:
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-        uint64_t original_value = 0;
-        uint64_t result = 0;
-
-        if (inst->dest_is_memory) {
-            // Destination is memory
-            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("INC: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-
-            // Perform the increment
-            result = value + 1;
-            printf("INC: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the incremented result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Destination is a register
-            original_value = *inst->dest_reg;
-
-            // Perform the increment
-            result = original_value + 1;
-            printf("INC: Writing result 0x%016" PRIx64 " to register %s\n", result, inst->dest_reg_name);
-
-            // Write the incremented result to the register
-            *inst->dest_reg = result;
-
-            // Check for overflow
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Increment result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-                return;
-            }
-            // 64-bit can hold all results
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (result < original_value) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((original_value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else {
-            fprintf(stderr, "INC: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-
-        printf("Executed INC Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
-    }
-    break;
-
-    case INST_DEC:
-    {
-        // Determine if the destination is a register or memory
-        if (inst->dest_is_memory) {
-            // Read the current value from memory
-            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("DEC: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-
-            // Perform the decrement
-            uint64_t result = value - 1;
-            printf("DEC: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the decremented result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (value == 0) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = ((value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Determine register size
-            const char* dest_name = inst->dest_reg_name;
-            size_t size = get_register_size(dest_name);
-            uint64_t original_value = *inst->dest_reg;
-
-            // Perform the decrement
-            (*inst->dest_reg)--;
-
-            // Check for underflow (since unsigned, it wraps around)
-            // For simplicity, we'll allow it but notify
-            if (size == 32 && *inst->dest_reg > 0xFFFFFFFF) {
-                fprintf(stderr, "Warning: Decrement result 0x%016" PRIx64 " wrapped around for 32-bit register %s\n", *inst->dest_reg, dest_name);
-            }
-            // 64-bit can hold all results without wrapping in most practical scenarios
-
-            // Update zero flag
-            emu->flags.zero = (*inst->dest_reg == 0);
-
-            // Update sign flag
-            emu->flags.sign = (*inst->dest_reg & (1ULL << (size * 8 - 1))) != 0;
-
-            // Update overflow flag
-            emu->flags.overflow = ((original_value ^ *inst->dest_reg) & (1ULL << (size * 8 - 1))) != 0;
-
-            printf("Executed DEC Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, *inst->dest_reg);
-        }
-        else {
-            fprintf(stderr, "DEC: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    break;
-
-    case INST_NEG:
-    {
-        // Determine if the destination is a register or memory
-        if (inst->dest_is_memory) {
-            // Read the current value from memory
-            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("NEG: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-
-            // Perform the negation
-            uint64_t result = -value;
-            printf("NEG: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
-
-            // Write the negated result to memory
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-
-            // Set flags
-            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
-            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
-            emu->flags.carry = (value != 0) ? 1 : 0;  // Carry Flag (CF)
-            emu->flags.overflow = (value == (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
-        }
-        else if (inst->dest_reg) {
-            // Determine register size
-            const char* dest_name = inst->dest_reg_name;
-            size_t size = get_register_size(dest_name);
-            uint64_t original_value = *inst->dest_reg;
-
-            // Perform the negation
-            *inst->dest_reg = -(*inst->dest_reg);
-
-            // Check if result fits in the register size
-            if (size == 32 && *inst->dest_reg > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: Negation result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", *inst->dest_reg, dest_name);
-                return;
-            }
-            // 64-bit can hold all results
-
-            // Update zero flag
-            emu->flags.zero = (*inst->dest_reg == 0);
-
-            // Update sign flag
-            emu->flags.sign = (*inst->dest_reg & (1ULL << (size * 8 - 1))) != 0;
-
-            // Update overflow flag
-            emu->flags.overflow = (original_value == (1ULL << (size * 8 - 1)));
-
-            // Update carry flag
-            emu->flags.carry = (original_value != 0);
-
-            printf("Executed NEG Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, *inst->dest_reg);
-        }
-        else {
-            fprintf(stderr, "NEG: Invalid instruction format\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    break;
-
-    case INST_CMP:
-        // Handle CMP instruction
-    {
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-
-        uint64_t result;
-        if (inst->src_reg)
-            result = *inst->dest_reg - *inst->src_reg;
-        else
-            result = *inst->dest_reg - inst->immediate;
-
-
-        // Update zero flag
-        emu->flags.zero = (result == 0);
-
-        // Update sign flag
-        emu->flags.sign = (result & (1ULL << (size * 8 - 1))) != 0;
-
-        uint64_t operand_value = inst->src_reg ? *inst->src_reg : inst->immediate;
-        // Update carry flag
-        emu->flags.carry = (*inst->dest_reg < operand_value);
-
-        // Update overflow flag
-        emu->flags.overflow = ((*inst->dest_reg ^ operand_value) & (*inst->dest_reg ^ result) & (1ULL << (size * 8 - 1))) != 0;
-
-        printf("Executed CMP Instruction: Zero Flag = %d, Sign Flag = %d, Carry Flag = %d, Overflow Flag = %d\n",
-            emu->flags.zero, emu->flags.sign, emu->flags.carry, emu->flags.overflow);
-    }
-    break;
-    // Logical Instructions
-    case INST_AND:
-    {
-        uint64_t value1 = 0;
-        uint64_t value2 = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("AND: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value1 = *inst->dest_reg;
-            printf("AND: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
-        }
-
-        // Get the source operand
-        if (inst->src_is_memory) {
-            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("AND: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            value2 = *inst->src_reg;
-            printf("AND: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
-        }
-        else {
-            value2 = inst->immediate;
-            printf("AND: Using immediate value 0x%016" PRIx64 " for AND operation\n", value2);
-        }
-
-        // Perform the bitwise AND
-        uint64_t result = value1 & value2;
-        printf("AND: Result of 0x%016" PRIx64 " AND 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && result > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: AND result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-        }
-        // 64-bit can hold all results
-    }
-    break;
-
-    case INST_OR:
-    {
-        uint64_t value1 = 0;
-        uint64_t value2 = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("OR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value1 = *inst->dest_reg;
-            printf("OR: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
-        }
-
-        // Get the source operand
-        if (inst->src_is_memory) {
-            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("OR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            value2 = *inst->src_reg;
-            printf("OR: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
-        }
-        else {
-            value2 = inst->immediate;
-            printf("OR: Using immediate value 0x%016" PRIx64 " for OR operation\n", value2);
-        }
-
-        // Perform the bitwise OR
-        uint64_t result = value1 | value2;
-        printf("OR: Result of 0x%016" PRIx64 " OR 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && result > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: OR result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-        }
-        // 64-bit can hold all results
-
-        // Update zero flag
-        emu->flags.zero = (result == 0);
-
-        // Update sign flag
-        emu->flags.sign = (result & (1ULL << (size * 8 - 1))) != 0;
-    }
-    break;
-
-    case INST_XOR:
-    {
-        uint64_t value1 = 0;
-        uint64_t value2 = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("XOR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value1 = *inst->dest_reg;
-            printf("XOR: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
-        }
-
-        // Get the source operand
-        if (inst->src_is_memory) {
-            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("XOR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            value2 = *inst->src_reg;
-            printf("XOR: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
-        }
-        else {
-            value2 = inst->immediate;
-            printf("XOR: Using immediate value 0x%016" PRIx64 " for XOR operation\n", value2);
-        }
-
-        // Perform the bitwise XOR
-        uint64_t result = value1 ^ value2;
-        printf("XOR: Result of 0x%016" PRIx64 " XOR 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && result > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: XOR result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-        }
-        // 64-bit can hold all results
-    }
-    break;
-
-    case INST_NOT:
-    {
-        uint64_t value = 0;
-
-        // Get the operand (only one operand for NOT instruction)
-        if (inst->dest_is_memory) {
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("NOT: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value = *inst->dest_reg;
-            printf("NOT: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
-        }
-
-        // Perform the bitwise NOT (invert all bits)
-        uint64_t result = ~value;
-        printf("NOT: Inverted value 0x%016" PRIx64 " to 0x%016" PRIx64 "\n", value, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-
-        // Determine register size
-        const char* dest_name = inst->dest_reg_name;
-        size_t size = get_register_size(dest_name);
-
-        // Ensure the result fits in the register size
-        if (size == 32 && result > 0xFFFFFFFF) {
-            fprintf(stderr, "Error: NOT result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-        }
-        // 64-bit can hold all results
-    }
-    break;
-
-    // Shift and Rotate Instructions
-    case INST_SHL:
-    {
-        uint64_t value = 0;
-        uint64_t shift_count = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("SHL: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value = *inst->dest_reg;
-            printf("SHL: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
-        }
-
-        // Get the shift count (immediate or register value)
-        if (inst->src_is_memory) {
-            shift_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("SHL: Reading shift count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", shift_count, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            shift_count = *inst->src_reg;
-            printf("SHL: Reading shift count 0x%016" PRIx64 " from register %s\n", shift_count, inst->src_reg_name);
-        }
-        else {
-            shift_count = inst->immediate;
-            printf("SHL: Using immediate shift count 0x%016" PRIx64 "\n", shift_count);
-        }
-
-        // Perform the left shift
-        uint64_t result = value << shift_count;
-        printf("SHL: Shifted value 0x%016" PRIx64 " left by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, shift_count, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-
-        // Determine register size for overflow check
-        if (inst->dest_reg) {
-            const char* dest_name = inst->dest_reg_name;
-            size_t size = get_register_size(dest_name);
-
-            // Check for overflow by ensuring the value fits in the register size
-            if (size == 32 && result > 0xFFFFFFFF) {
-                fprintf(stderr, "Error: SHL result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
-            }
-        }
-    }
-    break;
-
-    case INST_SHR:
-    {
-        uint64_t value = 0;
-        uint64_t shift_count = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("SHR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value = *inst->dest_reg;
-            printf("SHR: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
-        }
-
-        // Get the shift count (immediate or register value)
-        if (inst->src_is_memory) {
-            shift_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("SHR: Reading shift count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", shift_count, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            shift_count = *inst->src_reg;
-            printf("SHR: Reading shift count 0x%016" PRIx64 " from register %s\n", shift_count, inst->src_reg_name);
-        }
-        else {
-            shift_count = inst->immediate;
-            printf("SHR: Using immediate shift count 0x%016" PRIx64 "\n", shift_count);
-        }
-
-        // Perform the right shift
-        uint64_t result = value >> shift_count;
-        printf("SHR: Shifted value 0x%016" PRIx64 " right by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, shift_count, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-    }
-    break;
-
-    case INST_ROL:
-    {
-        uint64_t value = 0;
-        uint64_t rotate_count = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("ROL: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value = *inst->dest_reg;
-            printf("ROL: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
-        }
-
-        // Get the rotate count (immediate or register value)
-        if (inst->src_is_memory) {
-            rotate_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("ROL: Reading rotate count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", rotate_count, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            rotate_count = *inst->src_reg;
-            printf("ROL: Reading rotate count 0x%016" PRIx64 " from register %s\n", rotate_count, inst->src_reg_name);
-        }
-        else {
-            rotate_count = inst->immediate;
-            printf("ROL: Using immediate rotate count 0x%016" PRIx64 "\n", rotate_count);
-        }
-
-        // Perform the left rotate
-        uint64_t result = (value << rotate_count) | (value >> (64 - rotate_count));
-        printf("ROL: Rotated value 0x%016" PRIx64 " left by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, rotate_count, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-    }
-    break;
-
-    case INST_ROR:
-    {
-        uint64_t value = 0;
-        uint64_t rotate_count = 0;
-
-        // Get the destination operand
-        if (inst->dest_is_memory) {
-            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
-            printf("ROR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
-        }
-        else if (inst->dest_reg) {
-            value = *inst->dest_reg;
-            printf("ROR: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
-        }
-
-        // Get the rotate count (immediate or register value)
-        if (inst->src_is_memory) {
-            rotate_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
-            printf("ROR: Reading rotate count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", rotate_count, inst->src_mem_address);
-        }
-        else if (inst->src_reg) {
-            rotate_count = *inst->src_reg;
-            printf("ROR: Reading rotate count 0x%016" PRIx64 " from register %s\n", rotate_count, inst->src_reg_name);
-        }
-        else {
-            rotate_count = inst->immediate;
-            printf("ROR: Using immediate rotate count 0x%016" PRIx64 "\n", rotate_count);
-        }
-
-        // Perform the right rotate
-        uint64_t result = (value >> rotate_count) | (value << (64 - rotate_count));
-        printf("ROR: Rotated value 0x%016" PRIx64 " right by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, rotate_count, result);
-
-        // Store the result in the destination (register or memory)
-        if (inst->dest_is_memory) {
-            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
-        }
-        else if (inst->dest_reg) {
-            *inst->dest_reg = result;
-        }
-    }
-    break;
-
-    // Control Flow Instructions
-    case INST_JMP:
-        // Handle unconditional jump
-        printf("JMP to label: %s\n", inst->label);
-        // Find the label and update rip
-        for (size_t i = 0; i < label_count; i++) {
-            if (strcmp(inst->label, labels[i].label) == 0) {
-                emu->rip = labels[i].index;
-                return;
-            }
-        }
-        fprintf(stderr, "Error: Label '%s' not found for JMP instruction at rip=%zu\n", inst->label, inst_num);
-        break;
-
-    case INST_JE:
-        if (emu->flags.zero == 1) { // Jump if Zero Flag is set
-            printf("JE condition met, jumping to label: %s\n", inst->label);
-            // Loop over all labels to find the target label
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    // Jump to the label by setting rip to the label's index
-                    emu->rip = labels[i].index;
-                    return; // Exit the function after jumping (skips remaining code)
-                }
-            }
-            // If label is not found
-            fprintf(stderr, "Error: Label '%s' not found for JE instruction at rip=%zu\n", inst_num);
-        }
-        else {
-            // If JE condition is not met, simply return to move to the next instruction
-            printf("JE condition not met, continuing execution\n");
-            return; // Return early, effectively skipping the current instruction
-        }
-        break;
-
-    case INST_JNE:
-        if (emu->flags.zero == 0) { // Jump if Zero Flag is not set
-            printf("JNE condition met, jumping to label: %s\n", inst->label);
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return; // Exit the function after jumping
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JNE instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        else {
-            // If the condition is not met, continue to the next instruction
-            printf("JNE condition not met, continuing execution\n");
-            return;
-        }
-        break;
-
-    case INST_JG:
-        // Handle jump if greater
-        if (!emu->flags.zero && !emu->flags.sign) {
-            printf("JG to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JG instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        else {
-            // If the condition is not met, continue to the next instruction
-            printf("JG condition not met, continuing execution\n");
-            return;
-        }
-        break;
-    case INST_JL:
-        // Handle jump if less
-        if (emu->flags.sign) {
-            printf("JL to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JL instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        else {
-            // If the condition is not met, continue to the next instruction
-            printf("JL condition not met, continuing execution\n");
-            return;
-        }
-        break;
-    case INST_JGE:
-        // Handle jump if greater or equal
-        if (!emu->flags.sign || emu->flags.zero) {
-            printf("JGE to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JGE instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JLE:
-        // Handle jump if less or equal
-        if (emu->flags.sign || emu->flags.zero) {
-            printf("JLE to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JLE instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JA:
-        // Handle jump if above (unsigned greater)
-        if (!emu->flags.carry && !emu->flags.zero) {
-            printf("JA to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JA instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JAE:
-        // Handle jump if above or equal (unsigned greater or equal)
-        if (!emu->flags.carry) {
-            printf("JAE to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JAE instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JB:
-        // Handle jump if below (unsigned less)
-        if (emu->flags.carry) {
-            printf("JB to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JB instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JBE:
-        // Handle jump if below or equal (unsigned less or equal)
-        if (emu->flags.carry || emu->flags.zero) {
-            printf("JBE to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JBE instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JO:
-        // Handle jump if overflow
-        if (emu->flags.overflow) {
-            printf("JO to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JO instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JNO:
-        // Handle jump if no overflow
-        if (!emu->flags.overflow) {
-            printf("JNO to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JNO instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JS:
-        // Handle jump if sign (negative)
-        if (emu->flags.sign) {
-            printf("JS to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JS instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JNS:
-        // Handle jump if no sign (non-negative)
-        if (!emu->flags.sign) {
-            printf("JNS to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JNS instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JP:
-        // Handle jump if parity even
-        if (emu->flags.parity) {
-            printf("JP to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JP instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-    case INST_JNP:
-        // Handle jump if no parity (odd)
-        if (!emu->flags.parity) {
-            printf("JNP to label: %s\n", inst->label);
-            // Find the label and update rip
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(inst->label, labels[i].label) == 0) {
-                    emu->rip = labels[i].index;
-                    return;
-                }
-            }
-            fprintf(stderr, "Error: Label '%s' not found for JNP instruction at rip=%zu\n", inst->label, inst_num);
-        }
-        break;
-        // Custom Instructions
-    case INST_POW:
-        execute_pow_instruction(emu, inst);
-        break;
-
-    case INST_ROOT:
-        execute_root_instruction(emu, inst);
-        break;
-
-    case INST_AVG:
-        execute_avg_instruction(emu, inst);
-        break;
-
-    case INST_MAX:
-        execute_max_instruction(emu, inst);
-        break;
-
-    case INST_MIN:
-        execute_min_instruction(emu, inst);
-        break;
-
-    case INST_MOD:
-        execute_mod_instruction(emu, inst);
-        break;
-
-    case INST_ISPRIME:
-        execute_isprime_instruction(emu, inst);
-        break;
-
-    case INST_MIRROR:
-        execute_mirror_instruction(emu, inst);
-        break;
-
-    case INST_NOP:
-        printf("Executed NOP Instruction: No operation performed\n");
-        break;
-
-    case INST_LABEL:
-        // Labels are handled during parsing; no action needed during execution
-        break;
-
-    case INST_COMMENT:
-        // Comments are ignored in execution
-        break;
-
-    default:
-        fprintf(stderr, "Unknown instruction type\n");
-    }
-
-    if (tracing_enabled) {
-        // Print registers after execution
-        print_emulator_state(emu, "After Execution");
-    }
-}
-
-
-// Function to execute instructions from a file
-void execute_file_instructions(Emulator* emu, const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
-        exit(1);
-    }
-
-    // Dynamic allocation for instructions and labels
-    size_t instruction_capacity = INITIAL_CAPACITY;
-    size_t instruction_count = 0;
-    Instruction* instructions = malloc(instruction_capacity * sizeof(Instruction));
-    if (!instructions) {
-        fprintf(stderr, "Error: Memory allocation failed for instructions\n");
-        exit(1);
-    }
-
-    size_t label_capacity = INITIAL_CAPACITY;
-    size_t label_count = 0;
-    Label* labels = malloc(label_capacity * sizeof(Label));
-    if (!labels) {
-        fprintf(stderr, "Error: Memory allocation failed for labels\n");
-        exit(1);
-    }
-
-    char line[256];
-    size_t line_num = 0;
-    while (fgets(line, sizeof(line), file)) {
-        line_num++;
-
-        // Remove newline character
-        line[strcspn(line, "\r\n")] = 0;
-
-        // Skip empty lines
-        if (strlen(line) == 0) continue;
-
-        // Handle comments
-        if (line[0] == ';') continue; // Skip entire line if it starts with ';'
-
-        // Tokenize the line
-        char* token = strtok(line, " \t,");
-        if (!token) continue;
-
-        // Check if the line is a label (ends with ':')
-        size_t tok_len = strlen(token);
-        if (token[tok_len - 1] == ':') {
-            token[tok_len - 1] = '\0'; // Remove ':'
-            if (label_count >= 1000) {
-                fprintf(stderr, "Error: Maximum label count exceeded\n");
-                exit(1);
-            }
-            strcpy(labels[label_count].label, token);
-            labels[label_count].index = instruction_count;
-            (label_count)++;
-            continue; // Labels are not actual instructions
-        }
-        // Get instruction type
-        InstructionType type = get_instruction_type(token);
-        if (type == INST_NOP && strcasecmp(token, "NOP") != 0) {
-            fprintf(stderr, "Error: Unknown instruction '%s' at line %zu\n", token, line_num);
-            continue;
-        }
-
-        // Initialize Instruction struct
-        Instruction inst;
-        memset(&inst, 0, sizeof(Instruction));
-        inst.type = type;
-        inst.immediate = 0;
-        inst.format = HEX; // Default to HEX as per user request
-
-        // Parse operands based on instruction type
-        switch (type) {
-
-        case INST_ADD:
-        case INST_SUB:
-        case INST_MUL:
-        case INST_DIV:
-        case INST_AND:
-        case INST_OR:
-        case INST_XOR:
-        case INST_MOD:
-        {
-            // Expect two operands: dest, src or immediate
-            char* operands[3] = { NULL, NULL, NULL };
-            int operand_count = 0;
-            // Collect up to two operands
-            while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-                operands[operand_count++] = token;
-            }
-            // Assign destination register or memory
-            if (operand_count >= 1) {
-                inst.dest_reg = get_register_pointer(emu, operands[0]);
-                if (!inst.dest_reg) {
-                    // Check if it's a memory address (e.g., "[0x100]")
-                    if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                        // Extract memory address (remove "[" and "]")
-                        char addr_str[20];  // Buffer to hold the address part
-                        char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                        char* end = strchr(operands[0], ']');       // Find the closing ']'
-                        if (end <= start) {
-                            fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                            break;
-                        }
-                        strncpy(addr_str, start, end - start);  // Copy the address part
-                        addr_str[end - start] = '\0';           // Null-terminate the address string
-                        inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                        inst.dest_is_memory = 1;  // Mark destination as memory
-                        strcpy(inst.dest_reg_name, operands[0]);  // Store original memory address notation
-                    }
-                    else {
-                        fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                        break;
-                    }
-                }
-                else {
-                    inst.dest_is_memory = 0;  // Mark destination as register
-                    strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing destination operand for '%s' at line %zu\n", (type == INST_MOV ? "MOV" :
-                    (type == INST_ADD ? "ADD" :
-                        (type == INST_SUB ? "SUB" :
-                            (type == INST_MUL ? "MUL" :
-                                (type == INST_DIV ? "DIV" :
-                                    (type == INST_AND ? "AND" :
-                                        (type == INST_OR ? "OR" :
-                                            (type == INST_XOR ? "XOR" : "MOD"))))))))), line_num;
-                                            break;
-            }
-            // Assign source register or immediate or memory
-            if (operand_count >= 2) {
-                uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-                if (src_ptr) {
-                    inst.src_reg = src_ptr;
-                    inst.src_is_memory = 0;  // Source is a register
-                    strcpy(inst.src_reg_name, operands[1]); // Store original register name
-                }
-                else if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-                    // Handle memory operand (e.g., "[0x100]")
-                    char addr_str[20];  // Buffer to hold the address part
-                    char* start = strchr(operands[1], '[') + 1;  // Start after '['
-                    char* end = strchr(operands[1], ']');       // Find the closing ']'
-                    if (end <= start) {
-                        fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                        break;
-                    }
-                    strncpy(addr_str, start, end - start);  // Copy the address part
-                    addr_str[end - start] = '\0';           // Null-terminate the address string
-                    inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                    inst.src_is_memory = 1;  // Source is memory
-                    strcpy(inst.src_reg_name, operands[1]);  // Store original memory address notation
-                }
-                else {
-                    // Assume immediate value
-                    if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-                        inst.immediate = strtoull(operands[1], NULL, 16);  // Hexadecimal
-                    }
-                    else {
-                        inst.immediate = strtoull(operands[1], NULL, 10);  // Decimal
-                    }
-                    inst.src_is_memory = 0;  // Source is immediate, not memory
-                    strcpy(inst.src_reg_name, operands[1]); // Store immediate value as name
-                }
-            }
-            else {
-                // Fill remaining operands with NULL or 0 if less than 2 operands
-                inst.src_reg = NULL;
-                inst.immediate = 0;
-                inst.src_is_memory = 0;  // No source memory in this case
-            }
-        }
-        break;
-
-case INST_MOV:
-    // Expect two operands: dest, src or immediate
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-        operands[operand_count++] = token;
-    }
-
-    // Assign destination register or memory
-    if (operand_count >= 1) {
-        if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-            // Memory address
-            char addr_str[20];
-            char* start = strchr(operands[0], '[') + 1;
-            char* end = strchr(operands[0], ']');
-            strncpy(addr_str, start, end - start);
-            addr_str[end - start] = '\0';
-            inst.dest_mem_address = strtoull(addr_str, NULL, 0);
-            inst.dest_is_memory = 1;
-            strcpy(inst.dest_reg_name, operands[0]);  // Store original memory address notation
-        } else {
-            // Register
-            inst.dest_reg = get_register_pointer(emu, operands[0]);
-            if (!inst.dest_reg) {
-                fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                break;
-            }
-            inst.dest_is_memory = 0;
-            strcpy(inst.dest_reg_name, operands[0]);
-        }
-    } else {
-        fprintf(stderr, "Error: Missing destination operand for 'MOV' at line %zu\n", line_num);
-        break;
-    }
-
-    // Assign source register, immediate, or string
-    if (operand_count >= 2) {
-        if (operands[1][0] == '"') {
-            // String literal
-            inst.src_is_string = 1;
-            // Remove quotes and copy the entire string
-            size_t len = strlen(operands[1]);
-            if (len >= 2) {
-                strncpy(inst.src_string, operands[1] + 1, len - 2);
-                inst.src_string[len - 2] = '\0'; // Null-terminate
-            }
-        } else {
-            uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-            if (src_ptr) {
-                inst.src_reg = src_ptr;
-                inst.src_is_memory = 0;  // Source is a register
-                strcpy(inst.src_reg_name, operands[1]); // Store original register name
-            } else if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-                // Handle memory operand (e.g., "[0x100]")
-                char addr_str[20];  // Buffer to hold the address part
-                char* start = strchr(operands[1], '[') + 1;  // Start after '['
-                char* end = strchr(operands[1], ']');       // Find the closing ']'
-                if (end <= start) {
-                    fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                    break;
-                }
-                strncpy(addr_str, start, end - start);  // Copy the address part
-                addr_str[end - start] = '\0';           // Null-terminate the address string
-                inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                inst.src_is_memory = 1;  // Source is memory
-                strcpy(inst.src_reg_name, operands[1]);  // Store original memory address notation
-            } else {
-                // Assume immediate value
-                if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-                    inst.immediate = strtoull(operands[1], NULL, 16);  // Hexadecimal
-                } else {
-                    inst.immediate = strtoull(operands[1], NULL, 10);  // Decimal
-                }
-                inst.src_is_memory = 0;  // Source is immediate, not memory
-                strcpy(inst.src_reg_name, operands[1]); // Store immediate value as name
-            }
-        }
-    } else {
-        // Fill remaining operands with NULL or 0 if less than 2 operands
-        inst.src_reg = NULL;
-        inst.immediate = 0;
-        inst.src_is_memory = 0;  // No source memory in this case
-    }
-    break;
-
-            case INST_INT:
-            {
-                char* operands[2] = { NULL, NULL };
-                int operand_count = 0;
-
-                // Collect operands
-                while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-                    operands[operand_count++] = token;
-                }
-
-                // Parse the interrupt number
-                if (operand_count >= 1) {
-                    // Get the interrupt number
-                    if (strncmp(operands[0], "0x", 2) == 0) {
-                        inst.immediate = strtoull(operands[0], NULL, 16);  // Hexadecimal
-                    } else {
-                        inst.immediate = strtoull(operands[0], NULL, 10);  // Decimal
-                    }
-
-                    // If there's a second operand, it's the interrupt function number
-                    if (operand_count == 2) {
-                        if (strncmp(operands[1], "0x", 2) == 0) {
-                            inst.function = strtoull(operands[1], NULL, 16);  // Hexadecimal
-                        } else {
-                            inst.function = strtoull(operands[1], NULL, 10);  // Decimal
-                        }
-                    }
-                }
-            }
-            break;
-
-        case INST_PUSH:
-        case INST_POP:
-        case INST_NEG:
-        case INST_INC:
-        case INST_DEC:
-        case INST_NOT:
-        {
-            // Expect one operand: either a register or memory
-            char* operand = strtok(NULL, " \t,");
-            if (operand) {
-                inst.dest_reg = get_register_pointer(emu, operand);
-                if (!inst.dest_reg) {
-                    // Check if it's a memory address (e.g., "[0x100]")
-                    if (strchr(operand, '[') != NULL && strchr(operand, ']') != NULL) {
-                        // Extract memory address (remove "[" and "]")
-                        char addr_str[20];  // Buffer to hold the address part
-                        char* start = strchr(operand, '[') + 1;  // Start after '['
-                        char* end = strchr(operand, ']');       // Find the closing ']'
-                        if (end <= start) {
-                            fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operand, line_num);
-                            break;
-                        }
-                        strncpy(addr_str, start, end - start);  // Copy the address part
-                        addr_str[end - start] = '\0';           // Null-terminate the address string
-                        inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                        inst.dest_is_memory = 1;  // Mark destination as memory
-                        strcpy(inst.dest_reg_name, operand); // Store original memory address notation
-                    }
-                    else {
-                        fprintf(stderr, "Error: Invalid operand '%s' at line %zu\n", operand, line_num);
-                        break;
-                    }
-                }
-                else {
-                    inst.dest_is_memory = 0;  // Mark destination as register
-                    strcpy(inst.dest_reg_name, operand); // Store original register name
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing operand for '%s' at line %zu\n", (type == INST_PUSH ? "PUSH" :
-                    (type == INST_POP ? "POP" :
-                        (type == INST_NEG ? "NEG" :
-                            (type == INST_INC ? "INC" :
-                                (type == INST_DEC ? "DEC" : "NOT"))))), line_num);
-                break;
-            }
-
-            // Ensure source-related fields are unset for these instructions
-            inst.src_reg = NULL;
-            inst.immediate = 0;
-            inst.src_is_memory = 0;
-        }
-        break;
-
-        case INST_CMP:
-        {
-            // Expect two operands: dest, src or immediate
-            char* operands[3] = { NULL, NULL, NULL };
-            int operand_count = 0;
-            // Collect up to two operands
-            while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-                operands[operand_count++] = token;
-            }
-            // Assign destination register or memory
-            if (operand_count >= 1) {
-                inst.dest_reg = get_register_pointer(emu, operands[0]);
-                if (!inst.dest_reg) {
-                    // Check if it's a memory address (e.g., "[0x100]")
-                    if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                        // Extract memory address (remove "[" and "]")
-                        char addr_str[20];  // Buffer to hold the address part
-                        char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                        char* end = strchr(operands[0], ']');       // Find the closing ']'
-                        if (end <= start) {
-                            fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                            break;
-                        }
-                        strncpy(addr_str, start, end - start);  // Copy the address part
-                        addr_str[end - start] = '\0';           // Null-terminate the address string
-                        inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                        inst.dest_is_memory = 1;  // Mark destination as memory
-                        strcpy(inst.dest_reg_name, operands[0]); // Store original memory address notation
-                    }
-                    else {
-                        fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                        break;
-                    }
-                }
-                else {
-                    inst.dest_is_memory = 0;  // Mark destination as register
-                    strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing destination operand for 'CMP' at line %zu\n", line_num);
-                break;
-            }
-            // Assign source register or immediate or memory
-            if (operand_count >= 2) {
-                uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-                if (src_ptr) {
-                    inst.src_reg = src_ptr;
-                    inst.src_is_memory = 0;  // Source is a register
-                    strcpy(inst.src_reg_name, operands[1]); // Store original register name
-                }
-                else if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-                    // Handle memory operand (e.g., "[0x100]")
-                    char addr_str[20];  // Buffer to hold the address part
-                    char* start = strchr(operands[1], '[') + 1;  // Start after '['
-                    char* end = strchr(operands[1], ']');       // Find the closing ']'
-                    if (end <= start) {
-                        fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                        break;
-                    }
-                    strncpy(addr_str, start, end - start);  // Copy the address part
-                    addr_str[end - start] = '\0';           // Null-terminate the address string
-                    inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                    inst.src_is_memory = 1;  // Source is memory
-                    strcpy(inst.src_reg_name, operands[1]);  // Store original memory address notation
-                }
-                else {
-                    // Assume immediate value
-                    if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-                        inst.immediate = strtoull(operands[1], NULL, 16);  // Hexadecimal
-                    }
-                    else {
-                        inst.immediate = strtoull(operands[1], NULL, 10);  // Decimal
-                    }
-                    inst.src_is_memory = 0;  // Source is immediate, not memory
-                    strcpy(inst.src_reg_name, operands[1]); // Store immediate value as name
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing source operand for 'CMP' at line %zu\n", line_num);
-                break;
-            }
-        }
-        break;
-
-        case INST_XCHG:
-        {
-            // Expect two operands: src, dest
-            char* operands[3] = { NULL, NULL, NULL };
-            int operand_count = 0;
-
-            // Collect up to two operands
-            while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-                operands[operand_count++] = token;
-            }
-
-            // Assign destination operand (this will be the first operand)
-            if (operand_count >= 1) {
-                inst.dest_reg = get_register_pointer(emu, operands[0]);
-                if (!inst.dest_reg) {
-                    // Check if it's a memory address (e.g., "[0x100]")
-                    if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                        // Extract memory address (remove "[" and "]")
-                        char addr_str[20];  // Buffer to hold the address part
-                        char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                        char* end = strchr(operands[0], ']');       // Find the closing ']'
-                        if (end <= start) {
-                            fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                            break;
-                        }
-                        strncpy(addr_str, start, end - start);  // Copy the address part
-                        addr_str[end - start] = '\0';           // Null-terminate the address string
-                        inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                        inst.dest_is_memory = 1;  // Mark destination as memory
-                    }
-                    else {
-                        fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                        break;
-                    }
-                }
-                else {
-                    inst.dest_is_memory = 0;  // Mark destination as register
-                    // Store original register name (added from second code)
-                    strcpy(inst.dest_reg_name, operands[0]);
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing destination operand for instruction at line %zu\n", line_num);
-                break;
-            }
-
-            // Assign source operand (this will be the second operand)
-            if (operand_count >= 2) {
-                inst.src_reg = get_register_pointer(emu, operands[1]);
-                if (!inst.src_reg) {
-                    // Check if it's a memory address (e.g., "[0x100]")
-                    if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-                        // Extract memory address (remove "[" and "]")
-                        char addr_str[20];  // Buffer to hold the address part
-                        char* start = strchr(operands[1], '[') + 1;  // Start after '['
-                        char* end = strchr(operands[1], ']');       // Find the closing ']'
-                        if (end <= start) {
-                            fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                            break;
-                        }
-                        strncpy(addr_str, start, end - start);  // Copy the address part
-                        addr_str[end - start] = '\0';           // Null-terminate the address string
-                        inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                        inst.src_is_memory = 1;  // Source is memory
-                    }
-                    else {
-                        fprintf(stderr, "Error: Invalid source operand '%s' at line %zu\n", operands[1], line_num);
-                        break;
-                    }
-                }
-                else {
-                    inst.src_is_memory = 0;  // Source is a register
-                    // Store original register name (added from second code)
-                    strcpy(inst.src_reg_name, operands[1]);
-                }
-            }
-            else {
-                fprintf(stderr, "Error: Missing source operand for instruction at line %zu\n", line_num);
-                break;
-            }
-
-            // Now perform the exchange (swap the values)
-            if (inst.dest_is_memory && inst.src_is_memory) {
-                // Swap values between two memory locations
-                uint64_t temp = read_memory(emu, inst.dest_mem_address,sizeof(temp));
-                uint64_t src_val = read_memory(emu, inst.src_mem_address,sizeof(src_val));
-                write_memory(emu, inst.dest_mem_address, src_val,sizeof(src_val));
-                write_memory(emu, inst.src_mem_address, temp,sizeof(temp));
-            }
-            else if (inst.dest_is_memory && !inst.src_is_memory) {
-                // Swap value between memory and register
-                uint64_t temp = read_memory(emu, inst.dest_mem_address,sizeof(temp));
-                uint64_t src_val = *inst.src_reg;
-                write_memory(emu, inst.dest_mem_address, src_val,sizeof(src_val));
-                *inst.src_reg = temp;
-            }
-            else if (!inst.dest_is_memory && inst.src_is_memory) {
-                // Swap value between register and memory
-                uint64_t temp = *inst.dest_reg;
-                uint64_t src_val = read_memory(emu, inst.src_mem_address,sizeof(src_val));
-                *inst.dest_reg = src_val;
-                write_memory(emu, inst.src_mem_address, temp,sizeof(temp));
-            }
-            else if (!inst.dest_is_memory && !inst.src_is_memory) {
-                // Swap values between two registers
-                uint64_t temp = *inst.dest_reg;
-                *inst.dest_reg = *inst.src_reg;
-                *inst.src_reg = temp;
-            }
-
-            // No flags need to be set for XCHG since it's a simple swap operation
-        }
-        break;
-
-case INST_ROL:
-case INST_ROR:
-case INST_SHL:
-case INST_SHR:
-{
-    // Expect two operands: dest, src or immediate
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-    // Collect up to two operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-        operands[operand_count++] = token;
-    }
-
-    // Assign destination operand (this will be the first operand)
-    if (operand_count >= 1) {
-        inst.dest_reg = get_register_pointer(emu, operands[0]);
-        if (!inst.dest_reg) {
-            // Check if it's a memory address (e.g., "[0x100]")
-            if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                // Extract memory address (remove "[" and "]")
-                char addr_str[20];  // Buffer to hold the address part
-                char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                char* end = strchr(operands[0], ']');       // Find the closing ']'
-                if (end <= start) {
-                    fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                    break;
-                }
-                strncpy(addr_str, start, end - start);  // Copy the address part
-                addr_str[end - start] = '\0';           // Null-terminate the address string
-                inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                inst.dest_is_memory = 1;  // Mark destination as memory
-            }
-            else {
-                fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                break;
-            }
-        }
-        else {
-            inst.dest_is_memory = 0;  // Mark destination as register
-            strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-        }
-    }
-    else {
-        fprintf(stderr, "Error: Missing destination operand for '%s' at line %zu\n",
-            (type == INST_ROL ? "ROL" :
-                (type == INST_ROR ? "ROR" :
-                    (type == INST_SHL ? "SHL" : "SHR"))), line_num);
-        break;
-    }
-
-    // Assign source (shift amount) operand
-    uint64_t shift_amount = 0;
-    if (operand_count >= 2) {
-        uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-        if (src_ptr) {
-            // If it's a register, get its value
-            inst.src_reg = src_ptr;
-            strcpy(inst.src_reg_name, operands[1]); // Store original register name
-            shift_amount = *src_ptr;
-        }
-        else {
-            // Assume immediate value
-            if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-                shift_amount = strtoull(operands[1], NULL, 16);
-            }
-            else {
-                shift_amount = strtoull(operands[1], NULL, 10);
-            }
-            inst.immediate = shift_amount;
-        }
-    }
-    else {
-        // If no second operand, set shift amount to 0
-        shift_amount = 0;
-        inst.src_reg = NULL;
-        inst.immediate = 0;
-    }
-
-    // Perform the operation based on the instruction type
-    if (inst.dest_is_memory) {
-        uint64_t value = read_memory(emu, inst.dest_mem_address,sizeof(value));
-        switch (type) {
-        case INST_ROL:
-            value = (value << shift_amount) | (value >> (64 - shift_amount));
-            break;
-        case INST_ROR:
-            value = (value >> shift_amount) | (value << (64 - shift_amount));
-            break;
-        case INST_SHL:
-            value <<= shift_amount;
-            break;
-        case INST_SHR:
-            value >>= shift_amount;
-            break;
-        }
-        write_memory(emu, inst.dest_mem_address, value,sizeof(value));
-    }
-    else {
-        uint64_t* reg_value = inst.dest_reg;
-        switch (type) {
-        case INST_ROL:
-            *reg_value = (*reg_value << shift_amount) | (*reg_value >> (64 - shift_amount));
-            break;
-        case INST_ROR:
-            *reg_value = (*reg_value >> shift_amount) | (*reg_value << (64 - shift_amount));
-            break;
-        case INST_SHL:
-            *reg_value <<= shift_amount;
-            break;
-        case INST_SHR:
-            *reg_value >>= shift_amount;
-            break;
-        }
-    }
-    // No flags need to be set for these operations as it's purely bit manipulation
-}
-break;
-
-case INST_POW:
-{
-    // Expect two operands: base (register or memory), and exponent (register, memory, or immediate)
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-
-    // Collect up to two operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-        operands[operand_count++] = token;
-    }
-
-    // Assign the base operand (this will be the first operand)
-    if (operand_count >= 1) {
-        inst.dest_reg = get_register_pointer(emu, operands[0]);
-        if (!inst.dest_reg) {
-            // Check if it's a memory address (e.g., "[0x100]")
-            if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                // Extract memory address (remove "[" and "]")
-                char addr_str[20];  // Buffer to hold the address part
-                char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                char* end = strchr(operands[0], ']');       // Find the closing ']'
-                if (end <= start) {
-                    fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                    break;
-                }
-                strncpy(addr_str, start, end - start);  // Copy the address part
-                addr_str[end - start] = '\0';           // Null-terminate the address string
-                inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                inst.dest_is_memory = 1;  // Mark destination as memory
-            }
-            else {
-                fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                break;
-            }
-        }
-        else {
-            inst.dest_is_memory = 0;  // Mark destination as register
-            strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-        }
-    }
-    else {
-        fprintf(stderr, "Error: Missing destination operand for 'POW' at line %zu\n", line_num);
-        break;
-    }
-
-    // Assign the exponent operand (this will be the second operand)
-    if (operand_count >= 2) {
-        uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-        if (src_ptr) {
-            // If it's a register
-            inst.src_reg = src_ptr;
-            inst.src_is_memory = 0;  // Source is a register
-            strcpy(inst.src_reg_name, operands[1]); // Store original register name
-        }
-        else if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-            // Handle memory operand (e.g., "[0x100]")
-            char addr_str[20];  // Buffer to hold the address part
-            char* start = strchr(operands[1], '[') + 1;  // Start after '['
-            char* end = strchr(operands[1], ']');       // Find the closing ']'
-            if (end <= start) {
-                fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                break;
-            }
-            strncpy(addr_str, start, end - start);  // Copy the address part
-            addr_str[end - start] = '\0';           // Null-terminate the address string
-            inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-            inst.src_is_memory = 1;  // Source is memory
-        }
-        else {
-            // Assume immediate value
-            if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-                inst.immediate = strtoull(operands[1], NULL, 16);  // Hexadecimal
-            }
-            else {
-                inst.immediate = strtoull(operands[1], NULL, 10);  // Decimal
-            }
-            inst.src_is_memory = 0;  // Source is immediate, not memory
-        }
-    }
-    else {
-        fprintf(stderr, "Error: Missing exponent operand for 'POW' at line %zu\n", line_num);
-        break;
-    }
-}
-break;
-
-case INST_ROOT:
-{
-    // Expect three operands: dest, src, aux
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-    // Collect up to three operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 3) {
-        operands[operand_count++] = token;
-    }
-
-    // Validate operand count
-    if (operand_count != 3) {
-        fprintf(stderr, "Error: 'ROOT' requires exactly three operands at line %zu\n", line_num);
-        break;
-    }
-
-    // Destination operand handling
-    inst.dest_reg = get_register_pointer(emu, operands[0]);
-    if (!inst.dest_reg) {
-        // Check if it's a memory address
-        if (operands[0][0] == '[' && operands[0][strlen(operands[0]) - 1] == ']') {
-            char addr_str[32];
-            strncpy(addr_str, operands[0] + 1, strlen(operands[0]) - 2);
-            addr_str[strlen(operands[0]) - 2] = '\0';
-            inst.dest_mem_address = strtoull(addr_str, NULL, 0);
-            inst.dest_is_memory = 1;
-
-            // Clear register name for memory address
-            memset(inst.dest_reg_name, 0, sizeof(inst.dest_reg_name));
-        }
-        else {
-            fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-            break;
-        }
-    }
-    else {
-        // Store original register name for registers
-        strcpy(inst.dest_reg_name, operands[0]);
-    }
-
-    // Source (base) operand handling
-    inst.src_reg = get_register_pointer(emu, operands[1]);
-    if (!inst.src_reg) {
-        // Check if it's a memory address
-        if (operands[1][0] == '[' && operands[1][strlen(operands[1]) - 1] == ']') {
-            char addr_str[32];
-            strncpy(addr_str, operands[1] + 1, strlen(operands[1]) - 2);
-            addr_str[strlen(operands[1]) - 2] = '\0';
-            inst.src_mem_address = strtoull(addr_str, NULL, 0);
-            inst.src_is_memory = 1;
-
-            // Clear register name for memory address
-            memset(inst.src_reg_name, 0, sizeof(inst.src_reg_name));
-        }
-        else {
-            // Try parsing as immediate
-            char* endptr;
-            inst.immediate = strtoull(operands[1], &endptr, 0);
-            if (*endptr != '\0') {
-                fprintf(stderr, "Error: Invalid base operand '%s' at line %zu\n", operands[1], line_num);
-                break;
-            }
-
-            // Clear register name for immediate value
-            memset(inst.src_reg_name, 0, sizeof(inst.src_reg_name));
-        }
-    }
-    else {
-        // Store original register name for registers
-        strcpy(inst.src_reg_name, operands[1]);
-    }
-
-    // Auxiliary (exponent) operand handling
-    inst.aux_reg = get_register_pointer(emu, operands[2]);
-    if (!inst.aux_reg) {
-        // Check if it's a memory address
-        if (operands[2][0] == '[' && operands[2][strlen(operands[2]) - 1] == ']') {
-            char addr_str[32];
-            strncpy(addr_str, operands[2] + 1, strlen(operands[2]) - 2);
-            addr_str[strlen(operands[2]) - 2] = '\0';
-            inst.aux_mem_address = strtoull(addr_str, NULL, 0);
-            inst.aux_is_memory = 1;
-
-            // Clear register name for memory address
-            memset(inst.aux_reg_name, 0, sizeof(inst.aux_reg_name));
-        }
-        else {
-            // Try parsing as immediate
-            char* endptr;
-            inst.aux_immediate = strtoull(operands[2], &endptr, 0);
-            if (*endptr != '\0') {
-                fprintf(stderr, "Error: Invalid exponent operand '%s' at line %zu\n", operands[2], line_num);
-                break;
-            }
-
-            // Clear register name for immediate value
-            memset(inst.aux_reg_name, 0, sizeof(inst.aux_reg_name));
-        }
-    }
-    else {
-        // Store original register name for registers
-        strcpy(inst.aux_reg_name, operands[2]);
-    }
-}
-break;
-
-
-case INST_AVG:
-{
-    // Expect three operands: dest, src, aux
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-    // Collect up to three operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 3) {
-        operands[operand_count++] = token;
-    }
-
-    // Validate operand count
-    if (operand_count != 3) {
-        fprintf(stderr, "Error: 'AVG' requires exactly three operands at line %zu\n", line_num);
-        break;
-    }
-
-    // Destination operand handling
-    inst.dest_reg = get_register_pointer(emu, operands[0]);
-    if (!inst.dest_reg) {
-        fprintf(stderr, "Error: Invalid destination register '%s' at line %zu\n", operands[0], line_num);
-        break;
-    }
-    strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-
-    // Source operand handling
-    inst.src_reg = get_register_pointer(emu, operands[1]);
-    if (inst.src_reg) {
-        // It's a register
-        inst.src_is_memory = 0;
-        inst.src_immediate = 0;
-        strcpy(inst.src_reg_name, operands[1]);
-    }
-    else if (operands[1][0] == '[' && operands[1][strlen(operands[1]) - 1] == ']') {
-        // It's a memory reference
-        char addr_str[32];
-        strncpy(addr_str, operands[1] + 1, strlen(operands[1]) - 2);
-        addr_str[strlen(operands[1]) - 2] = '\0';
-        inst.src_mem_address = strtoull(addr_str, NULL, 0);
-        inst.src_is_memory = 1;
-        inst.src_immediate = 0;
-        memset(inst.src_reg_name, 0, sizeof(inst.src_reg_name));
-    }
-    else {
-        // Try parsing as immediate
-        char* endptr;
-        inst.immediate = strtoull(operands[1], &endptr, 0);
-        if (*endptr != '\0') {
-            fprintf(stderr, "Error: Invalid source operand '%s' at line %zu\n", operands[1], line_num);
-            break;
-        }
-        inst.src_immediate = 1;
-        inst.src_is_memory = 0;
-        memset(inst.src_reg_name, 0, sizeof(inst.src_reg_name));
-    }
-
-    // Auxiliary operand handling
-    inst.aux_reg = get_register_pointer(emu, operands[2]);
-    if (inst.aux_reg) {
-        // It's a register
-        inst.aux_is_memory = 0;
-        inst.aux_immediate = 0;
-        strcpy(inst.aux_reg_name, operands[2]);
-    }
-    else if (operands[2][0] == '[' && operands[2][strlen(operands[2]) - 1] == ']') {
-        // It's a memory reference
-        char addr_str[32];
-        strncpy(addr_str, operands[2] + 1, strlen(operands[2]) - 2);
-        addr_str[strlen(operands[2]) - 2] = '\0';
-        inst.aux_mem_address = strtoull(addr_str, NULL, 0);
-        inst.aux_is_memory = 1;
-        inst.aux_immediate = 0;
-        memset(inst.aux_reg_name, 0, sizeof(inst.aux_reg_name));
-    }
-    else {
-        // Try parsing as immediate
-        char* endptr;
-        inst.aux_immediate = strtoull(operands[2], &endptr, 0);
-        if (*endptr != '\0') {
-            fprintf(stderr, "Error: Invalid auxiliary operand '%s' at line %zu\n", operands[2], line_num);
-            break;
-        }
-        inst.aux_immediate = 1;
-        inst.aux_is_memory = 0;
-        memset(inst.aux_reg_name, 0, sizeof(inst.aux_reg_name));
-    }
-}
-break;
-
-case INST_MIN:
-case INST_MAX:
-{
-    // Expect three operands: dest, src, aux
-    char* operands[3] = { NULL, NULL, NULL };
-    int operand_count = 0;
-
-    // Collect up to three operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 3) {
-        operands[operand_count++] = token;
-    }
-
-    // Check if exactly three operands are provided
-    if (operand_count != 3) {
-        fprintf(stderr, "Error: %s instruction requires exactly three operands at line %zu\n",
-            (type == INST_MIN ? "MIN" : "MAX"), line_num);
-        break;
-    }
-
-    // First operand must be a register (destination)
-    inst.dest_reg = get_register_pointer(emu, operands[0]);
-    if (!inst.dest_reg) {
-        fprintf(stderr, "Error: First operand must be a register at line %zu\n", line_num);
-        break;
-    }
-    strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-
-    // Parse second operand (src): register, memory, or immediate
-    if ((inst.src_reg = get_register_pointer(emu, operands[1]))) {
-        inst.src_is_memory = 0; // Source is a register
-        inst.src_immediate = 0;
-        strcpy(inst.src_reg_name, operands[1]); // Store original register name
-    }
-    else if (operands[1][0] == '[') {
-        // Handle memory operand (e.g., "[0x100]")
-        char* end_bracket = strchr(operands[1], ']');
-        if (!end_bracket) {
-            fprintf(stderr, "Error: Invalid memory syntax at line %zu\n", line_num);
-            break;
-        }
-        *end_bracket = '\0'; // Null-terminate the address string
-        inst.src_mem_address = strtoull(operands[1] + 1, NULL, 0); // Parse memory address
-        inst.src_is_memory = 1; // Source is memory
-        inst.src_immediate = 0;
-    }
-    else {
-        // Handle immediate value
-        char* endptr;
-        inst.immediate = strtoull(operands[1], &endptr, 0); // Parse immediate value
-        if (*endptr != '\0') {
-            fprintf(stderr, "Error: Invalid second operand at line %zu\n", line_num);
-            break;
-        }
-        inst.src_immediate = 1; // Source is immediate
-        inst.src_is_memory = 0;
-    }
-
-    // Parse third operand (aux): register, memory, or immediate
-    if ((inst.aux_reg = get_register_pointer(emu, operands[2]))) {
-        inst.aux_is_memory = 0; // Auxiliary is a register
-        inst.aux_immediate = 0;
-        strcpy(inst.aux_reg_name, operands[2]); // Store original register name
-    }
-    else if (operands[2][0] == '[') {
-        // Handle memory operand (e.g., "[0x100]")
-        char* end_bracket = strchr(operands[2], ']');
-        if (!end_bracket) {
-            fprintf(stderr, "Error: Invalid memory syntax at line %zu\n", line_num);
-            break;
-        }
-        *end_bracket = '\0'; // Null-terminate the address string
-        inst.aux_mem_address = strtoull(operands[2] + 1, NULL, 0); // Parse memory address
-        inst.aux_is_memory = 1; // Auxiliary is memory
-        inst.aux_immediate = 0;
-    }
-    else {
-        // Handle immediate value
-        char* endptr;
-        inst.aux_immediate = strtoull(operands[2], &endptr, 0); // Parse immediate value
-        if (*endptr != '\0') {
-            fprintf(stderr, "Error: Invalid third operand at line %zu\n", line_num);
-            break;
-        }
-        inst.aux_immediate = 1; // Auxiliary is immediate
-        inst.aux_is_memory = 0;
-    }
-}
-break;
-
-case INST_MIRROR:
-case INST_ISPRIME:
-{
-    // Expect two operands: dest, src
-    char* operands[2] = { NULL, NULL };
-    int operand_count = 0;
-
-    // Collect up to two operands
-    while ((token = strtok(NULL, " \t,")) != NULL && operand_count < 2) {
-        operands[operand_count++] = token;
-    }
-
-    // Assign the destination operand (first operand)
-    if (operand_count >= 1) {
-        inst.dest_reg = get_register_pointer(emu, operands[0]);
-        if (!inst.dest_reg) {
-            // Check if it's a memory address (e.g., "[0x100]")
-            if (strchr(operands[0], '[') != NULL && strchr(operands[0], ']') != NULL) {
-                // Extract memory address (remove "[" and "]")
-                char addr_str[20];  // Buffer to hold the address part
-                char* start = strchr(operands[0], '[') + 1;  // Start after '['
-                char* end = strchr(operands[0], ']');       // Find the closing ']'
-                if (end <= start) {
-                    fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[0], line_num);
-                    break;
-                }
-                strncpy(addr_str, start, end - start);  // Copy the address part
-                addr_str[end - start] = '\0';           // Null-terminate the address string
-                inst.dest_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                inst.dest_is_memory = 1;  // Mark destination as memory
-            }
-            else {
-                fprintf(stderr, "Error: Invalid destination operand '%s' at line %zu\n", operands[0], line_num);
-                break;
-            }
-        }
-        else {
-            inst.dest_is_memory = 0;  // Mark destination as register
-            strcpy(inst.dest_reg_name, operands[0]); // Store original register name
-        }
-    }
-    else {
-        fprintf(stderr, "Error: Missing destination operand for '%s' at line %zu\n", (type == INST_MIRROR ? "MIRROR" : "ISPRIME"), line_num);
-        break;
-    }
-
-    // Assign the source operand (second operand)
-    if (operand_count >= 2) {
-        if (strncmp(operands[1], "0x", 2) == 0 || strncmp(operands[1], "0X", 2) == 0) {
-            // Handle immediate value (hexadecimal)
-            inst.immediate = strtoull(operands[1], NULL, 16);
-            inst.src_is_memory = 0;  // Source is an immediate
-        }
-        else {
-            uint64_t* src_ptr = get_register_pointer(emu, operands[1]);
-            if (src_ptr) {
-                // Handle register source
-                inst.src_reg = src_ptr;
-                inst.src_is_memory = 0;  // Source is a register
-                strcpy(inst.src_reg_name, operands[1]); // Store original register name
-            }
-            else if (strchr(operands[1], '[') != NULL && strchr(operands[1], ']') != NULL) {
-                // Handle memory operand (e.g., "[0x100]")
-                char addr_str[20];  // Buffer to hold the address part
-                char* start = strchr(operands[1], '[') + 1;  // Start after '['
-                char* end = strchr(operands[1], ']');       // Find the closing ']'
-                if (end <= start) {
-                    fprintf(stderr, "Error: Invalid memory address format '%s' at line %zu\n", operands[1], line_num);
-                    break;
-                }
-                strncpy(addr_str, start, end - start);  // Copy the address part
-                addr_str[end - start] = '\0';           // Null-terminate the address string
-                inst.src_mem_address = strtoull(addr_str, NULL, 0);  // Use base 0 for automatic base detection
-                inst.src_is_memory = 1;  // Source is memory
-            }
-            else {
-                // Handle immediate value (decimal)
-                inst.immediate = strtoull(operands[1], NULL, 10);
-                inst.src_is_memory = 0;  // Source is an immediate
-            }
-        }
-    }
-    else {
-        fprintf(stderr, "Error: Missing source operand for '%s' at line %zu\n", (type == INST_MIRROR ? "MIRROR" : "ISPRIME"), line_num);
-        break;
-    }
-
-    // Perform the MIRROR or ISPRIME operation
-    if (type == INST_MIRROR) {
-        // Perform the MIRROR operation
-        uint64_t src_value = 0;
-        if (inst.src_reg) {
-            src_value = *inst.src_reg;
-        }
-        else if (inst.src_is_memory) {
-            // Read from memory if source is memory
-            src_value = emu->memory[inst.src_mem_address];
-        }
-        else {
-            src_value = inst.immediate;
-        }
-
-        // Reverse the bits of the value
-        uint64_t mirrored_value = 0;
-        for (int i = 0; i < 64; i++) {
-            mirrored_value |= ((src_value >> i) & 1) << (63 - i);  // Reverse bit by bit
-        }
-
-        // Store the mirrored value
-        if (inst.dest_reg) {
-            *inst.dest_reg = mirrored_value;
-        }
-        else if (inst.dest_is_memory) {
-            // Write to memory if destination is memory
-            emu->memory[inst.dest_mem_address] = mirrored_value;
-        }
-
-        printf("Executed MIRROR Instruction: Mirror of 0x%llX = 0x%llX\n", src_value, mirrored_value);
-    }
-    else if (type == INST_ISPRIME) {
-        // Perform the ISPRIME operation
-        execute_isprime_instruction(emu, &inst);
-    }
-}
-break;
-
-        case INST_JMP:
-        case INST_JE:
-        case INST_JNE:
-        case INST_JG:
-        case INST_JL:
-        case INST_JGE:
-        case INST_JLE:
-        case INST_JA:
-        case INST_JAE:
-        case INST_JB:
-        case INST_JBE:
-        case INST_JO:
-        case INST_JNO:
-        case INST_JS:
-        case INST_JNS:
-        case INST_JP:
-        case INST_JNP:
-        {
-            // Expect one operand: label
-            char* operand = strtok(NULL, " \t,");
-            if (operand) {
-                strcpy(inst.label, operand);
-            }
-            else {
-                fprintf(stderr, "Error: Missing label operand for '%s' at line %zu\n",
-                    (type == INST_JMP ? "JMP" :
-                        type == INST_JE ? "JE" :
-                        type == INST_JNE ? "JNE" :
-                        type == INST_JG ? "JG" :
-                        type == INST_JL ? "JL" :
-                        type == INST_JGE ? "JGE" :
-                        type == INST_JLE ? "JLE" :
-                        type == INST_JA ? "JA" :
-                        type == INST_JAE ? "JAE" :
-                        type == INST_JB ? "JB" :
-                        type == INST_JBE ? "JBE" :
-                        type == INST_JO ? "JO" :
-                        type == INST_JNO ? "JNO" :
-                        type == INST_JS ? "JS" :
-                        type == INST_JNS ? "JNS" :
-                        type == INST_JP ? "JP" :
-                        type == INST_JNP ? "JNP" : "UNKNOWN"), line_num);
-                break;
-            }
-        }
-        break;
-
-        case INST_LABEL:
-            // Labels are handled in the first pass; no action needed here
-            break;
-
-        case INST_NOP:
-            // No operands
-            break;
-
-        case INST_COMMENT:
-            // Comments are ignored in execution
-            break;
-
-        default:
-            fprintf(stderr, "Error: Unsupported instruction '%s' at line %zu\n", token, line_num);
-            break;
-        }
-
-        // Add instruction to the list if it's not a label or comment
-        if (type != INST_LABEL && type != INST_COMMENT) {
-            if (instruction_count >= instruction_capacity) {
-                resize_instructions(&instructions, &instruction_capacity);
-            }
-            instructions[instruction_count++] = inst;
-        }
-    }
-
-    fclose(file);
-
-    // Second pass: execute instructions using rip
-    emu->rip = 0;
-    while (emu->rip < instruction_count) {
-        Instruction* current_inst = &instructions[emu->rip];
-        execute_instruction(emu, current_inst, emu->rip, labels, label_count);
-
-        // Handle jump instructions by updating rip accordingly
-        bool should_jump = false;
-
-        if (current_inst->type == INST_JMP) {
-            should_jump = true;  // Unconditional jump
-        }
-        else if (current_inst->type == INST_JE && emu->flags.zero) {
-            should_jump = true;  // Jump if Zero Flag (ZF) is set
-        }
-        else if (current_inst->type == INST_JNE && !emu->flags.zero) {
-            should_jump = true;  // Jump if Zero Flag (ZF) is NOT set
-        }
-        else if (current_inst->type == INST_JG && !emu->flags.sign && !emu->flags.zero) {
-            should_jump = true;  // Jump if Greater (ZF is clear and SF is clear)
-        }
-        else if (current_inst->type == INST_JGE && !emu->flags.sign) {
-            should_jump = true;  // Jump if Greater or Equal (SF is clear)
-        }
-        else if (current_inst->type == INST_JL && emu->flags.sign != emu->flags.overflow) {
-            should_jump = true;  // Jump if Less (SF != OF)
-        }
-        else if (current_inst->type == INST_JLE && (emu->flags.sign != emu->flags.overflow || emu->flags.zero)) {
-            should_jump = true;  // Jump if Less or Equal (SF != OF or ZF is set)
-        }
-        else if (current_inst->type == INST_JA && !emu->flags.carry && !emu->flags.zero) {
-            should_jump = true;  // Jump if Above (CF and ZF are clear)
-        }
-        else if (current_inst->type == INST_JAE && !emu->flags.carry) {
-            should_jump = true;  // Jump if Above or Equal (CF is clear)
-        }
-        else if (current_inst->type == INST_JB && emu->flags.carry) {
-            should_jump = true;  // Jump if Below (CF is set)
-        }
-        else if (current_inst->type == INST_JBE && (emu->flags.carry || emu->flags.zero)) {
-            should_jump = true;  // Jump if Below or Equal (CF is set or ZF is set)
-        }
-        else if (current_inst->type == INST_JS && emu->flags.sign) {
-            should_jump = true;  // Jump if Signed (SF is set)
-        }
-        else if (current_inst->type == INST_JNS && !emu->flags.sign) {
-            should_jump = true;  // Jump if Not Signed (SF is clear)
-        }
-        else if (current_inst->type == INST_JP && emu->flags.overflow) {
-            should_jump = true;  // Jump if Parity (OF is set)
-        }
-        else if (current_inst->type == INST_JNP && !emu->flags.overflow) {
-            should_jump = true;  // Jump if Not Parity (OF is clear)
-        }
-        if (should_jump) {
-            // Find the label
-            size_t target_index = 0;
-            bool found = false;
-
-            for (size_t i = 0; i < label_count; i++) {
-                if (strcmp(current_inst->label, labels[i].label) == 0) {
-                    target_index = labels[i].index;
-                    found = true;
-                    break;
-                }
-            }
-
-            if (found) {
-                emu->rip = target_index;  // Jump to the target index (label)
-                continue;  // Skip the normal increment of rip and jump
-            }
-            else {
-                fprintf(stderr, "Error: Label '%s' not found for jump instruction at rip=%zu\n", current_inst->label, emu->rip);
-                break;  // Exit if label is not found
-            }
-        }
-
-        // Increment rip only if no jump instruction is executed
-        emu->rip++;  // Increment rip after executing non-jump instructions or if no jump condition met
-    }
-    free(instructions);
-    free(labels);
-}
-
-// Advanced memory operation demonstration
-void demonstrate_memory_operations(Emulator* emu) {
-    // Write to memory
-    uint64_t value = 0xDEADBEEFCAFEBABE;
-    memcpy(emu->memory, &value, sizeof(value));
-    printf("Memory Operation: Written 0x%016" PRIx64 " to memory address 0x0\n", value);
-
-    // Simulate stack operations
-    Instruction stack_instructions[] = {
-        {INST_PUSH, "", &emu->rax, NULL, NULL, 0, HEX},  // Push RAX to stack (Hex)
-        {INST_POP, "", &emu->rbx, NULL, NULL, 0, HEX}    // Pop top of stack to RBX (Hex)
-    };
-
-    size_t stack_instruction_count = sizeof(stack_instructions) / sizeof(Instruction);
-    for (size_t i = 0; i < stack_instruction_count; i++) {
-        execute_instruction(emu, &stack_instructions[i], i + 1, NULL, 0);
-    }
-}
-
-void run_comprehensive_example(Emulator* emu) {
-    // Function implementation
-    // Example:
-    // Define labels for jumps
-    Label labels[10];
-    size_t label_count = 0;
-
-    // Initialize labels (if any)
-    // For this example, we'll manually add labels and map them
-    // In a real scenario, labels would be part of the instruction list
-
-    // Define a list of instructions
-    Instruction instructions[] = {
-        // Data Movement
-        {INST_MOV, "", &emu->rax, NULL, NULL, 0xA, HEX},          // rax = 0xA (10 in hex)
-        {INST_MOV, "", &emu->rbx, NULL, NULL, 0x5, HEX},          // rbx = 0x5
-        {INST_MOV, "", &emu->rcx, NULL, NULL, 0x3, HEX},          // rcx = 0x3
-
-        // Arithmetic
-        {INST_ADD, "", &emu->rax, &emu->rbx, NULL, 0, HEX},       // rax = rax + rbx
-        {INST_SUB, "", &emu->rax, NULL, NULL, 0x2, HEX},          // rax = rax - 0x2
-
-        // Continuing the example program
-        {INST_MUL, "", &emu->rax, &emu->rcx, NULL, 0, HEX},       // rax = rax * rcx
-
-        // Custom Instructions
-
-        // MIRROR Instruction
-        {INST_MIRROR, "", &emu->rdx, &emu->rax, NULL, 0, HEX},    // rdx = mirror of rax
-
-        // MOD Instruction
-        {INST_MOD, "", &emu->rax, NULL, NULL, 0x4, HEX},          // rax = rax % 0x4
-
-        // POW Instruction
-        {INST_POW, "", &emu->rax, NULL, NULL, 0x2, HEX},          // rax = rax ^ 0x2
-
-        // ROOT instruction (cube root of rax)
-        {INST_ROOT, "", &emu->rdx, &emu->rax, &emu->rcx, 0, HEX}, // rdx = cube root of rax
-
-        // AVG instruction
-        {INST_AVG, "", &emu->rcx, &emu->rax, &emu->rbx, 0, HEX},  // rcx = average of rax, rbx, rcx
-
-        // MAX instruction
-        {INST_MAX, "", &emu->rcx, &emu->rax, &emu->rbx, 0, HEX},  // rcx = max of rax, rbx, rcx
-
-        // MIN instruction
-        {INST_MIN, "", &emu->rcx, &emu->rax, &emu->rbx, 0, HEX},  // rcx = min of rax, rbx, rcx
-
-        // ISPRIME Instruction
-        {INST_ISPRIME, "", &emu->rdi, &emu->rax, NULL, 0, HEX},  // rdi = 0 as rax = 0xA (10 in hex)
-
-        // Logical Operations
-        {INST_AND, "", &emu->rax, &emu->rbx, NULL, 0, HEX},      // Bitwise AND
-
-        // Comparison and Conditional Jump
-        {INST_CMP, "", &emu->rbx, &emu->rcx, NULL, 0, HEX},      // Compare rbx and rcx
-        {INST_JE, "END", NULL, NULL, NULL, 0, HEX},               // Jump to END if equal
-        {INST_ADD, "", &emu->rcx, &emu->rbx, NULL, 0, HEX},       // rcx = rcx + rbx
-        {INST_LABEL, "END", NULL, NULL, NULL, 0, HEX},            // Label: END
-        {INST_NOP, "", NULL, NULL, NULL, 0, HEX}                  // NOP
-    };
-
-    size_t instruction_count = sizeof(instructions) / sizeof(Instruction);
-
-    // Add labels to the label list
-    Label label_list[10];
-    size_t label_list_count = 0;
-    for (size_t i = 0; i < instruction_count; i++) {
-        if (instructions[i].type == INST_LABEL) {
-            strcpy(label_list[label_list_count].label, instructions[i].label);
-            label_list[label_list_count].index = i;
-            label_list_count++;
-        }
-    }
-
-    // Execute instructions using rip
-    emu->rip = 0;
-    while (emu->rip < instruction_count) {
-        Instruction* current_inst = &instructions[emu->rip];
-        execute_instruction(emu, current_inst, emu->rip, label_list, label_list_count);
-
-        // Handle jump instructions by updating rip accordingly
-        if (current_inst->type == INST_JMP ||
-            current_inst->type == INST_JE ||
-            current_inst->type == INST_JNE ||
-            current_inst->type == INST_JG ||
-            current_inst->type == INST_JL ||
-            current_inst->type == INST_JGE ||
-            current_inst->type == INST_JLE ||
-            current_inst->type == INST_JA ||
-            current_inst->type == INST_JAE ||
-            current_inst->type == INST_JB ||
-            current_inst->type == INST_JBE ||
-            current_inst->type == INST_JO ||
-            current_inst->type == INST_JNO ||
-            current_inst->type == INST_JS ||
-            current_inst->type == INST_JNS ||
-            current_inst->type == INST_JP ||
-            current_inst->type == INST_JNP) {
-            // Find the label
-            size_t target_index = 0;
-            bool found = false;
-            for (size_t i = 0; i < label_list_count; i++) {
-                if (strcmp(current_inst->label, label_list[i].label) == 0) {
-                    target_index = label_list[i].index;
-                    found = true;
-                    break;
-                }
-            }
-            if (found) {
-                emu->rip = target_index;
-                continue; // Skip the rip increment
-            }
-            else {
-                fprintf(stderr, "Error: Label '%s' not found for jump instruction at rip=%zu\n", current_inst->label, emu->rip);
-                break;
-            }
-        }
-
-        emu->rip++; // Move to the next instruction
-    }
-
-    // Note: Final emulator state will be printed by main function based on mode
-}
-
-// Main function to demonstrate emulator capabilities
-int main(int argc, char* argv[]) {
-
-    // Create emulator with 1MB memory and 64KB stack
-    Emulator* emu = create_emulator(100000*100000, 10000 * 10000);
-
-    // Prepare The INTs
-    initialize_interrupt_handlers();
-
-    // User interaction for tracing and file input
-    char mode;
-    char filename[256] = "";
-
-    printf("Choose mode:\n");
-    printf("T - Trace execution (show states before and after each instruction)\n");
-    printf("R - Run without tracing\n");
-    printf("Enter mode (T/R): ");
-
-    // Check return value of scanf
-    if (scanf(" %c", &mode) != 1) {
-        fprintf(stderr, "Error: Failed to read mode. Defaulting to Run without tracing.\n");
-        tracing_enabled = false;
-    }
-    else {
-        if (mode == 'T' || mode == 't') {
-            tracing_enabled = true;
-        }
-        else if (mode == 'R' || mode == 'r') {
-            tracing_enabled = false;
-        }
-        else {
-            fprintf(stderr, "Invalid mode selected. Defaulting to Run without tracing.\n");
-            tracing_enabled = false;
-        }
-    }
-
-    // Clear input buffer to handle next input correctly
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
-
-    // Check for filename argument
-    if (argc >= 2) {
-        strncpy(filename, argv[1], sizeof(filename) - 1);
-        filename[sizeof(filename) - 1] = '\0';
-    }
-    else {
-        printf("Enter the path to the .asm file (or press Enter to skip): ");
-        if (fgets(filename, sizeof(filename), stdin) != NULL) {
-            // Remove newline character
-            filename[strcspn(filename, "\r\n")] = 0;
-        }
-    }
-
-    // Prevent executing the emulator executable as an instruction file
-    if (strlen(filename) > 0) {
-        // Get the executable's filename
-        const char* exec_name = argv[0];
-        // Extract the basename
-        const char* base_exec = strrchr(exec_name, '\\');
-        if (!base_exec) base_exec = strrchr(exec_name, '/');
-        if (base_exec) base_exec++; else base_exec = exec_name;
-
-        // Extract the basename from the user-provided filename
-        const char* user_base = strrchr(filename, '\\');
-        if (!user_base) user_base = strrchr(filename, '/');
-        if (user_base) user_base++; else user_base = filename;
-
-        // Compare case-insensitively
-        if (strcasecmp(base_exec, user_base) == 0) {
-            fprintf(stderr, "Error: The instruction file cannot be the emulator executable.\n");
-            destroy_emulator(emu);
-            exit(1);
-        }
-    }
-
-    if (strlen(filename) > 0) {
-        printf("\n=== Executing Instructions from File: %s ===\n", filename);
-        execute_file_instructions(emu, filename);
-    }
-    else {
-        printf("\n=== Running Comprehensive Emulator Example ===\n");
-        run_comprehensive_example(emu);
-    }
-
-    // Demonstrate memory and stack operations
-    // Uncomment the following line to demonstrate memory operations
-    // demonstrate_memory_operations(emu);
-
-    // If not tracing, print the final state
-    if (!tracing_enabled) {
-        printf("\n=== Final Emulator State ===\n");
-        print_emulator_state(emu, "Final State");
-    }
-
-    // Clean up
-    destroy_emulator(emu);
-#endif
-    return 0;
-
-}
+#define _CRT_SECURE_NO_WARNINGS
+#define MEMORY_SIZE (1024ull * 1024 * 1024) // Default emulated address space in bytes (--memory-size overrides it)
+#define PAGE_SHIFT 12 // Emulated memory is allocated in pages of 1 << PAGE_SHIFT bytes (4 KiB)
+#define STACK_SIZE (1024 * 1024) // Bytes of emulated memory reserved for the stack (pages are still allocated on use)
+#define TLB_ENTRIES 64 // Direct-mapped software TLB entries caching host pointers of recently used pages (power of two)
+#define INITIAL_CAPACITY 1000 // Initial capacity for instructions and labels
+#define DATA_BASE_ADDRESS 0x400000 // Address of the first data directive (db/dw/dd/dq/times/resb); ORG moves it
+#define LAZY_FLAGS 1 // Decoded engine derives condition flags on demand (0 = compute them eagerly)
+#define TIER_OPTIMIZE_ENTRIES 16 // Default block entries before a block gets specialized and fused handlers
+#define TIER_NATIVE_ENTRIES 64 // Default block entries before a block is compiled to native code
+#define JIT_BUFFER_SIZE (1024 * 1024) // Executable memory reserved per program for JIT-compiled blocks
+#define LOG_COMPILED_LEVEL 3 // Most verbose log level built in (0 = errors, 1 = warnings, 2 = info, 3 = trace)
+#include <ctype.h> // Added to fix 'toupper' undefined
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <windows.h>
+#include <assert.h>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h> // SSE2/AVX2 kernels of the packed vector instructions
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>    // __cpuid for runtime CPU dispatch
+#endif
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdint.h>
+#define MEMORY_H
+
+#ifdef _WIN32
+#include <string.h>
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Enum to represent number formats
+typedef enum {
+    Decimal,
+    HEX
+} NumberFormat;
+
+// Instruction types (expanded)
+typedef enum {
+    // Data Movement
+    INST_MOV,       // Move data
+    INST_PUSH,      // Push to stack
+    INST_POP,       // Pop from stack
+    INST_XCHG,      // Exchange register values
+
+    // Arithmetic
+    INST_ADD,       // Addition
+    INST_SUB,       // Subtraction
+    INST_MUL,       // Multiplication
+    INST_DIV,       // Division
+    INST_INC,       // Increment
+    INST_DEC,       // Decrement
+    INST_NEG,       // Negate
+    INST_CMP,       // Compare
+
+    // Logical
+    INST_AND,       // Bitwise AND
+    INST_OR,        // Bitwise OR
+    INST_XOR,       // Bitwise XOR
+    INST_NOT,       // Bitwise NOT
+
+    // Shift and Rotate
+    INST_SHL,       // Shift Left
+    INST_SHR,       // Shift Right
+    INST_ROL,       // Rotate Left
+    INST_ROR,       // Rotate Right
+
+    // Control Flow
+    INST_JMP,       // Unconditional Jump
+    INST_JE,        // Jump if Equal
+    INST_JNE,       // Jump if Not Equal
+    INST_JG,        // Jump if Greater
+    INST_JGE,       // Jump if Greater or Equal
+    INST_JL,        // Jump if Less
+    INST_JLE,       // Jump if Less or Equal
+    INST_JA,        // Jump if Above (Unsigned Greater)
+    INST_JAE,       // Jump if Above or Equal (Unsigned Greater or Equal)
+    INST_JB,        // Jump if Below (Unsigned Less)
+    INST_JBE,       // Jump if Below or Equal (Unsigned Less or Equal)
+    INST_JO,        // Jump if Overflow
+    INST_JNO,       // Jump if No Overflow
+    INST_JS,        // Jump if Sign (Negative)
+    INST_JNS,       // Jump if No Sign (Non-Negative)
+    INST_JP,        // Jump if Parity Even
+    INST_JNP,       // Jump if No Parity (Parity Odd)
+
+    // Custom Instructions
+    INST_POW,       // Power operation
+    INST_ROOT,      // Root operation
+    INST_AVG,       // Average operation
+    INST_MOD,       // Mod operation
+    INST_MIRROR,    // Mirror operation
+    INST_ISPRIME,   // Check if the num is prime operation
+    INST_MAX,       // Choose the max num of 3 PARAMETERS
+    INST_MIN,       // Choose the min num of 3 parameters
+
+    // Misc
+    INST_LABEL,     // Label for jumps
+    INST_COMMENT,
+    INST_NOP,        // No operation
+    INST_INT,        // INT
+
+    // String (RSI/RDI based, repeatable with REP/REPE/REPNE, direction set by CLD/STD)
+    INST_MOVSB,     // Copy byte [RSI] to [RDI]
+    INST_MOVSQ,     // Copy quadword [RSI] to [RDI]
+    INST_STOSB,     // Store AL to [RDI]
+    INST_STOSQ,     // Store RAX to [RDI]
+    INST_CMPSB,     // Compare byte [RSI] with [RDI]
+    INST_SCASB,     // Compare AL with byte [RDI]
+    INST_CLD,       // Clear direction flag (addresses increase)
+    INST_STD,       // Set direction flag (addresses decrease)
+
+    // Packed vector (XMMn is the low 16 bytes of YMMn; the register named selects the width)
+    INST_MOVDQU,    // Move a vector between registers and memory
+    INST_MOVQ,      // Move the low quadword between a vector and a 64-bit register or memory
+    INST_PADDQ,     // Add packed quadwords
+    INST_PSUBQ,     // Subtract packed quadwords
+    INST_PAND,      // Bitwise AND
+    INST_POR,       // Bitwise OR
+    INST_PXOR,      // Bitwise XOR
+    INST_PCMPEQB,   // Compare packed bytes for equality (all ones where equal)
+    INST_PCMPEQQ,   // Compare packed quadwords for equality
+    INST_PMINUB,    // Minimum of packed unsigned bytes
+    INST_PMAXUB     // Maximum of packed unsigned bytes
+} InstructionType;
+
+// Operand slots of an instruction
+typedef enum {
+    OPERAND_SLOT_DEST,
+    OPERAND_SLOT_SRC,
+    OPERAND_SLOT_AUX
+} OperandSlot;
+
+// Operand forms an instruction slot accepts, and which of them keep their source text in the slot's *_reg_name
+// (for tracing, register widths and data label references)
+#define ACCEPT_REG        0x01  // 32/64-bit general purpose register
+#define ACCEPT_MEM        0x02  // [memory operand]
+#define ACCEPT_IMM        0x04  // 0x hexadecimal or decimal number; a name is kept as a data label reference
+#define ACCEPT_EXACT_IMM  0x08  // Number in C notation (0x, leading 0 octal, decimal) and nothing else
+#define ACCEPT_STRING     0x10  // "string literal" (source only)
+#define KEEP_REG_NAME     0x20
+#define KEEP_MEM_NAME     0x40
+#define KEEP_IMM_NAME     0x80
+
+// Operand rules shared by the entries of the opcode table
+#define RULE_REG_OR_MEM   (ACCEPT_REG | ACCEPT_MEM | KEEP_REG_NAME)
+#define RULE_VALUE        (RULE_REG_OR_MEM | ACCEPT_IMM)
+#define RULE_EXACT_VALUE  (RULE_REG_OR_MEM | ACCEPT_EXACT_IMM)
+#define RULE_ALU_DEST     (RULE_REG_OR_MEM | KEEP_MEM_NAME)
+#define RULE_ALU_SRC      (RULE_VALUE | KEEP_MEM_NAME | KEEP_IMM_NAME)
+
+// How the operands of an instruction are written
+typedef enum {
+    SYNTAX_NONE,        // No operands
+    SYNTAX_OPERANDS,    // Destination, source and third operand, each checked against the rule of its slot
+    SYNTAX_INTERRUPT,   // Interrupt number and optional function number
+    SYNTAX_LABEL,       // Jump target label
+    SYNTAX_VECTOR       // Packed vector operands (parse_vector_operands)
+} OperandSyntax;
+
+// Opcode table: the mnemonic, operand syntax, number of required operands and the operand rules of the
+// destination, source and third slot of every instruction. It drives the mnemonic lookup, the parser and the
+// tracing printer, so a new instruction is added here and in InstructionType.
+//   X(name, syntax, required, dest, src, aux)   for the mnemonic #name and the type INST_name
+#define OPCODE_TABLE(X) \
+    X(MOV,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC | ACCEPT_STRING, 0) \
+    X(PUSH,    OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(POP,     OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(XCHG,    OPERANDS,  2, RULE_REG_OR_MEM, RULE_REG_OR_MEM, 0) \
+    X(ADD,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(SUB,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(MUL,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(DIV,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(INC,     OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(DEC,     OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(NEG,     OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(CMP,     OPERANDS,  2, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(AND,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(OR,      OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(XOR,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(NOT,     OPERANDS,  1, RULE_ALU_DEST, 0, 0) \
+    X(SHL,     OPERANDS,  1, RULE_REG_OR_MEM, ACCEPT_REG | ACCEPT_IMM | KEEP_REG_NAME, 0) \
+    X(SHR,     OPERANDS,  1, RULE_REG_OR_MEM, ACCEPT_REG | ACCEPT_IMM | KEEP_REG_NAME, 0) \
+    X(ROL,     OPERANDS,  1, RULE_REG_OR_MEM, ACCEPT_REG | ACCEPT_IMM | KEEP_REG_NAME, 0) \
+    X(ROR,     OPERANDS,  1, RULE_REG_OR_MEM, ACCEPT_REG | ACCEPT_IMM | KEEP_REG_NAME, 0) \
+    X(JMP,     LABEL,     1, 0, 0, 0) \
+    X(JE,      LABEL,     1, 0, 0, 0) \
+    X(JNE,     LABEL,     1, 0, 0, 0) \
+    X(JG,      LABEL,     1, 0, 0, 0) \
+    X(JGE,     LABEL,     1, 0, 0, 0) \
+    X(JL,      LABEL,     1, 0, 0, 0) \
+    X(JLE,     LABEL,     1, 0, 0, 0) \
+    X(JA,      LABEL,     1, 0, 0, 0) \
+    X(JAE,     LABEL,     1, 0, 0, 0) \
+    X(JB,      LABEL,     1, 0, 0, 0) \
+    X(JBE,     LABEL,     1, 0, 0, 0) \
+    X(JO,      LABEL,     1, 0, 0, 0) \
+    X(JNO,     LABEL,     1, 0, 0, 0) \
+    X(JS,      LABEL,     1, 0, 0, 0) \
+    X(JNS,     LABEL,     1, 0, 0, 0) \
+    X(JP,      LABEL,     1, 0, 0, 0) \
+    X(JNP,     LABEL,     1, 0, 0, 0) \
+    X(POW,     OPERANDS,  2, RULE_REG_OR_MEM, RULE_VALUE, 0) \
+    X(ROOT,    OPERANDS,  3, RULE_REG_OR_MEM, RULE_EXACT_VALUE, RULE_EXACT_VALUE) \
+    X(AVG,     OPERANDS,  3, ACCEPT_REG | KEEP_REG_NAME, RULE_EXACT_VALUE, RULE_EXACT_VALUE) \
+    X(MOD,     OPERANDS,  1, RULE_ALU_DEST, RULE_ALU_SRC, 0) \
+    X(MIRROR,  OPERANDS,  2, RULE_REG_OR_MEM, RULE_VALUE, 0) \
+    X(ISPRIME, OPERANDS,  2, RULE_REG_OR_MEM, RULE_VALUE, 0) \
+    X(MAX,     OPERANDS,  3, ACCEPT_REG | KEEP_REG_NAME, RULE_EXACT_VALUE, RULE_EXACT_VALUE) \
+    X(MIN,     OPERANDS,  3, ACCEPT_REG | KEEP_REG_NAME, RULE_EXACT_VALUE, RULE_EXACT_VALUE) \
+    X(NOP,     NONE,      0, 0, 0, 0) \
+    X(INT,     INTERRUPT, 0, 0, 0, 0) \
+    X(MOVSB,   NONE,      0, 0, 0, 0) \
+    X(MOVSQ,   NONE,      0, 0, 0, 0) \
+    X(STOSB,   NONE,      0, 0, 0, 0) \
+    X(STOSQ,   NONE,      0, 0, 0, 0) \
+    X(CMPSB,   NONE,      0, 0, 0, 0) \
+    X(SCASB,   NONE,      0, 0, 0, 0) \
+    X(CLD,     NONE,      0, 0, 0, 0) \
+    X(STD,     NONE,      0, 0, 0, 0) \
+    X(MOVDQU,  VECTOR,    2, 0, 0, 0) \
+    X(MOVQ,    VECTOR,    2, 0, 0, 0) \
+    X(PADDQ,   VECTOR,    2, 0, 0, 0) \
+    X(PSUBQ,   VECTOR,    2, 0, 0, 0) \
+    X(PAND,    VECTOR,    2, 0, 0, 0) \
+    X(POR,     VECTOR,    2, 0, 0, 0) \
+    X(PXOR,    VECTOR,    2, 0, 0, 0) \
+    X(PCMPEQB, VECTOR,    2, 0, 0, 0) \
+    X(PCMPEQQ, VECTOR,    2, 0, 0, 0) \
+    X(PMINUB,  VECTOR,    2, 0, 0, 0) \
+    X(PMAXUB,  VECTOR,    2, 0, 0, 0)
+
+// Opcode table entry of one instruction type
+typedef struct {
+    const char* mnemonic;    // NULL for types that are not instructions (INST_LABEL, INST_COMMENT)
+    uint8_t syntax;          // OperandSyntax
+    uint8_t required;        // Operands that must be present
+    uint8_t rules[3];        // ACCEPT_*/KEEP_* masks of the destination, source and third slot; 0 if unused
+} OpcodeInfo;
+
+// Execution statistics collected while running a program
+typedef struct {
+    uint64_t instructions_executed;  // Retired emulated instructions
+    uint64_t blocks_executed;        // Basic blocks entered by the decoded engine
+    uint64_t blocks_optimized;       // Basic blocks promoted to specialized and fused handlers
+    uint64_t jit_blocks_compiled;    // Basic blocks promoted to native code
+    uint64_t tlb_hits;               // Memory accesses served by the software TLB fast path
+    uint64_t tlb_misses;             // Memory accesses that walked the page table
+    double execution_seconds;        // Host time spent in the execution loop
+    uint64_t source_lines;           // Lines read by the assembler front end
+    uint64_t source_bytes;           // Bytes of source text read by the assembler front end
+    double parse_seconds;            // Host time spent reading and parsing the source file
+} ExecutionStats;
+
+// Flag-producing operations recorded by the lazy flags engine
+typedef enum {
+    FLAGS_VALID,  // emu->flags is up to date
+    FLAGS_ADD,
+    FLAGS_SUB,    // SUB and CMP
+    FLAGS_MUL,
+    FLAGS_DIV,
+    FLAGS_INC,
+    FLAGS_DEC,    // DEC with a memory destination (sets CF)
+    FLAGS_DEC_REG, // DEC with a register destination (b holds the preserved CF)
+    FLAGS_NEG
+} LazyFlagsOp;
+
+// Last flag-producing operation; ZF/SF/CF/OF/PF are derived from it on demand
+typedef struct {
+    uint64_t a;        // Destination operand before the operation
+    uint64_t b;        // Source operand
+    uint64_t result;   // Result written to the destination
+    uint8_t op;        // LazyFlagsOp
+} LazyFlags;
+
+#define PAGE_SIZE ((uint64_t)1 << PAGE_SHIFT)
+#define PAGE_OFFSET_MASK (PAGE_SIZE - 1)
+
+// Private, copy-on-write file mapping that backs the pages of a loaded memory image
+typedef struct ImageMapping {
+    uint64_t refs;           // Pages still pointing into the mapping; it is unmapped with the last one
+    void* base;
+    size_t length;
+    struct MemoryPage* pages; // Headers of the mapped pages, allocated as one block
+} ImageMapping;
+
+// Host page of emulated memory. An emulator and its snapshots share pages copy-on-write.
+typedef struct MemoryPage {
+    uint64_t refs;           // Page tables (emulator and snapshots) referencing the page
+    uint8_t* data;           // PAGE_SIZE bytes, directly after the header or inside an image mapping
+    ImageMapping* image;     // Mapping the data lives in; NULL for pages allocated by the emulator
+} MemoryPage;
+
+// Sparse emulated memory: a page table whose pages are allocated on first write.
+// Pages that were never written read back as zero, so host memory scales with the pages touched.
+typedef struct {
+    MemoryPage** pages;      // One entry per page of the address space; NULL until first written
+    size_t page_count;       // Entries in pages (address space size / PAGE_SIZE)
+    size_t pages_allocated;  // Pages referenced by this page table
+    size_t* private_pages;   // Pages made private (allocated or copied) since private_base was taken
+    size_t private_count;
+    size_t private_capacity;
+    uint64_t private_base;   // Id of the snapshot last taken or restored (0 = none)
+    uint64_t* dirty_bitmap;  // One bit per page: written or restored since the last checkpoint
+    size_t* dirty_pages;     // The pages whose dirty bit is set, in the order they were marked
+    size_t dirty_count;
+    size_t dirty_capacity;
+} PagedMemory;
+
+// Registers at the last checkpoint, indexed like the register mask of a state diff
+#define STATE_DIFF_RIP 16
+#define STATE_DIFF_RFLAGS 17
+#define STATE_DIFF_REGISTERS 18
+typedef struct {
+    uint64_t registers[STATE_DIFF_REGISTERS];
+} RegisterCheckpoint;
+
+// Software TLB entry: caches the host page of one allocated emulated page.
+// Reads and writes use separate TLBs so that pages shared with a snapshot are only cached for reads.
+typedef struct {
+    uint64_t page_number;    // address >> PAGE_SHIFT of the cached page (TLB_INVALID_PAGE when empty)
+    uintptr_t host_offset;   // Host address of the page minus its emulated address
+} TlbEntry;
+
+#define TLB_INVALID_PAGE UINT64_MAX
+
+// Vector register: YMMn holds 32 bytes, XMMn names its low 16
+typedef union {
+    uint8_t bytes[32];
+    uint64_t qwords[4];
+} VectorRegister;
+
+// Host instruction sets the packed vector kernels can use, in increasing order
+typedef enum {
+    VECTOR_ISA_SCALAR,  // Portable C, one 64-bit or 8-bit lane at a time
+    VECTOR_ISA_SSE2,    // 16 bytes per host instruction
+    VECTOR_ISA_AVX2     // 32 bytes per host instruction
+} VectorIsa;
+
+// Comprehensive Emulator Structure with Multiple Register Sizes
+typedef struct {
+    // General-purpose registers with multiple sizes
+    union {
+        struct {
+            union {
+                uint64_t rax;   // 64-bit
+                struct {
+                    uint32_t eax;   // 32-bit
+                };
+            };
+            union {
+                uint64_t rbx;
+                struct {
+                    uint32_t ebx;
+
+                };
+            };
+            union {
+                uint64_t rcx;
+                struct {
+                    uint32_t ecx;
+
+                };
+            };
+            union {
+                uint64_t rdx;
+                struct {
+                    uint32_t edx;
+
+                };
+            };
+            union {
+                uint64_t rsi;
+                struct {
+                    uint32_t esi;
+
+                };
+            };
+            union {
+                uint64_t rdi;
+                struct {
+                    uint32_t edi;
+
+                };
+            };
+            union {
+                uint64_t rsp;
+                struct {
+                    uint32_t esp;
+
+                };
+            };
+            union {
+                uint64_t rbp;
+                struct {
+                    uint32_t ebp;
+
+                };
+            };
+            // Additional general-purpose registers
+            union {
+                uint64_t r8;
+                struct {
+                    uint32_t r8d;
+
+                };
+            };
+            union {
+                uint64_t r9;
+                struct {
+                    uint32_t r9d;
+
+                };
+            };
+            union {
+                uint64_t r10;
+                struct {
+                    uint32_t r10d;
+
+                };
+            };
+            union {
+                uint64_t r11;
+                struct {
+                    uint32_t r11d;
+
+                };
+            };
+            union {
+                uint64_t r12;
+                struct {
+                    uint32_t r12d;
+
+                };
+            };
+            union {
+                uint64_t r13;
+                struct {
+                    uint32_t r13d;
+
+                };
+            };
+            union {
+                uint64_t r14;
+                struct {
+                    uint32_t r14d;
+
+                };
+            };
+            union {
+                uint64_t r15;
+                struct {
+                    uint32_t r15d;
+
+                };
+            };
+        };
+        uint64_t registers[16];  // Allow indexing by number
+    };
+
+    // Vector registers XMM0-XMM15 / YMM0-YMM15
+    VectorRegister vector[16];
+
+    // Instruction pointer
+    uint64_t rip;
+
+    // Flags register (more comprehensive)
+    struct {
+        uint8_t carry : 1;      // CF: Carry flag
+        uint8_t reserved1 : 1;  // Reserved
+        uint8_t parity : 1;     // PF: Parity flag
+        uint8_t reserved2 : 1;  // Reserved
+        uint8_t auxiliary : 1;  // AF: Auxiliary carry flag
+        uint8_t reserved3 : 1;  // Reserved
+        uint8_t zero : 1;       // ZF: Zero flag
+        uint8_t sign : 1;       // SF: Sign flag
+        uint8_t trap : 1;       // TF: Trap flag
+        uint8_t interrupt : 1;  // IF: Interrupt flag
+        uint8_t direction : 1;  // DF: Direction flag
+        uint8_t overflow : 1;   // OF: Overflow flag
+        uint8_t reserved4 : 4;  // Reserved for future use
+        uint8_t alignment : 1;  // Alignment check flag
+    } flags;
+
+    // Segment registers
+    uint16_t cs, ds, ss, es, fs, gs;
+
+    // Memory representation
+    PagedMemory memory;
+    size_t memory_size;      // Size of the emulated address space in bytes
+    TlbEntry tlb_read[TLB_ENTRIES];   // In-bounds, allocated pages (possibly shared with a snapshot)
+    TlbEntry tlb_write[TLB_ENTRIES];  // In-bounds pages owned by this emulator alone
+
+    // Stack region in emulated memory: RSP may range over [stack_base, stack_base + stack_size]
+    uint64_t stack_base;
+    uint64_t stack_size;
+
+    // Pending flag computation of the decoded engine
+    LazyFlags lazy_flags;
+
+    // Registers at the last checkpoint (checkpoint_emulator)
+    RegisterCheckpoint checkpoint;
+
+    // Execution statistics
+    ExecutionStats stats;
+} Emulator;
+
+// Copy-on-write snapshot of an emulator: its registers and flags plus a page table that shares
+// the emulator's pages. Pages are only copied when the emulator writes them after the snapshot.
+typedef struct {
+    Emulator state;          // Emulator at snapshot time (its memory and statistics are not used)
+    MemoryPage** pages;      // Page table at snapshot time; holds a reference to each page
+    size_t page_count;
+    uint64_t id;             // Lets a restore recognize the page table's current base
+} EmulatorSnapshot;
+
+
+// Register operand: index into emu->registers plus the width its name selects.
+// Operands carry no host pointers, so one parsed program can drive any number of emulators.
+typedef struct {
+    uint8_t index;         // 0 = RAX ... 15 = R15, in emu->registers order
+    uint8_t width;         // 64 or 32 bits; 0 when the operand is not a register
+} RegOperand;
+
+// Register indices in emu->registers order
+typedef enum {
+    REG_RAX, REG_RBX, REG_RCX, REG_RDX, REG_RSI, REG_RDI, REG_RSP, REG_RBP,
+    REG_R8, REG_R9, REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15
+} RegisterIndex;
+
+#define REG_NONE ((RegOperand){ 0, 0 })
+#define REG64(index) ((RegOperand){ (index), 64 })
+#define REG_PRESENT(operand) ((operand).width != 0)
+#define REG_VALUE(emu, operand) ((emu)->registers[(operand).index])
+
+// Shapes of a memory operand's address; the common ones get a dedicated computation
+typedef enum {
+    ADDRESS_ABSOLUTE,        // [disp]
+    ADDRESS_BASE,            // [base]
+    ADDRESS_BASE_DISP,       // [base + disp]
+    ADDRESS_BASE_INDEX8,     // [base + index*8]
+    ADDRESS_GENERAL          // [base + index*scale + disp] with any part left out
+} AddressForm;
+
+// Memory operand [base + index*scale + disp]; base and index are 64-bit registers
+typedef struct {
+    uint8_t form;            // AddressForm
+    uint8_t base;            // Register indices, valid when has_base / has_index is set
+    uint8_t index;
+    uint8_t scale_shift;     // log2 of the index scale (1, 2, 4 or 8)
+    bool has_base;
+    bool has_index;
+    int64_t displacement;
+    char label[32];          // Data label added to the displacement once labels are resolved; empty if none
+} MemoryOperand;
+
+// Instruction structure with NumberFormat
+typedef struct {
+    InstructionType type;
+    char label[32];        // Label name (for INST_LABEL)
+    RegOperand dest_reg;   // Destination register
+    RegOperand src_reg;    // Source register (if applicable)
+    RegOperand aux_reg;    // Auxiliary register (for some operations)
+    uint64_t immediate;    // Immediate value
+    bool dest_is_memory;   // True if destination is memory
+    bool src_is_memory;    // True if source is memory
+    bool jump_is_memory;
+    bool aux_is_memory;
+    uint64_t memory_address;
+    uint64_t target_address;
+    NumberFormat format;   // Number format of the immediate value
+    uint64_t rd;           // Instruction index
+    uint64_t dest_mem_address;
+    uint64_t src_mem_address;
+    uint64_t aux_mem_address;
+    uint64_t jump_mem_address;
+    MemoryOperand dest_address; // Parsed memory operands; *_mem_address holds the address of absolute ones
+    MemoryOperand src_address;
+    MemoryOperand aux_address;
+    uint64_t aux_immediate;
+    uint64_t src_immediate;
+    char dest_reg_name[32]; // Original destination register name
+    char src_reg_name[32];  // Original source register name
+    char aux_reg_name[32];  // Original Aux Register Name
+    uint64_t function;
+    char* immediate_string;
+    bool src_is_string;     // Added: True if source is a string literal
+    char src_string[256];   // Added: Buffer to hold the string literal
+    uint8_t rep_prefix;     // RepPrefix of a string instruction
+    bool dest_is_vector;    // True if the destination is an XMM/YMM register
+    bool src_is_vector;     // True if the source is an XMM/YMM register
+    uint8_t vector_dest;    // Vector register indices
+    uint8_t vector_src;
+    uint8_t vector_bytes;   // Width of a packed instruction: 16 (XMM) or 32 (YMM) bytes
+} Instruction;
+
+// Repeat prefixes of string instructions
+typedef enum {
+    REP_NONE,
+    REP_PLAIN,   // REP: repeat RCX times
+    REP_EQUAL,   // REPE/REPZ: repeat while RCX != 0 and the elements compare equal
+    REP_NOT_EQUAL // REPNE/REPNZ: repeat while RCX != 0 and the elements differ
+} RepPrefix;
+
+// Slice of the source text the assembler works on in place; not NUL-terminated
+typedef struct {
+    const char* data;
+    size_t length;
+} StringView;
+
+#define VIEW_ARGS(view) (int)(view).length, (view).data  // Arguments for a "%.*s" conversion
+
+#define LABEL_NAME_LENGTH 31  // Significant characters of a label name, as many as the label fields of an instruction hold
+
+// Kinds of symbols: code labels name an instruction index, data labels an address
+typedef enum {
+    SYMBOL_CODE,
+    SYMBOL_DATA
+} SymbolKind;
+
+// Symbol defined by a label
+typedef struct {
+    uint32_t name;           // Offset of the interned, NUL-terminated name in the table's string pool
+    uint32_t hash;
+    uint8_t kind;            // SymbolKind
+    size_t value;            // Instruction index of a code label, address of a data label
+    size_t line;             // Source line of the definition
+} Symbol;
+
+// Symbol table: symbols in definition order, an open-addressing index over them (linear probing,
+// a power of two in size and at most half full) and the pool their names are interned in
+typedef struct {
+    Symbol* symbols;
+    size_t count;
+    size_t capacity;
+    uint32_t* slots;         // Symbol number + 1 per slot; 0 when the slot is free
+    size_t slot_count;
+    char* strings;
+    size_t strings_length;
+    size_t strings_capacity;
+} SymbolTable;
+
+// Data label name used as a dw/dd/dq item, patched once the whole file is read
+typedef struct {
+    char label[32];
+    uint64_t address;        // Where the item was assembled (its buffer offset until it is placed)
+    size_t size;             // Item size in bytes
+    size_t line;
+} DataFixup;
+
+// Range of emulated memory written by data directives
+typedef struct {
+    uint64_t address;
+    uint64_t length;
+} DataExtent;
+
+// Data directives assembled into emulated memory while a file is parsed
+typedef struct {
+    uint64_t location;       // Address the next directive assembles to
+    uint64_t bytes;          // Bytes assembled or reserved so far
+    size_t label_count;      // Data labels defined (they live in the symbol table)
+    DataFixup* fixups;
+    size_t fixup_count;
+    size_t fixup_capacity;
+    uint8_t* buffer;         // Items of the directive being assembled
+    size_t buffer_length;
+    size_t buffer_capacity;
+    DataExtent* extents;     // Memory the directives wrote, in order; adjacent writes share an extent
+    size_t extent_count;
+    size_t extent_capacity;
+} DataSection;
+
+// Generic decoded opcodes executed by the threaded interpreter (one handler each).
+// The generic ALU handlers accept any operand form and check 32-bit destinations.
+// The jump opcodes mirror the order of INST_JMP..INST_JNP.
+#define DECODED_OPCODES(X) \
+    X(OP_HALT)  \
+    X(OP_SLOW)  \
+    X(OP_NOP)   \
+    X(OP_VECTOR) \
+    X(OP_PACKED_V) \
+    X(OP_PACKED_X) \
+    X(OP_VLOAD) \
+    X(OP_VSTORE) \
+    X(OP_FALLTHROUGH) \
+    X(OP_MOV)   \
+    X(OP_ADD)   \
+    X(OP_SUB)   \
+    X(OP_MUL)   \
+    X(OP_DIV)   \
+    X(OP_INC)   \
+    X(OP_DEC)   \
+    X(OP_NEG)   \
+    X(OP_CMP)   \
+    X(OP_AND)   \
+    X(OP_OR)    \
+    X(OP_XOR)   \
+    X(OP_NOT)   \
+    X(OP_SHL)   \
+    X(OP_SHR)   \
+    X(OP_ROL)   \
+    X(OP_ROR)   \
+    X(OP_PUSH)  \
+    X(OP_POP)   \
+    X(OP_JMP)   \
+    X(OP_JE)    \
+    X(OP_JNE)   \
+    X(OP_JG)    \
+    X(OP_JGE)   \
+    X(OP_JL)    \
+    X(OP_JLE)   \
+    X(OP_JA)    \
+    X(OP_JAE)   \
+    X(OP_JB)    \
+    X(OP_JBE)   \
+    X(OP_JO)    \
+    X(OP_JNO)   \
+    X(OP_JS)    \
+    X(OP_JNS)   \
+    X(OP_JP)    \
+    X(OP_JNP)
+
+// Binary ops with a specialized handler per operand form (RR, RI, RM, MR, MI, MM, and RX, XR, XI where
+// X is a memory operand with a register-based address).
+// X(name, reads destination, writes destination, result expression, flag update)
+#define BINARY_OPS(X) \
+    X(MOV, 0, 1, b,                          (void)0) \
+    X(ADD, 1, 1, a + b,                      record_flags(emu, FLAGS_ADD, a, b, result)) \
+    X(SUB, 1, 1, a - b,                      record_flags(emu, FLAGS_SUB, a, b, result)) \
+    X(MUL, 1, 1, a * b,                      record_flags(emu, FLAGS_MUL, a, b, result)) \
+    X(DIV, 1, 1, decoded_divide(op, a, b),   record_flags(emu, FLAGS_DIV, a, b, result)) \
+    X(CMP, 1, 0, a - b,                      record_flags(emu, FLAGS_SUB, a, b, result)) \
+    X(AND, 1, 1, a & b,                      (void)0) \
+    X(OR,  1, 1, a | b,                      set_logic_flags(emu, result)) \
+    X(XOR, 1, 1, a ^ b,                      (void)0) \
+    X(SHL, 1, 1, a << (b & 63),              (void)0) \
+    X(SHR, 1, 1, a >> (b & 63),              (void)0) \
+    X(ROL, 1, 1, rotate_left(a, b),          (void)0) \
+    X(ROR, 1, 1, rotate_right(a, b),         (void)0)
+
+// Unary ops with a specialized handler per destination form (R, M, X).
+// X(name, result expression, flag update for a register, flag update for memory)
+#define UNARY_OPS(X) \
+    X(INC, a + 1,                   record_flags(emu, FLAGS_INC, a, 1, result), record_flags(emu, FLAGS_INC, a, 1, result)) \
+    X(DEC, a - 1,                   record_flags(emu, FLAGS_DEC_REG, a, lazy_carry(emu), result), record_flags(emu, FLAGS_DEC, a, 1, result)) \
+    X(NEG, (uint64_t)(-(int64_t)a), record_flags(emu, FLAGS_NEG, a, 0, result), record_flags(emu, FLAGS_NEG, a, 0, result)) \
+    X(NOT, ~a,                      (void)0,                                    (void)0)
+
+// Conditional jumps fused with a preceding CMP or DEC into one superinstruction.
+// X(jump, condition) with the condition written in terms of CMP a, b.
+// FUSED_RESULT_CONDITIONS only read ZF/SF/PF, which DEC reg sets exactly like CMP reg, 1;
+// its CF and OF differ, so DEC is fused with these conditions only.
+#define FUSED_RESULT_CONDITIONS(X) \
+    X(JE,  a == b) \
+    X(JNE, a != b) \
+    X(JS,  ((a - b) >> 63) & 1) \
+    X(JNS, !(((a - b) >> 63) & 1)) \
+    X(JP,  parity_even(a - b)) \
+    X(JNP, !parity_even(a - b))
+
+#define FUSED_OVERFLOW_CONDITIONS(X) \
+    X(JG,  (int64_t)a > (int64_t)b) \
+    X(JGE, (int64_t)a >= (int64_t)b) \
+    X(JL,  (int64_t)a < (int64_t)b) \
+    X(JLE, (int64_t)a <= (int64_t)b) \
+    X(JO,  (((a ^ b) & (a ^ (a - b))) >> 63) & 1) \
+    X(JNO, !((((a ^ b) & (a ^ (a - b))) >> 63) & 1))
+
+#define FUSED_CARRY_CONDITIONS(X) \
+    X(JA,  a > b) \
+    X(JAE, a >= b) \
+    X(JB,  a < b) \
+    X(JBE, a <= b)
+
+typedef enum {
+#define DECODED_OPCODE_ENUM(name) name,
+    DECODED_OPCODES(DECODED_OPCODE_ENUM)
+#undef DECODED_OPCODE_ENUM
+#define BINARY_FORM_ENUM(name, reads, writes, expression, flags) \
+    OP_##name##_RR, OP_##name##_RI, OP_##name##_RM, OP_##name##_MR, OP_##name##_MI, OP_##name##_MM, \
+    OP_##name##_RX, OP_##name##_XR, OP_##name##_XI,
+    BINARY_OPS(BINARY_FORM_ENUM)
+#undef BINARY_FORM_ENUM
+#define UNARY_FORM_ENUM(name, expression, reg_flags, mem_flags) OP_##name##_R, OP_##name##_M, OP_##name##_X,
+    UNARY_OPS(UNARY_FORM_ENUM)
+#undef UNARY_FORM_ENUM
+#define FUSED_CMP_ENUM(jump, condition) OP_CMP_RR_##jump, OP_CMP_RI_##jump,
+#define FUSED_DEC_ENUM(jump, condition) OP_DEC_R_##jump,
+    FUSED_RESULT_CONDITIONS(FUSED_CMP_ENUM)
+    FUSED_OVERFLOW_CONDITIONS(FUSED_CMP_ENUM)
+    FUSED_CARRY_CONDITIONS(FUSED_CMP_ENUM)
+    FUSED_RESULT_CONDITIONS(FUSED_DEC_ENUM)
+#undef FUSED_CMP_ENUM
+#undef FUSED_DEC_ENUM
+    OP_COUNT
+} DecodedOpcode;
+
+typedef char decoded_opcode_count_check[(OP_COUNT <= 256) ? 1 : -1];
+
+// Fused compare-and-branch opcodes occupy the tail of DecodedOpcode
+#define OP_FIRST_FUSED OP_CMP_RR_JE
+
+// Operand kinds of a decoded op
+typedef enum {
+    OPERAND_NONE,
+    OPERAND_REG,
+    OPERAND_IMM,
+    OPERAND_MEM
+} OperandKind;
+
+// Form byte: destination kind, source kind and a narrow (32-bit) destination bit
+#define OP_FORM(dst_kind, src_kind) (uint8_t)(((dst_kind) << 2) | (src_kind))
+#define OP_FORM_NARROW 0x10
+#define OP_FORM_DST_INDIRECT 0x20  // dst_value holds a packed address form instead of an address
+#define OP_FORM_SRC_INDIRECT 0x40  // src_value holds a packed address form instead of an address
+#define OP_DST_KIND(form) (((form) >> 2) & 0x3)
+#define OP_SRC_KIND(form) ((form) & 0x3)
+
+// Packed address form of a register-based memory operand in a decoded op:
+// bits 0-31 signed displacement, 32-34 AddressForm, 35-38 base, 39-42 index, 43-44 scale shift,
+// 45 base present, 46 index present
+#define PACKED_ADDRESS_FORM(packed) (((packed) >> 32) & 0x7)
+#define PACKED_ADDRESS_BASE(packed) (((packed) >> 35) & 0xF)
+#define PACKED_ADDRESS_INDEX(packed) (((packed) >> 39) & 0xF)
+#define PACKED_ADDRESS_SHIFT(packed) (((packed) >> 43) & 0x3)
+#define PACKED_ADDRESS_HAS_BASE(packed) (((packed) >> 45) & 1)
+#define PACKED_ADDRESS_HAS_INDEX(packed) (((packed) >> 46) & 1)
+
+// Compact decoded instruction executed by the threaded interpreter (32 bytes)
+typedef struct {
+    const void* handler;    // Threaded-code handler address
+    uint64_t dst_value;     // Destination memory address or packed address form
+    uint64_t src_value;     // Source immediate, source memory address, packed address form or jump target index
+    uint32_t index;         // Index of the originating Instruction
+    uint8_t opcode;         // DecodedOpcode
+    uint8_t form;           // Operand kinds and width (see OP_FORM)
+    uint8_t dst;            // Destination register index
+    uint8_t src;            // Source register index
+} DecodedOp;
+
+typedef char decoded_op_size_check[(sizeof(DecodedOp) <= 32) ? 1 : -1];
+
+// The JIT backend emits x86-64 code and is only built for x86-64 hosts
+#if defined(__x86_64__) || defined(_M_X64)
+#define JIT_SUPPORTED
+#endif
+
+// Native code of a JIT-compiled block. Runs the block once plus up to *iterations
+// extra trips around a self loop, stores the unused iterations back and returns the next block.
+typedef uint32_t (*JitBlockFunction)(Emulator* emu, uint64_t* iterations);
+
+// Execution tiers of a decoded block; blocks are promoted as their entry count grows
+typedef enum {
+    TIER_BASELINE,  // Generic handlers straight from the decoder
+    TIER_OPTIMIZED, // Operand-form specialized and fused handlers
+    TIER_NATIVE     // JIT-compiled native code
+} BlockTier;
+
+// Basic block of a decoded program: straight-line ops ending in a jump or a fall-through
+typedef struct {
+    uint32_t first_op;      // Index of the block's first op in DecodedProgram.ops
+    uint32_t first;         // Index of the block's first instruction
+    uint32_t count;         // Number of instructions in the block
+    uint32_t taken;         // Successor block when the closing jump is taken
+    uint32_t fallthrough;   // Successor block otherwise
+    uint64_t entries;       // Number of times the block was entered
+    uint64_t promote_at;    // Entry count at which the block moves up a tier (UINT64_MAX = never)
+    uint8_t tier;           // BlockTier
+    JitBlockFunction native; // JIT-compiled code, or NULL while the block is interpreted
+} DecodedBlock;
+
+// Decoded program: ops laid out block by block; the last block is an empty HALT block.
+// It carries per-run tier state, so every emulator decodes its own copy; the parsed
+// instructions it points to are only read and can be shared between emulators.
+typedef struct {
+    DecodedOp* ops;
+    size_t op_count;            // Number of ops including block terminators and OP_HALT
+    DecodedBlock* blocks;
+    size_t block_count;         // Number of blocks including the HALT block
+    bool threaded;              // Handler addresses have been resolved
+    Instruction* instructions;  // Original instructions for the slow path
+    size_t instruction_count;
+    uint8_t* jit_code;          // Executable buffer holding JIT-compiled blocks (NULL until first use)
+    size_t jit_used;            // Bytes of jit_code already filled
+} DecodedProgram;
+
+
+// Global interrupt handler map
+typedef void (*InterruptHandler)(Emulator*, Instruction*);
+InterruptHandler interrupt_handlers[256] = { NULL };
+
+// Global tracing flag
+bool tracing_enabled = false;
+
+// Log levels for emulator messages, from least to most verbose
+typedef enum {
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_TRACE
+} LogLevel;
+
+// Most verbose level printed at run time (--log-level, trace mode raises it to LOG_LEVEL_TRACE)
+LogLevel log_level = LOG_LEVEL_WARN;
+
+// Levels above LOG_COMPILED_LEVEL fold to a constant false and compile out; the rest cost one
+// well-predicted compare against log_level
+#define LOG_AT(level, stream, ...) \
+    do { if ((level) <= LOG_COMPILED_LEVEL && (level) <= log_level) fprintf(stream, __VA_ARGS__); } while (0)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, stderr, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, stdout, __VA_ARGS__)
+#define LOG_TRACE(...) LOG_AT(LOG_LEVEL_TRACE, stdout, __VA_ARGS__)
+
+// Global flag to print execution statistics after the run
+bool stats_enabled = false;
+
+// Global flag to force the reference (non-decoded) instruction loop
+bool reference_engine = false;
+
+// Maximum number of instructions to execute (0 = unlimited)
+uint64_t instruction_limit = 0;
+
+// Size of the emulated address space in bytes (--memory-size); only pages a program writes use host memory
+uint64_t address_space_size = MEMORY_SIZE;
+
+// Number of times to run the program, each from the same initial state (--repeat)
+uint64_t run_count = 1;
+
+// File to write the state diff since the start of the run to (--diff-out); NULL = none
+const char* diff_output_path = NULL;
+
+// Lowest address of the stack region (--stack-base); UINT64_MAX places the stack at the top of the address space
+uint64_t stack_base_address = UINT64_MAX;
+
+// Memory image to map at startup (--load-image FILE[@ADDR]); NULL = none
+const char* image_load_path = NULL;
+uint64_t image_load_address = 0;
+
+// File that memory is dumped to at exit and by INT 24h (--dump-memory); NULL = no dump at exit
+const char* memory_dump_path = NULL;
+// Set once INT 24h has written the dump file; the exit dump then leaves the program's dump in place
+bool memory_dumped_by_program = false;
+
+// Compiled program file to write instead of running the source file (--compile); NULL = run the file
+const char* compile_output_path = NULL;
+
+// Highest host vector instruction set the packed instructions may use (--simd); the host may support less
+VectorIsa vector_isa_limit = VECTOR_ISA_AVX2;
+
+// Global flag to let the decoded engine compile hot blocks to native code (--no-jit clears it)
+#ifdef JIT_SUPPORTED
+bool jit_enabled = true;
+#else
+bool jit_enabled = false;
+#endif
+
+// Block entry counts at which the decoded engine promotes a block to the next tier
+uint64_t optimize_threshold = TIER_OPTIMIZE_ENTRIES;
+uint64_t jit_threshold = TIER_NATIVE_ENTRIES;
+
+// Function prototypes
+Emulator* create_emulator(size_t memory_size, size_t stack_size);
+void init_paged_memory(PagedMemory* memory, size_t memory_size);
+void free_paged_memory(PagedMemory* memory);
+uint8_t* memory_page(Emulator* emu, uint64_t address, bool allocate);
+void tlb_flush(Emulator* emu);
+EmulatorSnapshot* snapshot_emulator(Emulator* emu);
+void restore_emulator(Emulator* emu, const EmulatorSnapshot* snapshot);
+Emulator* fork_emulator(const EmulatorSnapshot* snapshot);
+void free_snapshot(EmulatorSnapshot* snapshot);
+const size_t* list_dirty_pages(const Emulator* emu, size_t* count);
+void clear_dirty_pages(Emulator* emu);
+void checkpoint_emulator(Emulator* emu);
+bool export_state_diff(Emulator* emu, const char* path);
+bool load_memory_image(Emulator* emu, const char* path, uint64_t address);
+bool dump_memory_image(Emulator* emu, const char* path, uint64_t address, uint64_t length);
+void write_memory_block(Emulator* emu, uint64_t address, const uint8_t* data, size_t length);
+void copy_memory_block(Emulator* emu, uint64_t destination, uint64_t source, uint64_t length);
+void fill_memory_block(Emulator* emu, uint64_t address, uint64_t length, uint64_t value, size_t unit);
+uint64_t scan_memory_block(Emulator* emu, uint64_t address, uint64_t count, uint8_t value, bool stop_on_equal, bool backward);
+uint64_t compare_memory_blocks(Emulator* emu, uint64_t first, uint64_t second, uint64_t count, bool stop_on_equal, bool backward);
+uint64_t memory_image_end(const Emulator* emu);
+uint64_t read_memory_slow(Emulator* emu, uint64_t address, size_t size);
+void write_memory_slow(Emulator* emu, uint64_t address, uint64_t value, size_t size);
+void destroy_emulator(Emulator* emu);
+void execute_instruction(Emulator* emu, Instruction* inst, size_t inst_num);
+void print_emulator_state(Emulator* emu, const char* phase);
+void print_reg(const char* name, uint64_t value, NumberFormat format, size_t size);
+const char* get_register_name(RegOperand reg);
+RegOperand get_register_operand(StringView name);
+InstructionType get_instruction_type(StringView mnemonic);
+StringView next_source_token(StringView* rest);
+bool execute_file_instructions(Emulator* emu, const char* filename);
+bool compile_program_file(Emulator* emu, const char* source_path, const char* output_path);
+bool run_compiled_program(Emulator* emu, const char* path);
+bool is_compiled_program_file(const char* path);
+bool parity_even(uint64_t value);
+bool is_jump_instruction(InstructionType type);
+bool jump_condition_met(Emulator* emu, InstructionType type);
+size_t link_program(Instruction* instructions, size_t instruction_count, const SymbolTable* symbols);
+const Symbol* find_symbol(const SymbolTable* table, StringView name);
+bool define_symbol(SymbolTable* table, StringView name, SymbolKind kind, size_t value, size_t line_num);
+const char* symbol_name(const SymbolTable* table, const Symbol* symbol);
+void free_symbol_table(SymbolTable* table);
+void parse_memory_address(StringView text, MemoryOperand* operand, uint64_t* address, size_t line_num);
+bool is_data_directive(StringView token);
+bool add_data_label(SymbolTable* symbols, DataSection* data, StringView name, size_t line_num);
+bool assemble_data_directive(Emulator* emu, DataSection* data, StringView directive, StringView operands, size_t line_num);
+size_t resolve_data_references(Emulator* emu, Instruction* instructions, size_t instruction_count, DataSection* data, const SymbolTable* symbols);
+void free_data_section(DataSection* data);
+void run_instruction_loop(Emulator* emu, Instruction* instructions, size_t instruction_count);
+void print_execution_stats(Emulator* emu);
+double host_time_seconds(void);
+void decode_program(DecodedProgram* program, Instruction* instructions, size_t instruction_count, const SymbolTable* symbols);
+void run_decoded_program(Emulator* emu, DecodedProgram* program);
+void free_decoded_program(DecodedProgram* program);
+#ifdef JIT_SUPPORTED
+void jit_release(DecodedProgram* program);
+#endif
+void materialize_flags(Emulator* emu);
+void run_comprehensive_example(Emulator* emu);
+void resize_instructions(Instruction** instructions, size_t* capacity);
+void demonstrate_memory_operations(Emulator* emu);
+void int_21h_handler(Emulator* emu, Instruction* inst);
+void int_22h_handler(Emulator* emu, Instruction* inst);
+void int_23h_handler(Emulator* emu, Instruction* inst);
+void int_24h_handler(Emulator* emu, Instruction* inst);
+void initialize_interrupt_handlers() {
+    interrupt_handlers[0x21] = int_21h_handler; // Map INT 21h to the MessageBox handler
+    interrupt_handlers[0x22] = int_22h_handler; // Map INT 22h to the WriteConsole handler
+    interrupt_handlers[0x23] = int_23h_handler; // Map INT 23h to the ReadConsole handler
+    interrupt_handlers[0x24] = int_24h_handler; // Map INT 24h to the memory dump handler
+}
+
+void set_stack_region(Emulator* emu, uint64_t base, uint64_t size);
+
+// Custom instruction implementations
+void execute_root_instruction(Emulator* emu, Instruction* inst);
+void execute_avg_instruction(Emulator* emu, Instruction* inst);
+void execute_pow_instruction(Emulator* emu, Instruction* inst);
+void execute_mod_instruction(Emulator* emu, Instruction* inst);
+bool is_prime(uint64_t n);
+void execute_isprime_instruction(Emulator* emu, Instruction* inst);
+uint64_t mirror_decimal(uint64_t decimal_value);
+void execute_mirror_instruction(Emulator* emu, Instruction* inst);
+void execute_min_instruction(Emulator* emu, Instruction* inst);
+void execute_max_instruction(Emulator* emu, Instruction* inst);
+void execute_string_instruction(Emulator* emu, Instruction* inst);
+void execute_vector_instruction(Emulator* emu, const Instruction* inst);
+VectorIsa select_vector_kernels(VectorIsa limit);
+
+// Function to set up an empty address space of memory_size bytes (rounded up to whole pages)
+void init_paged_memory(PagedMemory* memory, size_t memory_size) {
+    memory->page_count = (memory_size + PAGE_OFFSET_MASK) >> PAGE_SHIFT;
+    memory->pages_allocated = 0;
+    memory->pages = calloc(memory->page_count ? memory->page_count : 1, sizeof(MemoryPage*));
+    if (!memory->pages) {
+        fprintf(stderr, "Memory allocation failed for emulator page table\n");
+        exit(1);
+    }
+    memory->private_pages = NULL;
+    memory->private_count = 0;
+    memory->private_capacity = 0;
+    memory->private_base = 0;
+    memory->dirty_bitmap = calloc((memory->page_count + 63) / 64 + 1, sizeof(uint64_t));
+    if (!memory->dirty_bitmap) {
+        fprintf(stderr, "Memory allocation failed for emulator dirty page bitmap\n");
+        exit(1);
+    }
+    memory->dirty_pages = NULL;
+    memory->dirty_count = 0;
+    memory->dirty_capacity = 0;
+}
+
+// Function to map a whole regular file private to this process. A writable view is copy-on-write: writes go
+// to private copies of the pages and never reach the file. sequential hints that the file is read front to back.
+// Returns false if the file cannot be opened or is not a regular file; otherwise *length is its size and *base
+// the view, NULL if the file is empty or cannot be mapped.
+static bool map_file_private(const char* path, bool writable, bool sequential, void** base, size_t* length) {
+    *base = NULL;
+    *length = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size) || (uint64_t)file_size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    }
+    *length = (size_t)file_size.QuadPart;
+    if (*length > 0) {
+        // The view keeps the mapping object alive, so both handles can be closed right away
+        HANDLE mapping = CreateFileMappingA(file, NULL, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            *base = MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat file_info;
+    if (fstat(fd, &file_info) != 0 || !S_ISREG(file_info.st_mode) || (uint64_t)file_info.st_size > SIZE_MAX) {
+        close(fd);
+        return false;
+    }
+    *length = (size_t)file_info.st_size;
+    if (*length > 0) {
+        *base = mmap(NULL, *length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+        if (*base == MAP_FAILED) *base = NULL;
+#ifdef MADV_SEQUENTIAL
+        if (*base && sequential) madvise(*base, *length, MADV_SEQUENTIAL);
+#endif
+    }
+    close(fd);
+#endif
+    (void)sequential;
+    return true;
+}
+
+// Function to unmap a view made by map_file_private
+static void unmap_file(const void* base, size_t length) {
+#ifdef _WIN32
+    (void)length;
+    UnmapViewOfFile(base);
+#else
+    munmap((void*)base, length);
+#endif
+}
+
+// Function to unmap a memory image file mapping
+static void unmap_image(ImageMapping* image) {
+    unmap_file(image->base, image->length);
+    free(image->pages);
+    free(image);
+}
+
+// Function to drop one page table reference to a page, freeing the page with the last one
+static void release_page(MemoryPage* page) {
+    if (page && --page->refs == 0) {
+        if (!page->image) {
+            free(page);
+        }
+        else if (--page->image->refs == 0) {
+            unmap_image(page->image);
+        }
+    }
+}
+
+// Function to release all pages referenced by a page table and the table itself
+void free_paged_memory(PagedMemory* memory) {
+    if (!memory->pages) return;
+    for (size_t i = 0; i < memory->page_count; i++) {
+        release_page(memory->pages[i]);
+    }
+    free(memory->pages);
+    free(memory->private_pages);
+    free(memory->dirty_bitmap);
+    free(memory->dirty_pages);
+    memory->pages = NULL;
+    memory->private_pages = NULL;
+    memory->dirty_bitmap = NULL;
+    memory->dirty_pages = NULL;
+    memory->dirty_count = 0;
+    memory->dirty_capacity = 0;
+    memory->page_count = 0;
+    memory->pages_allocated = 0;
+    memory->private_count = 0;
+    memory->private_capacity = 0;
+}
+
+// Function to drop every cached translation (needed whenever pages are freed, replaced or shared)
+void tlb_flush(Emulator* emu) {
+    for (size_t i = 0; i < TLB_ENTRIES; i++) {
+        emu->tlb_read[i].page_number = TLB_INVALID_PAGE;
+        emu->tlb_read[i].host_offset = 0;
+        emu->tlb_write[i] = emu->tlb_read[i];
+    }
+}
+
+// Function to cache the host page of an allocated, in-bounds address in a TLB
+static inline void tlb_fill(TlbEntry* tlb, uint64_t address, uint8_t* page) {
+    TlbEntry* entry = &tlb[(address >> PAGE_SHIFT) & (TLB_ENTRIES - 1)];
+    entry->page_number = address >> PAGE_SHIFT;
+    entry->host_offset = (uintptr_t)page - (uintptr_t)(address & ~PAGE_OFFSET_MASK);
+}
+
+// Function to record that a page changed since the last checkpoint
+static inline void mark_page_dirty(PagedMemory* memory, size_t index) {
+    uint64_t bit = (uint64_t)1 << (index & 63);
+    if (memory->dirty_bitmap[index >> 6] & bit) return;
+    memory->dirty_bitmap[index >> 6] |= bit;
+    if (memory->dirty_count == memory->dirty_capacity) {
+        memory->dirty_capacity = memory->dirty_capacity ? memory->dirty_capacity * 2 : 64;
+        memory->dirty_pages = realloc(memory->dirty_pages, memory->dirty_capacity * sizeof(size_t));
+        if (!memory->dirty_pages) {
+            fprintf(stderr, "Error: Memory allocation failed for the dirty page list\n");
+            exit(1);
+        }
+    }
+    memory->dirty_pages[memory->dirty_count++] = index;
+}
+
+static void install_private_page(Emulator* emu, size_t index, MemoryPage* page);
+
+// Function to get the host page backing an in-bounds address.
+// For reads (allocate false) a page that was never written is NULL. For writes the page is marked dirty and made
+// private first: a zeroed page is created for a new page, and a page still shared with a snapshot is copied.
+uint8_t* memory_page(Emulator* emu, uint64_t address, bool allocate) {
+    PagedMemory* memory = &emu->memory;
+    size_t index = address >> PAGE_SHIFT;
+    MemoryPage* page = memory->pages[index];
+    if (!allocate) {
+        return page ? page->data : NULL;
+    }
+    mark_page_dirty(memory, index);
+    if (page && page->refs == 1) {
+        return page->data;
+    }
+
+    // The data follows the header in the same allocation
+    MemoryPage* private_page = page ? malloc(sizeof(MemoryPage) + PAGE_SIZE) : calloc(1, sizeof(MemoryPage) + PAGE_SIZE);
+    if (!private_page) {
+        fprintf(stderr, "Error: Memory allocation failed for page at address 0x%" PRIx64 "\n", address & ~PAGE_OFFSET_MASK);
+        exit(1);
+    }
+    private_page->data = (uint8_t*)(private_page + 1);
+    private_page->image = NULL;
+    if (page) {
+        memcpy(private_page->data, page->data, PAGE_SIZE);
+    }
+    install_private_page(emu, index, private_page);
+    return private_page->data;
+}
+
+// Function to replace a page table entry with a page owned only by the emulator. The replaced page loses a
+// reference (it may still be shared with a snapshot) and cached translations of the entry are dropped.
+static void install_private_page(Emulator* emu, size_t index, MemoryPage* page) {
+    PagedMemory* memory = &emu->memory;
+    MemoryPage* replaced = memory->pages[index];
+    if (!replaced) {
+        memory->pages_allocated++;
+    }
+    release_page(replaced);
+    page->refs = 1;
+    memory->pages[index] = page;
+
+    // Remember the page so a restore to the current base only has to revisit pages written since
+    if (memory->private_count == memory->private_capacity) {
+        memory->private_capacity = memory->private_capacity ? memory->private_capacity * 2 : 64;
+        memory->private_pages = realloc(memory->private_pages, memory->private_capacity * sizeof(size_t));
+        if (!memory->private_pages) {
+            fprintf(stderr, "Error: Memory allocation failed for the private page list\n");
+            exit(1);
+        }
+    }
+    memory->private_pages[memory->private_count++] = index;
+
+    // A cached translation would still point at the replaced page
+    TlbEntry* cached = &emu->tlb_read[index & (TLB_ENTRIES - 1)];
+    if (cached->page_number == index) {
+        cached->page_number = TLB_INVALID_PAGE;
+    }
+    cached = &emu->tlb_write[index & (TLB_ENTRIES - 1)];
+    if (cached->page_number == index) {
+        cached->page_number = TLB_INVALID_PAGE;
+    }
+}
+
+// Function to read a 1, 2, 4 or 8 byte little-endian value from memory through the page table
+uint64_t read_memory_slow(Emulator* emu, uint64_t address, size_t size) {
+    // Check if the address is within valid memory bounds
+    if (address >= emu->memory_size || size > emu->memory_size - address) {
+        fprintf(stderr, "Error: Memory access out of bounds at address 0x%llx\n", address);
+        return 0;
+    }
+    if (size != sizeof(uint8_t) && size != sizeof(uint16_t) && size != sizeof(uint32_t) && size != sizeof(uint64_t)) {
+        fprintf(stderr, "Error: Unsupported memory read size %zu\n", size);
+        return 0;
+    }
+
+    // Assemble the value byte by byte; untouched pages contribute zeros
+    uint64_t result = 0;
+    uint8_t* page = memory_page(emu, address, false);
+    emu->stats.tlb_misses++;
+    if (page) {
+        tlb_fill(emu->tlb_read, address, page);
+    }
+    for (size_t i = 0; i < size; i++) {
+        uint64_t byte_address = address + i;
+        if ((byte_address & PAGE_OFFSET_MASK) == 0 && i > 0) {
+            page = memory_page(emu, byte_address, false);  // Access straddles into the next page
+        }
+        if (page) {
+            result |= (uint64_t)page[byte_address & PAGE_OFFSET_MASK] << (8 * i);
+        }
+    }
+    return result;
+}
+
+// Function to write a 1, 2, 4 or 8 byte little-endian value to memory through the page table
+void write_memory_slow(Emulator* emu, uint64_t address, uint64_t value, size_t size) {
+    // Check if the address is within valid memory bounds
+    if (address >= emu->memory_size || size > emu->memory_size - address) {
+        fprintf(stderr, "Error: Memory access out of bounds at address 0x%llx\n", address);
+        return;
+    }
+    if (size != sizeof(uint8_t) && size != sizeof(uint16_t) && size != sizeof(uint32_t) && size != sizeof(uint64_t)) {
+        fprintf(stderr, "Error: Unsupported memory write size %zu\n", size);
+        return;
+    }
+
+    // The page is private once memory_page returns, so it may be cached for writes as well
+    uint8_t* page = memory_page(emu, address, true);
+    emu->stats.tlb_misses++;
+    tlb_fill(emu->tlb_read, address, page);
+    tlb_fill(emu->tlb_write, address, page);
+    for (size_t i = 0; i < size; i++) {
+        uint64_t byte_address = address + i;
+        if ((byte_address & PAGE_OFFSET_MASK) == 0 && i > 0) {
+            page = memory_page(emu, byte_address, true);  // Access straddles into the next page
+        }
+        page[byte_address & PAGE_OFFSET_MASK] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+// Function to read a value from memory. An aligned 1/2/4/8 byte access to a page cached in the TLB
+// cannot straddle a page and was bounds-checked when the entry was filled, so it is a single load;
+// everything else takes read_memory_slow. Hosts are little-endian, like the emulated x86.
+static inline uint64_t read_memory(Emulator* emu, uint64_t address, size_t size) {
+    const TlbEntry* entry = &emu->tlb_read[(address >> PAGE_SHIFT) & (TLB_ENTRIES - 1)];
+    if (entry->page_number == address >> PAGE_SHIFT && (address & (size - 1)) == 0) {
+        const uint8_t* host = (const uint8_t*)(uintptr_t)(address + entry->host_offset);
+        switch (size) {
+            case sizeof(uint8_t):
+                emu->stats.tlb_hits++;
+                return *host;
+            case sizeof(uint16_t): {
+                uint16_t value;
+                memcpy(&value, host, sizeof(value));
+                emu->stats.tlb_hits++;
+                return value;
+            }
+            case sizeof(uint32_t): {
+                uint32_t value;
+                memcpy(&value, host, sizeof(value));
+                emu->stats.tlb_hits++;
+                return value;
+            }
+            case sizeof(uint64_t): {
+                uint64_t value;
+                memcpy(&value, host, sizeof(value));
+                emu->stats.tlb_hits++;
+                return value;
+            }
+        }
+    }
+    return read_memory_slow(emu, address, size);
+}
+
+// Function to write a value to memory. The write TLB only holds private pages, so the fast path
+// never needs to copy a page shared with a snapshot.
+static inline void write_memory(Emulator* emu, uint64_t address, uint64_t value, size_t size) {
+    const TlbEntry* entry = &emu->tlb_write[(address >> PAGE_SHIFT) & (TLB_ENTRIES - 1)];
+    if (entry->page_number == address >> PAGE_SHIFT && (address & (size - 1)) == 0) {
+        uint8_t* host = (uint8_t*)(uintptr_t)(address + entry->host_offset);
+        switch (size) {
+            case sizeof(uint8_t):
+                *host = (uint8_t)value;
+                emu->stats.tlb_hits++;
+                return;
+            case sizeof(uint16_t): {
+                uint16_t narrow = (uint16_t)value;
+                memcpy(host, &narrow, sizeof(narrow));
+                emu->stats.tlb_hits++;
+                return;
+            }
+            case sizeof(uint32_t): {
+                uint32_t narrow = (uint32_t)value;
+                memcpy(host, &narrow, sizeof(narrow));
+                emu->stats.tlb_hits++;
+                return;
+            }
+            case sizeof(uint64_t):
+                memcpy(host, &value, sizeof(value));
+                emu->stats.tlb_hits++;
+                return;
+        }
+    }
+    write_memory_slow(emu, address, value, size);
+}
+
+// Function to compute the address of a memory operand from the current register values
+static inline uint64_t effective_address(const Emulator* emu, const MemoryOperand* operand) {
+    const uint64_t* registers = emu->registers;
+    switch (operand->form) {
+    case ADDRESS_ABSOLUTE:
+        return (uint64_t)operand->displacement;
+    case ADDRESS_BASE:
+        return registers[operand->base];
+    case ADDRESS_BASE_DISP:
+        return registers[operand->base] + (uint64_t)operand->displacement;
+    case ADDRESS_BASE_INDEX8:
+        return registers[operand->base] + (registers[operand->index] << 3);
+    default:
+        return (operand->has_base ? registers[operand->base] : 0) +
+               (operand->has_index ? registers[operand->index] << operand->scale_shift : 0) +
+               (uint64_t)operand->displacement;
+    }
+}
+
+// Function to read length bytes of memory for a vector load. Returns the host bytes in place when they lie in
+// one page cached in the TLB, otherwise copies them into buffer page by page; NULL when out of bounds.
+static inline const uint8_t* read_vector_memory(Emulator* emu, uint64_t address, uint8_t* buffer, size_t length) {
+    const TlbEntry* entry = &emu->tlb_read[(address >> PAGE_SHIFT) & (TLB_ENTRIES - 1)];
+    if (entry->page_number == address >> PAGE_SHIFT && (address & PAGE_OFFSET_MASK) + length <= PAGE_SIZE) {
+        emu->stats.tlb_hits++;
+        return (const uint8_t*)(uintptr_t)(address + entry->host_offset);
+    }
+    if (address >= emu->memory_size || length > emu->memory_size - address) {
+        fprintf(stderr, "Error: Memory access out of bounds at address 0x%" PRIx64 "\n", address);
+        return NULL;
+    }
+    emu->stats.tlb_misses++;
+    for (size_t done = 0; done < length;) {
+        size_t offset = (size_t)((address + done) & PAGE_OFFSET_MASK);
+        size_t chunk = (size_t)PAGE_SIZE - offset;
+        if (chunk > length - done) chunk = length - done;
+        uint8_t* page = memory_page(emu, address + done, false);
+        if (page) {
+            tlb_fill(emu->tlb_read, address + done, page);
+            memcpy(buffer + done, page + offset, chunk);
+        }
+        else {
+            memset(buffer + done, 0, chunk);
+        }
+        done += chunk;
+    }
+    return buffer;
+}
+
+// Function to write length bytes of a vector store, with a single memcpy when the TLB holds the page
+static inline void write_vector_memory(Emulator* emu, uint64_t address, const uint8_t* data, size_t length) {
+    const TlbEntry* entry = &emu->tlb_write[(address >> PAGE_SHIFT) & (TLB_ENTRIES - 1)];
+    if (entry->page_number == address >> PAGE_SHIFT && (address & PAGE_OFFSET_MASK) + length <= PAGE_SIZE) {
+        memcpy((uint8_t*)(uintptr_t)(address + entry->host_offset), data, length);
+        emu->stats.tlb_hits++;
+        return;
+    }
+    if (address >= emu->memory_size || length > emu->memory_size - address) {
+        fprintf(stderr, "Error: Memory access out of bounds at address 0x%" PRIx64 "\n", address);
+        return;
+    }
+    emu->stats.tlb_misses++;
+    for (size_t done = 0; done < length;) {
+        size_t offset = (size_t)((address + done) & PAGE_OFFSET_MASK);
+        size_t chunk = (size_t)PAGE_SIZE - offset;
+        if (chunk > length - done) chunk = length - done;
+        uint8_t* page = memory_page(emu, address + done, true);
+        tlb_fill(emu->tlb_read, address + done, page);
+        tlb_fill(emu->tlb_write, address + done, page);
+        memcpy(page + offset, data + done, chunk);
+        done += chunk;
+    }
+}
+
+// Function to take a copy-on-write snapshot of an emulator. Only the page table is copied; every page
+// becomes shared, so the emulator's next write to each page copies it first.
+EmulatorSnapshot* snapshot_emulator(Emulator* emu) {
+    static uint64_t next_snapshot_id = 0;
+    PagedMemory* memory = &emu->memory;
+
+    EmulatorSnapshot* snapshot = malloc(sizeof(EmulatorSnapshot));
+    MemoryPage** pages = malloc((memory->page_count ? memory->page_count : 1) * sizeof(MemoryPage*));
+    if (!snapshot || !pages) {
+        fprintf(stderr, "Memory allocation failed for emulator snapshot\n");
+        exit(1);
+    }
+    snapshot->state = *emu;
+    snapshot->pages = pages;
+    snapshot->page_count = memory->page_count;
+    snapshot->id = ++next_snapshot_id;
+    memcpy(pages, memory->pages, memory->page_count * sizeof(MemoryPage*));
+    for (size_t i = 0; i < memory->page_count; i++) {
+        if (pages[i]) pages[i]->refs++;
+    }
+
+    // No page is private any more; cached write translations must not bypass the copy
+    memory->private_count = 0;
+    memory->private_base = snapshot->id;
+    tlb_flush(emu);
+    return snapshot;
+}
+
+// Function to point one page table entry back at the snapshot's page
+static void restore_page(PagedMemory* memory, const EmulatorSnapshot* snapshot, size_t index) {
+    MemoryPage* current = memory->pages[index];
+    MemoryPage* saved = snapshot->pages[index];
+    if (current == saved) return;
+    mark_page_dirty(memory, index);
+    if (saved) {
+        saved->refs++;
+        if (!current) memory->pages_allocated++;
+    }
+    else {
+        memory->pages_allocated--;
+    }
+    release_page(current);
+    memory->pages[index] = saved;
+}
+
+// Function to return an emulator to a snapshot's registers, flags and memory. No page data is copied:
+// pages written since the snapshot are dropped and the snapshot's pages are shared again. When the
+// snapshot is the page table's current base, only those written pages are visited.
+// Restored pages count as dirty; the checkpoint and execution statistics are kept.
+void restore_emulator(Emulator* emu, const EmulatorSnapshot* snapshot) {
+    PagedMemory* memory = &emu->memory;
+    if (snapshot->page_count != memory->page_count) {
+        fprintf(stderr, "Error: Snapshot address space does not match the emulator's\n");
+        exit(1);
+    }
+
+    if (memory->private_base == snapshot->id) {
+        for (size_t i = 0; i < memory->private_count; i++) {
+            restore_page(memory, snapshot, memory->private_pages[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < memory->page_count; i++) {
+            restore_page(memory, snapshot, i);
+        }
+    }
+    memory->private_count = 0;
+    memory->private_base = snapshot->id;
+
+    // Copy everything but the memory subsystem, the checkpoint and the statistics back
+    PagedMemory live_memory = emu->memory;
+    RegisterCheckpoint checkpoint = emu->checkpoint;
+    ExecutionStats stats = emu->stats;
+    *emu = snapshot->state;
+    emu->memory = live_memory;
+    emu->checkpoint = checkpoint;
+    emu->stats = stats;
+    tlb_flush(emu);
+}
+
+// Function to list the pages written since the last checkpoint, in first-write order
+const size_t* list_dirty_pages(const Emulator* emu, size_t* count) {
+    *count = emu->memory.dirty_count;
+    return emu->memory.dirty_pages;
+}
+
+// Function to forget the dirty pages. Cached write translations are dropped so the next
+// write to every page goes through memory_page and marks it again.
+void clear_dirty_pages(Emulator* emu) {
+    PagedMemory* memory = &emu->memory;
+    for (size_t i = 0; i < memory->dirty_count; i++) {
+        memory->dirty_bitmap[memory->dirty_pages[i] >> 6] = 0;
+    }
+    memory->dirty_count = 0;
+    for (size_t i = 0; i < TLB_ENTRIES; i++) {
+        emu->tlb_write[i].page_number = TLB_INVALID_PAGE;
+    }
+}
+
+// Function to pack the flags into their RFLAGS bit positions
+static uint64_t packed_flags(Emulator* emu) {
+    materialize_flags(emu);
+    return (uint64_t)emu->flags.carry |
+        (uint64_t)emu->flags.parity << 2 |
+        (uint64_t)emu->flags.auxiliary << 4 |
+        (uint64_t)emu->flags.zero << 6 |
+        (uint64_t)emu->flags.sign << 7 |
+        (uint64_t)emu->flags.trap << 8 |
+        (uint64_t)emu->flags.interrupt << 9 |
+        (uint64_t)emu->flags.direction << 10 |
+        (uint64_t)emu->flags.overflow << 11 |
+        (uint64_t)emu->flags.alignment << 18;
+}
+
+// Function to start a new checkpoint: clears the dirty pages and remembers the registers
+void checkpoint_emulator(Emulator* emu) {
+    clear_dirty_pages(emu);
+    memcpy(emu->checkpoint.registers, emu->registers, sizeof(emu->registers));
+    emu->checkpoint.registers[STATE_DIFF_RIP] = emu->rip;
+    emu->checkpoint.registers[STATE_DIFF_RFLAGS] = packed_flags(emu);
+}
+
+// Function to write the changes since the last checkpoint as a binary diff (all fields little-endian):
+//   "EMUDIFF1"                          8-byte magic and format version
+//   uint32 register mask                bit n set: register n changed (0-15 = RAX..R15, 16 = RIP, 17 = RFLAGS)
+//   uint64 value per set bit            in bit order
+//   uint32 page size, uint64 page count
+//   per dirty page: uint64 address, then page size bytes of contents
+// Returns false if the file cannot be written.
+bool export_state_diff(Emulator* emu, const char* path) {
+    uint64_t current[STATE_DIFF_REGISTERS];
+    memcpy(current, emu->registers, sizeof(emu->registers));
+    current[STATE_DIFF_RIP] = emu->rip;
+    current[STATE_DIFF_RFLAGS] = packed_flags(emu);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open diff file %s\n", path);
+        return false;
+    }
+
+    uint32_t register_mask = 0;
+    for (int i = 0; i < STATE_DIFF_REGISTERS; i++) {
+        if (current[i] != emu->checkpoint.registers[i]) register_mask |= (uint32_t)1 << i;
+    }
+    fwrite("EMUDIFF1", 1, 8, file);
+    fwrite(&register_mask, sizeof(register_mask), 1, file);
+    for (int i = 0; i < STATE_DIFF_REGISTERS; i++) {
+        if (register_mask & ((uint32_t)1 << i)) fwrite(&current[i], sizeof(uint64_t), 1, file);
+    }
+
+    // Pages written back to all zeros after a restore may have no host page; they are exported as zeros
+    static const uint8_t zero_page[PAGE_SIZE];
+    uint32_t page_size = PAGE_SIZE;
+    uint64_t page_count = emu->memory.dirty_count;
+    fwrite(&page_size, sizeof(page_size), 1, file);
+    fwrite(&page_count, sizeof(page_count), 1, file);
+    for (size_t i = 0; i < emu->memory.dirty_count; i++) {
+        uint64_t address = (uint64_t)emu->memory.dirty_pages[i] << PAGE_SHIFT;
+        const uint8_t* page = memory_page(emu, address, false);
+        fwrite(&address, sizeof(address), 1, file);
+        fwrite(page ? page : zero_page, 1, PAGE_SIZE, file);
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write diff file %s\n", path);
+    }
+    return ok;
+}
+
+// Function to map a raw memory image file into the address space at a page-aligned address.
+// The file is mapped private and copy-on-write, so nothing is read or copied up front: its pages become
+// emulator pages pointing into the mapping, the host faults them in on first access, and writes never reach
+// the file. The tail of the last page past the end of the file reads as zero. Returns false on failure.
+bool load_memory_image(Emulator* emu, const char* path, uint64_t address) {
+    if (address & PAGE_OFFSET_MASK) {
+        fprintf(stderr, "Error: Memory image address 0x%" PRIx64 " is not page aligned\n", address);
+        return false;
+    }
+
+    void* base;
+    size_t length;
+    if (!map_file_private(path, true, false, &base, &length)) {
+        fprintf(stderr, "Error: Could not open memory image %s\n", path);
+        return false;
+    }
+    if (length == 0) {
+        return true;  // Nothing to map
+    }
+    if (length > emu->memory_size || address > emu->memory_size - length) {
+        fprintf(stderr, "Error: Memory image %s (%zu bytes) does not fit at address 0x%" PRIx64 "\n", path, length, address);
+        if (base) unmap_file(base, length);
+        return false;
+    }
+    if (!base) {
+        fprintf(stderr, "Error: Could not map memory image %s\n", path);
+        return false;
+    }
+
+    size_t first = address >> PAGE_SHIFT;
+    size_t count = (size_t)((length + PAGE_OFFSET_MASK) >> PAGE_SHIFT);
+    ImageMapping* image = malloc(sizeof(ImageMapping));
+    MemoryPage* pages = malloc(count * sizeof(MemoryPage));
+    if (!image || !pages) {
+        fprintf(stderr, "Error: Memory allocation failed for memory image %s\n", path);
+        exit(1);
+    }
+    image->refs = 0;
+    image->base = base;
+    image->length = (size_t)length;
+    image->pages = pages;
+
+    for (size_t i = 0; i < count; i++) {
+        MemoryPage* page = &pages[i];
+        page->data = (uint8_t*)base + (i << PAGE_SHIFT);
+        page->image = image;
+        image->refs++;
+        mark_page_dirty(&emu->memory, first + i);
+        install_private_page(emu, first + i, page);
+    }
+    return true;
+}
+
+// Function to copy a block of bytes into in-bounds emulated memory page by page (data NULL writes zeros).
+// Zero chunks that fall on never-written pages are skipped, since those pages already read as zero.
+void write_memory_block(Emulator* emu, uint64_t address, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t offset = (size_t)(address & PAGE_OFFSET_MASK);
+        size_t chunk = (size_t)PAGE_SIZE - offset;
+        if (chunk > length) chunk = length;
+        bool zero = true;
+        for (size_t i = 0; data && i < chunk && zero; i++) {
+            zero = data[i] == 0;
+        }
+        if (!zero || memory_page(emu, address, false)) {
+            uint8_t* page = memory_page(emu, address, true);
+            if (data) {
+                memcpy(page + offset, data, chunk);
+            }
+            else {
+                memset(page + offset, 0, chunk);
+            }
+        }
+        address += chunk;
+        length -= chunk;
+        if (data) data += chunk;
+    }
+}
+
+// Function to get the bytes of a page for reading; pages that were never written read from a shared zero page
+static const uint8_t* readable_page(Emulator* emu, uint64_t address) {
+    static const uint8_t zero_page[PAGE_SIZE];
+    const uint8_t* page = memory_page(emu, address, false);
+    return page ? page : zero_page;
+}
+
+// Function to copy length bytes between non-overlapping in-bounds ranges with one memcpy per page piece
+void copy_memory_block(Emulator* emu, uint64_t destination, uint64_t source, uint64_t length) {
+    while (length > 0) {
+        uint64_t chunk = PAGE_SIZE - (destination & PAGE_OFFSET_MASK);
+        uint64_t source_left = PAGE_SIZE - (source & PAGE_OFFSET_MASK);
+        if (chunk > source_left) chunk = source_left;
+        if (chunk > length) chunk = length;
+        const uint8_t* from = memory_page(emu, source, false);
+        if (from || memory_page(emu, destination, false)) {
+            // Make the destination private first: a shared source page stays valid while a snapshot holds it
+            uint8_t* to = memory_page(emu, destination, true);
+            from = readable_page(emu, source);
+            memcpy(to + (destination & PAGE_OFFSET_MASK), from + (source & PAGE_OFFSET_MASK), (size_t)chunk);
+        }
+        destination += chunk;
+        source += chunk;
+        length -= chunk;
+    }
+}
+
+// Function to fill an in-bounds range with a repeated 1 or 8 byte little-endian value (memset for bytes)
+void fill_memory_block(Emulator* emu, uint64_t address, uint64_t length, uint64_t value, size_t unit) {
+    uint64_t pattern_mask = unit == 8 ? UINT64_MAX : 0xFF;
+    uint64_t byte_pattern = (value & 0xFF) * 0x0101010101010101ull;
+    if ((value & pattern_mask) == (byte_pattern & pattern_mask)) {
+        if ((value & 0xFF) == 0) {
+            write_memory_block(emu, address, NULL, (size_t)length);
+            return;
+        }
+        while (length > 0) {
+            uint64_t chunk = PAGE_SIZE - (address & PAGE_OFFSET_MASK);
+            if (chunk > length) chunk = length;
+            memset(memory_page(emu, address, true) + (address & PAGE_OFFSET_MASK), (int)(value & 0xFF), (size_t)chunk);
+            address += chunk;
+            length -= chunk;
+        }
+        return;
+    }
+
+    // Quadword pattern: copy from a page-sized buffer of the value, offset to keep the element phase
+    static uint8_t pattern[PAGE_SIZE + 8];
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = (uint8_t)(value >> (8 * (i & 7)));
+    }
+    uint64_t start = address;
+    while (length > 0) {
+        uint64_t chunk = PAGE_SIZE - (address & PAGE_OFFSET_MASK);
+        if (chunk > length) chunk = length;
+        memcpy(memory_page(emu, address, true) + (address & PAGE_OFFSET_MASK), pattern + ((address - start) & 7), (size_t)chunk);
+        address += chunk;
+        length -= chunk;
+    }
+}
+
+// Function to scan up to count bytes from address, stepping down when backward, for the byte that ends a
+// REPNE SCASB (stop_on_equal: the first byte equal to value) or a REPE SCASB (the first byte that differs).
+// Returns the number of bytes examined including the one that ended the scan, or count if none did.
+uint64_t scan_memory_block(Emulator* emu, uint64_t address, uint64_t count, uint8_t value, bool stop_on_equal, bool backward) {
+    uint64_t examined = 0;
+    while (examined < count) {
+        uint64_t offset = address & PAGE_OFFSET_MASK;
+        uint64_t chunk = backward ? offset + 1 : PAGE_SIZE - offset;
+        if (chunk > count - examined) chunk = count - examined;
+        const uint8_t* page = readable_page(emu, address);
+        if (!backward && stop_on_equal) {
+            const uint8_t* found = memchr(page + offset, value, (size_t)chunk);
+            if (found) return examined + (uint64_t)(found - (page + offset)) + 1;
+        }
+        else {
+            for (uint64_t i = 0; i < chunk; i++) {
+                uint8_t byte = page[backward ? offset - i : offset + i];
+                if ((byte == value) == stop_on_equal) return examined + i + 1;
+            }
+        }
+        examined += chunk;
+        address = backward ? address - chunk : address + chunk;
+    }
+    return count;
+}
+
+// Function to compare up to count bytes of two ranges element by element, stepping down when backward, for the
+// pair that ends a REPNE CMPSB (stop_on_equal: the first equal pair) or a REPE CMPSB (the first differing pair).
+// Returns the number of pairs examined including the one that ended the comparison, or count if none did.
+uint64_t compare_memory_blocks(Emulator* emu, uint64_t first, uint64_t second, uint64_t count, bool stop_on_equal, bool backward) {
+    uint64_t examined = 0;
+    while (examined < count) {
+        uint64_t first_offset = first & PAGE_OFFSET_MASK;
+        uint64_t second_offset = second & PAGE_OFFSET_MASK;
+        uint64_t chunk = backward ? first_offset + 1 : PAGE_SIZE - first_offset;
+        uint64_t second_left = backward ? second_offset + 1 : PAGE_SIZE - second_offset;
+        if (chunk > second_left) chunk = second_left;
+        if (chunk > count - examined) chunk = count - examined;
+        const uint8_t* a = readable_page(emu, first);
+        const uint8_t* b = readable_page(emu, second);
+        if (backward || stop_on_equal || memcmp(a + first_offset, b + second_offset, (size_t)chunk) != 0) {
+            for (uint64_t i = 0; i < chunk; i++) {
+                bool equal = backward ? a[first_offset - i] == b[second_offset - i] : a[first_offset + i] == b[second_offset + i];
+                if (equal == stop_on_equal) return examined + i + 1;
+            }
+        }
+        examined += chunk;
+        first = backward ? first - chunk : first + chunk;
+        second = backward ? second - chunk : second + chunk;
+    }
+    return count;
+}
+
+// Function to get the end of the highest page a program has written outside the stack region (0 if none).
+// The stack sits at the top of the address space by default, so counting its pages would stretch an image
+// of a few data pages to the whole address space.
+uint64_t memory_image_end(const Emulator* emu) {
+    // Pages lying entirely inside [stack_base, stack_base + stack_size)
+    size_t stack_first = (size_t)((emu->stack_base + PAGE_OFFSET_MASK) >> PAGE_SHIFT);
+    size_t stack_end = (size_t)((emu->stack_base + emu->stack_size) >> PAGE_SHIFT);
+    for (size_t i = emu->memory.page_count; i > 0; i--) {
+        if (i - 1 >= stack_first && i - 1 < stack_end) continue;
+        if (emu->memory.pages[i - 1]) return (uint64_t)i << PAGE_SHIFT;
+    }
+    return 0;
+}
+
+// Function to write a range of emulated memory to a raw image file that load_memory_image can map back.
+// Pages that were never written are skipped with a seek, so the file is sparse where the file system allows.
+// Returns false if the range is out of bounds or the file cannot be written.
+bool dump_memory_image(Emulator* emu, const char* path, uint64_t address, uint64_t length) {
+    if (address > emu->memory_size || length > emu->memory_size - address) {
+        fprintf(stderr, "Error: Memory dump range 0x%" PRIx64 "+0x%" PRIx64 " is out of bounds\n", address, length);
+        return false;
+    }
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open memory dump file %s\n", path);
+        return false;
+    }
+
+    uint64_t end = address + length;
+    bool ends_in_hole = false;
+    while (address < end) {
+        uint64_t offset = address & PAGE_OFFSET_MASK;
+        uint64_t chunk = PAGE_SIZE - offset;
+        if (chunk > end - address) chunk = end - address;
+        const uint8_t* page = memory_page(emu, address, false);
+        if (page) {
+            fwrite(page + offset, 1, (size_t)chunk, file);
+        }
+        else {
+            fseek(file, (long)chunk, SEEK_CUR);
+        }
+        ends_in_hole = !page;
+        address += chunk;
+    }
+    if (ends_in_hole) {
+        // A seek alone does not extend the file; write its last byte
+        fseek(file, -1, SEEK_CUR);
+        fputc(0, file);
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write memory dump file %s\n", path);
+    }
+    return ok;
+}
+
+// Function to create a new emulator that starts from a snapshot and shares its pages copy-on-write
+Emulator* fork_emulator(const EmulatorSnapshot* snapshot) {
+    Emulator* emu = malloc(sizeof(Emulator));
+    if (!emu) {
+        fprintf(stderr, "Memory allocation failed for emulator\n");
+        exit(1);
+    }
+    init_paged_memory(&emu->memory, snapshot->page_count << PAGE_SHIFT);
+    emu->checkpoint = snapshot->state.checkpoint;
+    memset(&emu->stats, 0, sizeof(emu->stats));
+    restore_emulator(emu, snapshot);
+    return emu;
+}
+
+// Function to release a snapshot and its page references
+void free_snapshot(EmulatorSnapshot* snapshot) {
+    if (!snapshot) return;
+    for (size_t i = 0; i < snapshot->page_count; i++) {
+        release_page(snapshot->pages[i]);
+    }
+    free(snapshot->pages);
+    free(snapshot);
+}
+
+// Create a new emulator instance
+Emulator* create_emulator(size_t memory_size, size_t stack_size) {
+    Emulator* emu = malloc(sizeof(Emulator));
+    if (!emu) {
+        fprintf(stderr, "Memory allocation failed for emulator\n");
+        exit(1);
+    }
+
+    // Zero out all registers
+    memset(emu->registers, 0, sizeof(emu->registers));
+
+    // Initialize flags
+    memset(&emu->flags, 0, sizeof(emu->flags));
+    memset(&emu->lazy_flags, 0, sizeof(emu->lazy_flags));
+
+    // Initialize segment registers
+    emu->cs = emu->ds = emu->ss = emu->es = emu->fs = emu->gs = 0;
+
+    // Set up the address space; pages are allocated when first written
+    init_paged_memory(&emu->memory, memory_size);
+    emu->memory_size = emu->memory.page_count << PAGE_SHIFT;
+    tlb_flush(emu);
+
+    // Place the stack at the top of the address space (RSP starts at the top of the stack)
+    if (stack_size > emu->memory_size) {
+        stack_size = emu->memory_size;
+    }
+    set_stack_region(emu, emu->memory_size - stack_size, stack_size);
+
+    // Initialize instruction pointer
+    emu->rip = 0;
+
+    // Reset execution statistics and start with an empty checkpoint
+    memset(&emu->stats, 0, sizeof(emu->stats));
+    memset(&emu->checkpoint, 0, sizeof(emu->checkpoint));
+
+    return emu;
+}
+
+
+
+void initialize_emulator(Emulator* emu, size_t memory_size, size_t stack_size) {
+    // Set up main memory (reads as zero until written)
+    init_paged_memory(&emu->memory, memory_size);
+    emu->memory_size = emu->memory.page_count << PAGE_SHIFT;
+    tlb_flush(emu);
+
+    // Reserve the top of the address space for the stack and point RSP at its top
+    if (stack_size > emu->memory_size) {
+        stack_size = emu->memory_size;
+    }
+    set_stack_region(emu, emu->memory_size - stack_size, stack_size);
+
+    LOG_INFO("Emulator initialized with %zu bytes of memory and %zu bytes of stack.\n", memory_size, stack_size);
+}
+
+
+// Function to place the stack at [base, base + size) in emulated memory and reset RSP to its top
+void set_stack_region(Emulator* emu, uint64_t base, uint64_t size) {
+    size &= ~(uint64_t)(sizeof(uint64_t) - 1);  // Whole stack slots only
+    if (size < sizeof(uint64_t) || base > emu->memory_size || size > emu->memory_size - base) {
+        fprintf(stderr, "Error: Stack region 0x%" PRIx64 "-0x%" PRIx64 " does not fit in the 0x%zx byte address space\n",
+            base, base + size, emu->memory_size);
+        exit(1);
+    }
+    emu->stack_base = base;
+    emu->stack_size = size;
+    emu->rsp = base + size;
+}
+
+// Function to push a 64-bit value onto the stack. One unsigned compare rejects both a full stack
+// and an RSP the program moved outside the stack region.
+static inline void push(Emulator* emu, uint64_t value) {
+    if (emu->rsp - emu->stack_base - sizeof(uint64_t) > emu->stack_size - sizeof(uint64_t)) {
+        fprintf(stderr, "Stack overflow!\n");
+        exit(1);
+    }
+    emu->rsp -= sizeof(uint64_t); // Decrement stack pointer
+    write_memory(emu, emu->rsp, value, sizeof(uint64_t)); // Write to stack
+}
+
+// Function to pop a 64-bit value from the stack, with the same single bounds check as push
+static inline uint64_t pop(Emulator* emu) {
+    if (emu->rsp - emu->stack_base > emu->stack_size - sizeof(uint64_t)) {
+        fprintf(stderr, "Stack underflow!\n");
+        exit(1);
+    }
+    uint64_t value = read_memory(emu, emu->rsp, sizeof(uint64_t)); // Read from stack
+    emu->rsp += sizeof(uint64_t); // Increment stack pointer
+    return value;
+}
+
+
+// Function to resize the instruction array
+void resize_instructions(Instruction** instructions, size_t* capacity) {
+    *capacity *= 2;
+    *instructions = realloc(*instructions, *capacity * sizeof(Instruction));
+    if (*instructions == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed for instructions\n");
+        exit(1);
+    }
+}
+
+void int_21h_handler(Emulator* emu, Instruction* inst) {
+    if (inst->immediate == 0x09) { // Display a message
+        // Read the value from memory starting at the address in RAX
+        uint64_t message_address = emu->rax;
+        if (message_address >= emu->memory_size) { // Check bounds
+            fprintf(stderr, "Error: Message address out of bounds\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Read the ASCII string from memory
+        char message[256]; // Buffer to hold the message
+        size_t i = 0;
+        while (i < sizeof(message) - 1) {
+            uint8_t byte = read_memory(emu, message_address + i, sizeof(uint8_t));
+            message[i++] = byte;
+            if (byte == '\0') break; // Stop at null terminator
+        }
+        message[i] = '\0'; // Ensure null-termination
+
+        // Display the message in a message box
+        MessageBoxA(NULL, message, "Message from Emulator", MB_OK);
+    }
+}
+void int_22h_handler(Emulator* emu, Instruction* inst) {
+    if (inst->immediate == 0x01) { // Write a text value to the console
+        // Read the value from memory starting at the address in RAX
+        uint64_t value_address = emu->rax;
+        if (value_address >= emu->memory_size) { // Check bounds
+            fprintf(stderr, "Error: Value address out of bounds\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Read the ASCII string from memory
+        char message[256]; // Buffer to hold the message
+        size_t i = 0;
+        while (i < sizeof(message) - 1) {
+            uint8_t byte = read_memory(emu, value_address + i, sizeof(uint8_t));
+            if (byte == '\0') break; // Stop at null terminator
+            message[i++] = byte;
+        }
+        message[i] = '\0'; // Null-terminate the string
+
+        // Write the ASCII string to the console
+        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD bytesWritten;
+        WriteConsole(hConsole, message, strlen(message), &bytesWritten, NULL);
+    }
+}
+void int_23h_handler(Emulator* emu, Instruction* inst) {
+    if (inst->immediate == 0x01) { // Read from console
+        char buffer[256];
+        // Read input from the console
+        printf("Enter Input: ");  // Added space here
+        HANDLE hConsole = GetStdHandle(STD_INPUT_HANDLE);
+        DWORD bytesRead;
+        ReadConsole(hConsole, buffer, 255, &bytesRead, NULL);
+        buffer[bytesRead] = '\0'; // Null-terminate the string
+
+        // Debug log: Print the input string
+        LOG_INFO("INT 23h: Read input value: '0x%llX' \n", buffer);  // Added newline here
+
+        // Write the input string to memory starting at the address in RAX
+        uint64_t value_address = emu->rax;
+
+        // Debug log: Print the memory address
+        LOG_INFO("INT 23h: Writing to memory address: 0x%llX\n", value_address);  // Added newline here
+
+        // Check if the memory address is valid
+        if (value_address >= emu->memory_size) {
+            fprintf(stderr, "Error: Memory address 0x%llX is out of bounds\n", value_address);
+            exit(EXIT_FAILURE);
+        }
+
+        // Check if the input string fits in memory
+        if (value_address + bytesRead > emu->memory_size) {
+            fprintf(stderr, "Error: Input string too large for memory\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Write each character to memory
+        for (size_t i = 0; i < bytesRead; ++i) {
+            write_memory(emu, value_address + i, buffer[i], sizeof(uint8_t));
+        }
+
+        // Null-terminate the string in memory
+        write_memory(emu, value_address + bytesRead, '\0', sizeof(uint8_t));
+
+        // Debug log: Confirm the write operation
+       LOG_INFO("INT 23h: Wrote value 0x%llX to memory address 0x%llX\n", buffer, value_address);  // Added newline here
+    }
+}
+
+void int_24h_handler(Emulator* emu, Instruction* inst) {
+    if (inst->immediate == 0x01) { // Dump memory to the dump file
+        // RAX holds the start address and RBX the number of bytes
+        if (!memory_dump_path) {
+            fprintf(stderr, "Error: INT 24h function 01h needs a dump file; run with --dump-memory FILE\n");
+            exit(EXIT_FAILURE);
+        }
+        if (!dump_memory_image(emu, memory_dump_path, emu->rax, emu->rbx)) {
+            exit(EXIT_FAILURE);
+        }
+        memory_dumped_by_program = true;
+        LOG_INFO("INT 24h: Dumped 0x%llX bytes from 0x%llX to %s\n", emu->rbx, emu->rax, memory_dump_path);
+    }
+}
+
+// Free emulator resources
+void destroy_emulator(Emulator* emu) {
+    if (emu) {
+        free_paged_memory(&emu->memory);
+        free(emu);
+    }
+}
+
+// Function to make a view of a NUL-terminated string
+static inline StringView view_of(const char* text) {
+    StringView view = { text, strlen(text) };
+    return view;
+}
+
+// Function to convert an ASCII letter to upper case without a locale lookup
+static inline char ascii_upper(char c) {
+    return c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : c;
+}
+
+// Function to compare a view with a NUL-terminated string, ignoring case
+static bool view_equals_nocase(StringView view, const char* text) {
+    for (size_t i = 0; i < view.length; i++) {
+        if (text[i] == '\0' || ascii_upper(view.data[i]) != ascii_upper(text[i])) return false;
+    }
+    return text[view.length] == '\0';
+}
+
+// Function to copy a view into a fixed-size name field, truncating it to fit
+static void copy_view(char* buffer, size_t size, StringView view) {
+    size_t length = view.length < size ? view.length : size - 1;
+    memcpy(buffer, view.data, length);
+    buffer[length] = '\0';
+}
+
+// Function to parse an integer at the start of a view the way strtoull does: an optional sign, then digits in
+// the given base (16 accepts a 0x prefix; 0 picks 0x hexadecimal, 0 octal or decimal). A negative number wraps
+// around. Returns the number of characters used, 0 if there are no digits.
+static size_t parse_view_integer(StringView text, int base, uint64_t* value) {
+    size_t i = 0;
+    bool negative = false;
+    *value = 0;
+    if (i < text.length && (text.data[i] == '+' || text.data[i] == '-')) {
+        negative = text.data[i++] == '-';
+    }
+    if ((base == 0 || base == 16) && i + 2 < text.length && text.data[i] == '0' &&
+        (text.data[i + 1] == 'x' || text.data[i + 1] == 'X') && isxdigit((unsigned char)text.data[i + 2])) {
+        i += 2;
+        base = 16;
+    }
+    else if (base == 0) {
+        base = i < text.length && text.data[i] == '0' ? 8 : 10;
+    }
+    size_t first = i;
+    uint64_t result = 0;
+    for (; i < text.length; i++) {
+        int c = toupper((unsigned char)text.data[i]);
+        int digit = isdigit(c) ? c - '0' : isupper(c) ? c - 'A' + 10 : base;
+        if (digit >= base) break;
+        result = result * (uint64_t)base + (uint64_t)digit;
+    }
+    if (i == first) return 0;
+    *value = negative ? (uint64_t)0 - result : result;
+    return i;
+}
+
+// Function to take the next token of a source line and advance *rest past it. Tokens are separated by blanks
+// and commas; a bracketed memory operand or a quoted string is one token even when it holds blanks or commas,
+// and ';' starts a comment. Returns an empty view at the end of the line.
+StringView next_source_token(StringView* rest) {
+    const char* c = rest->data;
+    const char* end = rest->data + rest->length;
+    while (c < end && (*c == ' ' || *c == '\t' || *c == ',')) c++;
+    StringView token = { c, 0 };
+    while (c < end && *c != ' ' && *c != '\t' && *c != ',' && *c != ';') {
+        if (*c == '[' || *c == '"') {
+            const char* close = memchr(c + 1, *c == '[' ? ']' : '"', (size_t)(end - c - 1));
+            c = close ? close : end - 1;
+        }
+        c++;
+    }
+    token.length = (size_t)(c - token.data);
+    if (c < end && *c == ';') c = end;
+    rest->data = c;
+    rest->length = (size_t)(end - c);
+    return token;
+}
+
+// Register names in emu->registers order, by width: [0] 64-bit, [1] 32-bit
+static const char* const register_names[2][16] = {
+    { "RAX", "RBX", "RCX", "RDX", "RSI", "RDI", "RSP", "RBP",
+      "R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15" },
+    { "EAX", "EBX", "ECX", "EDX", "ESI", "EDI", "ESP", "EBP",
+      "R8D", "R9D", "R10D", "R11D", "R12D", "R13D", "R14D", "R15D" }
+};
+
+// Function to get the name of a register operand
+const char* get_register_name(RegOperand reg) {
+    if (!REG_PRESENT(reg) || reg.index >= 16) return "UNKNOWN";
+    return register_names[reg.width == 32][reg.index];
+}
+
+// Function to build a register operand, or REG_NONE for an index that is out of range
+static inline RegOperand make_register_operand(unsigned index, uint8_t width) {
+    RegOperand reg = REG_NONE;
+    if (index < 16) {
+        reg.index = (uint8_t)index;
+        reg.width = width;
+    }
+    return reg;
+}
+
+// Function to get a register operand (index and width) from its name (case-insensitive).
+// Decodes by length and characters instead of comparing against every name:
+//   R8 R9 | RAX..RBP EAX..EBP R10..R15 R8D R9D | R10D..R15D
+RegOperand get_register_operand(StringView name) {
+    const char* c = name.data;
+    switch (name.length) {
+    case 2:
+        // R8, R9
+        if (ascii_upper(c[0]) == 'R' && (c[1] == '8' || c[1] == '9')) return make_register_operand(REG_R8 + (unsigned)(c[1] - '8'), 64);
+        break;
+    case 3: {
+        char prefix = ascii_upper(c[0]);
+        if (prefix != 'R' && prefix != 'E') break;
+        char second = ascii_upper(c[1]);
+        char third = ascii_upper(c[2]);
+        if (prefix == 'R' && second == '1' && third >= '0' && third <= '5') return make_register_operand(REG_R10 + (unsigned)(third - '0'), 64);
+        if (prefix == 'R' && (second == '8' || second == '9') && third == 'D') return make_register_operand(REG_R8 + (unsigned)(second - '8'), 32);
+        uint8_t width = prefix == 'R' ? 64 : 32;
+        switch (((unsigned)second << 8) | (unsigned)third) {
+        case ('A' << 8) | 'X': return make_register_operand(REG_RAX, width);
+        case ('B' << 8) | 'X': return make_register_operand(REG_RBX, width);
+        case ('C' << 8) | 'X': return make_register_operand(REG_RCX, width);
+        case ('D' << 8) | 'X': return make_register_operand(REG_RDX, width);
+        case ('S' << 8) | 'I': return make_register_operand(REG_RSI, width);
+        case ('D' << 8) | 'I': return make_register_operand(REG_RDI, width);
+        case ('S' << 8) | 'P': return make_register_operand(REG_RSP, width);
+        case ('B' << 8) | 'P': return make_register_operand(REG_RBP, width);
+        default: break;
+        }
+        break;
+    }
+    case 4:
+        // R10D..R15D
+        if (ascii_upper(c[0]) == 'R' && c[1] == '1' && c[2] >= '0' && c[2] <= '5' && ascii_upper(c[3]) == 'D') {
+            return make_register_operand(REG_R10 + (unsigned)(c[2] - '0'), 32);
+        }
+        break;
+    default:
+        break;
+    }
+    return REG_NONE;
+}
+
+// Function to get the index of a vector register (XMM0-XMM15 or YMM0-YMM15) and its width in bytes; -1 if none
+int get_vector_register(StringView name, uint8_t* bytes) {
+    if (name.length < 4 || name.length > 5 || toupper((unsigned char)name.data[1]) != 'M' || toupper((unsigned char)name.data[2]) != 'M') return -1;
+    char kind = (char)toupper((unsigned char)name.data[0]);
+    if (kind != 'X' && kind != 'Y') return -1;
+    unsigned index = 0;
+    for (size_t i = 3; i < name.length; i++) {
+        if (!isdigit((unsigned char)name.data[i])) return -1;
+        index = index * 10 + (unsigned)(name.data[i] - '0');
+    }
+    if (index >= 16) return -1;
+    *bytes = kind == 'Y' ? 32 : 16;
+    return (int)index;
+}
+
+// Opcode table indexed by instruction type
+static const OpcodeInfo opcode_table[] = {
+#define OPCODE_INFO(name, syntax, required, dest, src, aux) [INST_##name] = { #name, SYNTAX_##syntax, required, { dest, src, aux } },
+    OPCODE_TABLE(OPCODE_INFO)
+#undef OPCODE_INFO
+};
+
+#define MNEMONIC_HASH_BITS 9   // Slots of the mnemonic perfect hash: a power of two at least four times the mnemonic count, so a seed is found in a few tries
+typedef char mnemonic_hash_size_check[((1u << MNEMONIC_HASH_BITS) >= 4 * sizeof(opcode_table) / sizeof(opcode_table[0])) ? 1 : -1];
+
+// Mnemonic perfect hash: every mnemonic of the opcode table has a slot of its own, so a lookup is one
+// multiply and one key compare. Keys are the upper-cased mnemonic packed into an integer; 0 marks a free slot.
+// The table is not fixed at build time: build_mnemonic_hash searches the multiplier and fills the slots at run
+// time, once, on the first lookup.
+static struct {
+    uint64_t key;
+    uint8_t type;            // InstructionType
+} mnemonic_slots[1 << MNEMONIC_HASH_BITS];
+static uint64_t mnemonic_seed;  // Multiplier that spreads the keys without collisions; 0 until the hash is built
+
+// Function to pack a mnemonic of up to 8 characters, upper-cased, into a hash key; 0 if it cannot be one
+static inline uint64_t mnemonic_key(StringView name) {
+    if (name.length == 0 || name.length > 8) return 0;
+    uint64_t key = 0;
+    for (size_t i = 0; i < name.length; i++) {
+        key |= (uint64_t)(uint8_t)ascii_upper(name.data[i]) << (8 * i);
+    }
+    return key;
+}
+
+// Function to get the slot of a key for a multiplier
+static inline size_t mnemonic_slot(uint64_t key, uint64_t seed) {
+    return (size_t)((key * seed) >> (64 - MNEMONIC_HASH_BITS));
+}
+
+// Function to build the mnemonic perfect hash from the opcode table at run time: tries odd multipliers until no two mnemonics share a slot
+static void build_mnemonic_hash(void) {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int attempt = 0; attempt < 100000; attempt++, seed += 0xD1B54A32D192ED04ULL) {
+        memset(mnemonic_slots, 0, sizeof(mnemonic_slots));
+        bool collision = false;
+        for (size_t type = 0; type < sizeof(opcode_table) / sizeof(opcode_table[0]) && !collision; type++) {
+            if (!opcode_table[type].mnemonic) continue;
+            uint64_t key = mnemonic_key(view_of(opcode_table[type].mnemonic));
+            size_t slot = mnemonic_slot(key, seed);
+            collision = mnemonic_slots[slot].key != 0;
+            mnemonic_slots[slot].key = key;
+            mnemonic_slots[slot].type = (uint8_t)type;
+        }
+        if (!collision) {
+            mnemonic_seed = seed;
+            return;
+        }
+    }
+    fprintf(stderr, "Error: No perfect hash for the opcode table (increase MNEMONIC_HASH_BITS)\n");
+    exit(1);
+}
+
+// Function to map instruction string to enum (case-insensitive)
+InstructionType get_instruction_type(StringView mnemonic) {
+    if (mnemonic_seed == 0) build_mnemonic_hash();
+    uint64_t key = mnemonic_key(mnemonic);
+    size_t slot = mnemonic_slot(key, mnemonic_seed);
+    if (key != 0 && mnemonic_slots[slot].key == key) {
+        return (InstructionType)mnemonic_slots[slot].type;
+    }
+    return INST_NOP; // Default to NOP for unknown instructions
+}
+
+// Function to hash a symbol name (FNV-1a)
+static inline uint32_t symbol_hash(StringView name) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < name.length; i++) {
+        hash = (hash ^ (uint8_t)name.data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Function to get the interned name of a symbol
+const char* symbol_name(const SymbolTable* table, const Symbol* symbol) {
+    return table->strings + symbol->name;
+}
+
+// Function to find the slot of a name in the symbol index: the slot holding it, or the free slot that ends its probe
+static size_t find_symbol_slot(const SymbolTable* table, StringView name, uint32_t hash) {
+    size_t mask = table->slot_count - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = table->slots[slot];
+        if (entry == 0) return slot;
+        const Symbol* symbol = &table->symbols[entry - 1];
+        if (symbol->hash == hash) {
+            const char* interned = symbol_name(table, symbol);
+            if (strncmp(interned, name.data, name.length) == 0 && interned[name.length] == '\0') return slot;
+        }
+    }
+}
+
+// Function to find a symbol by name (case-sensitive); NULL if it is not defined
+const Symbol* find_symbol(const SymbolTable* table, StringView name) {
+    if (table == NULL || table->slot_count == 0) return NULL;  // Empty, or loaded from a compiled program without an index
+    if (name.length > LABEL_NAME_LENGTH) name.length = LABEL_NAME_LENGTH;
+    uint32_t entry = table->slots[find_symbol_slot(table, name, symbol_hash(name))];
+    return entry ? &table->symbols[entry - 1] : NULL;
+}
+
+// Function to double the symbol index and reinsert every symbol by its stored hash
+static void grow_symbol_index(SymbolTable* table) {
+    size_t slot_count = table->slot_count ? table->slot_count * 2 : 64;
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) {
+        fprintf(stderr, "Error: Memory allocation failed for the symbol table\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < table->count; i++) {
+        size_t slot = table->symbols[i].hash & (slot_count - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = (uint32_t)(i + 1);
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slot_count = slot_count;
+}
+
+// Function to define a symbol; names are significant up to LABEL_NAME_LENGTH characters.
+// Reports a name that is already defined and returns false.
+bool define_symbol(SymbolTable* table, StringView name, SymbolKind kind, size_t value, size_t line_num) {
+    if (name.length > LABEL_NAME_LENGTH) name.length = LABEL_NAME_LENGTH;
+    if ((table->count + 1) * 2 > table->slot_count) grow_symbol_index(table);
+
+    uint32_t hash = symbol_hash(name);
+    size_t slot = find_symbol_slot(table, name, hash);
+    if (table->slots[slot] != 0) {
+        const Symbol* previous = &table->symbols[table->slots[slot] - 1];
+        fprintf(stderr, "Error: Duplicate label '%.*s' at line %zu (first defined at line %zu)\n", VIEW_ARGS(name), line_num, previous->line);
+        return false;
+    }
+
+    // Intern the name
+    if (table->strings_length + name.length + 1 > table->strings_capacity) {
+        size_t capacity = table->strings_capacity ? table->strings_capacity : 4096;
+        while (table->strings_length + name.length + 1 > capacity) capacity *= 2;
+        table->strings = realloc(table->strings, capacity);
+        if (!table->strings) {
+            fprintf(stderr, "Error: Memory allocation failed for the symbol table\n");
+            exit(1);
+        }
+        table->strings_capacity = capacity;
+    }
+    if (table->count == table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : INITIAL_CAPACITY;
+        table->symbols = realloc(table->symbols, table->capacity * sizeof(Symbol));
+        if (!table->symbols) {
+            fprintf(stderr, "Error: Memory allocation failed for the symbol table\n");
+            exit(1);
+        }
+    }
+    Symbol* symbol = &table->symbols[table->count];
+    symbol->name = (uint32_t)table->strings_length;
+    symbol->hash = hash;
+    symbol->kind = (uint8_t)kind;
+    symbol->value = value;
+    symbol->line = line_num;
+    memcpy(table->strings + table->strings_length, name.data, name.length);
+    table->strings[table->strings_length + name.length] = '\0';
+    table->strings_length += name.length + 1;
+    table->slots[slot] = (uint32_t)++table->count;
+    return true;
+}
+
+// Function to release a symbol table
+void free_symbol_table(SymbolTable* table) {
+    free(table->symbols);
+    free(table->slots);
+    free(table->strings);
+    memset(table, 0, sizeof(*table));
+}
+
+static bool is_symbol_name(StringView text);
+static bool parse_data_number(StringView text, uint64_t* value);
+
+// Function to pick the address form of a memory operand from the parts it uses
+static void classify_memory_operand(MemoryOperand* operand) {
+    if (!operand->has_base && operand->has_index && operand->scale_shift == 0) {
+        operand->base = operand->index;  // [index*1 + disp] is [base + disp]
+        operand->has_base = true;
+        operand->has_index = false;
+    }
+    if (!operand->has_base && !operand->has_index) {
+        operand->form = ADDRESS_ABSOLUTE;
+    }
+    else if (operand->has_base && !operand->has_index) {
+        operand->form = operand->displacement ? ADDRESS_BASE_DISP : ADDRESS_BASE;
+    }
+    else if (operand->has_base && operand->scale_shift == 3 && operand->displacement == 0) {
+        operand->form = ADDRESS_BASE_INDEX8;
+    }
+    else {
+        operand->form = ADDRESS_GENERAL;
+    }
+}
+
+// Function to parse the text between the brackets of a memory operand: terms joined by '+' or '-',
+// each a 64-bit register, a register scaled by 1, 2, 4 or 8 (REG*8 or 8*REG), a number or one data label.
+// Sets *address for an absolute operand; a data label is added once labels are resolved.
+void parse_memory_address(StringView text, MemoryOperand* operand, uint64_t* address, size_t line_num) {
+    memset(operand, 0, sizeof(*operand));
+    *address = 0;
+
+    size_t c = 0;
+    bool negative = false;
+    for (;;) {
+        while (c < text.length && (text.data[c] == ' ' || text.data[c] == '\t')) c++;
+        StringView term = { text.data + c, 0 };
+        while (c < text.length && text.data[c] != '+' && text.data[c] != '-' && text.data[c] != ' ' && text.data[c] != '\t') c++;
+        term.length = (size_t)(text.data + c - term.data);
+        if (term.length == 0) {
+            fprintf(stderr, "Error: Invalid memory address '[%.*s]' at line %zu\n", VIEW_ARGS(text), line_num);
+            return;
+        }
+
+        // A register, optionally scaled
+        const char* star = memchr(term.data, '*', term.length);
+        StringView reg_text = term;
+        uint64_t scale = 1;
+        if (star) {
+            StringView left = { term.data, (size_t)(star - term.data) };
+            StringView right = { star + 1, term.length - left.length - 1 };
+            StringView scale_text = right;
+            reg_text = left;
+            if (left.length > 0 && isdigit((unsigned char)left.data[0])) {
+                reg_text = right;
+                scale_text = left;
+            }
+            parse_view_integer(scale_text, 0, &scale);
+        }
+        RegOperand reg = get_register_operand(reg_text);
+        uint64_t value;
+        if (REG_PRESENT(reg)) {
+            if (reg.width != 64 || negative || (scale != 1 && scale != 2 && scale != 4 && scale != 8) ||
+                (star && operand->has_index) || (operand->has_base && operand->has_index)) {
+                fprintf(stderr, "Error: Invalid memory address '[%.*s]' at line %zu (use [base + index*1/2/4/8 + disp] with 64-bit registers)\n", VIEW_ARGS(text), line_num);
+                return;
+            }
+            uint8_t shift = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+            if (star || operand->has_base) {
+                if (operand->has_index) {
+                    // A later scaled register takes the index slot; the unscaled one becomes the base
+                    operand->base = operand->index;
+                    operand->has_base = true;
+                }
+                operand->index = reg.index;
+                operand->scale_shift = shift;
+                operand->has_index = true;
+            }
+            else {
+                operand->base = reg.index;
+                operand->has_base = true;
+            }
+        }
+        else if (!star && is_symbol_name(term)) {
+            if (operand->label[0] || negative) {
+                fprintf(stderr, "Error: Invalid memory address '[%.*s]' at line %zu (one data label may be added)\n", VIEW_ARGS(text), line_num);
+                return;
+            }
+            copy_view(operand->label, sizeof(operand->label), term);
+        }
+        else if (!star && parse_data_number(term, &value)) {
+            operand->displacement += negative ? -(int64_t)value : (int64_t)value;
+        }
+        else {
+            fprintf(stderr, "Error: Invalid memory address term '%.*s' at line %zu\n", VIEW_ARGS(term), line_num);
+            return;
+        }
+
+        while (c < text.length && (text.data[c] == ' ' || text.data[c] == '\t')) c++;
+        if (c == text.length || (text.data[c] != '+' && text.data[c] != '-')) break;
+        negative = text.data[c] == '-';
+        c++;
+    }
+
+    classify_memory_operand(operand);
+    if (operand->form == ADDRESS_ABSOLUTE) {
+        *address = (uint64_t)operand->displacement;
+    }
+}
+
+// Function to parse the operands of a packed vector instruction:
+//   MOVDQU V, V | V, [mem] | [mem], V
+//   MOVQ   V, R64 | R64, V | V, [mem] | [mem], V
+//   Pxxx   V, V | V, [mem]
+// where V is an XMM or YMM register; two vector operands must have the same width
+bool parse_vector_operands(Instruction* inst, StringView destination, StringView source, size_t line_num) {
+    if (destination.length == 0 || source.length == 0) {
+        fprintf(stderr, "Error: Vector instruction needs two operands at line %zu\n", line_num);
+        return false;
+    }
+    copy_view(inst->dest_reg_name, sizeof(inst->dest_reg_name), destination);
+    copy_view(inst->src_reg_name, sizeof(inst->src_reg_name), source);
+
+    StringView operands[2] = { destination, source };
+    for (int i = 0; i < 2; i++) {
+        uint8_t bytes = 0;
+        int vector = get_vector_register(operands[i], &bytes);
+        const char* open = memchr(operands[i].data, '[', operands[i].length);
+        const char* close = memchr(operands[i].data, ']', operands[i].length);
+        if (vector >= 0) {
+            if (inst->vector_bytes && inst->vector_bytes != bytes) {
+                fprintf(stderr, "Error: Mixed XMM and YMM operands at line %zu\n", line_num);
+                return false;
+            }
+            inst->vector_bytes = bytes;
+            if (i == 0) {
+                inst->dest_is_vector = true;
+                inst->vector_dest = (uint8_t)vector;
+            }
+            else {
+                inst->src_is_vector = true;
+                inst->vector_src = (uint8_t)vector;
+            }
+        }
+        else if (open && close > open) {
+            StringView address = { open + 1, (size_t)(close - open - 1) };
+            if (i == 0) {
+                parse_memory_address(address, &inst->dest_address, &inst->dest_mem_address, line_num);
+                inst->dest_is_memory = true;
+            }
+            else {
+                parse_memory_address(address, &inst->src_address, &inst->src_mem_address, line_num);
+                inst->src_is_memory = true;
+            }
+        }
+        else if (inst->type == INST_MOVQ && get_register_operand(operands[i]).width == 64) {
+            if (i == 0) inst->dest_reg = get_register_operand(operands[i]);
+            else inst->src_reg = get_register_operand(operands[i]);
+        }
+        else {
+            fprintf(stderr, "Error: Invalid vector operand '%.*s' at line %zu\n", VIEW_ARGS(operands[i]), line_num);
+            return false;
+        }
+    }
+
+    // Exactly one side may be something other than a vector register; packed ops need a vector destination
+    bool valid = inst->dest_is_vector ? true : inst->src_is_vector && inst->type <= INST_MOVQ;
+    if (!valid || (REG_PRESENT(inst->dest_reg) && inst->src_is_memory) || (inst->dest_is_memory && REG_PRESENT(inst->src_reg))) {
+        fprintf(stderr, "Error: Invalid operand combination for a vector instruction at line %zu\n", line_num);
+        return false;
+    }
+    return true;
+}
+
+// Function to check whether a token is a data directive
+bool is_data_directive(StringView token) {
+    static const char* const directives[] = { "DB", "DW", "DD", "DQ", "RESB", "RESW", "RESD", "RESQ", "TIMES", "ORG" };
+    for (size_t i = 0; i < sizeof(directives) / sizeof(directives[0]); i++) {
+        if (view_equals_nocase(token, directives[i])) return true;
+    }
+    return false;
+}
+
+// Function to get the unit size named by the last letter of a directive (B, W, D or Q); 0 if none
+static size_t data_unit_size(char suffix) {
+    switch (toupper((unsigned char)suffix)) {
+    case 'B': return 1;
+    case 'W': return 2;
+    case 'D': return 4;
+    case 'Q': return 8;
+    default:  return 0;
+    }
+}
+
+// Function to check whether an operand is a symbol name rather than a number or register
+static bool is_symbol_name(StringView text) {
+    if (text.length == 0 || (!isalpha((unsigned char)text.data[0]) && text.data[0] != '_' && text.data[0] != '.')) return false;
+    for (size_t i = 1; i < text.length; i++) {
+        char c = text.data[i];
+        if (!isalnum((unsigned char)c) && c != '_' && c != '.') return false;
+    }
+    return true;
+}
+
+// Function to parse a data directive number: decimal, 0x hexadecimal, optionally negative
+static bool parse_data_number(StringView text, uint64_t* value) {
+    bool negative = text.length > 0 && text.data[0] == '-';
+    StringView digits = { text.data + negative, text.length - negative };
+    if (digits.length == 0 || !isdigit((unsigned char)digits.data[0])) return false;
+    bool hex = digits.length > 1 && (digits.data[1] == 'x' || digits.data[1] == 'X') && digits.data[0] == '0';
+    if (parse_view_integer(digits, hex ? 16 : 10, value) != digits.length) return false;
+    if (negative) *value = (uint64_t)0 - *value;
+    return true;
+}
+
+// Function to append bytes to the buffer of the directive being assembled
+static void data_buffer_append(DataSection* data, const void* bytes, size_t length) {
+    if (data->buffer_length + length > data->buffer_capacity) {
+        while (data->buffer_length + length > data->buffer_capacity) {
+            data->buffer_capacity = data->buffer_capacity ? data->buffer_capacity * 2 : 256;
+        }
+        data->buffer = realloc(data->buffer, data->buffer_capacity);
+        if (!data->buffer) {
+            fprintf(stderr, "Error: Memory allocation failed for data directive\n");
+            exit(1);
+        }
+    }
+    memcpy(data->buffer + data->buffer_length, bytes, length);
+    data->buffer_length += length;
+}
+
+// Function to record a data label item to patch; address is its buffer offset until the item is placed
+static void add_data_fixup(DataSection* data, StringView name, uint64_t address, size_t size, size_t line_num) {
+    if (data->fixup_count == data->fixup_capacity) {
+        data->fixup_capacity = data->fixup_capacity ? data->fixup_capacity * 2 : 64;
+        data->fixups = realloc(data->fixups, data->fixup_capacity * sizeof(DataFixup));
+        if (!data->fixups) {
+            fprintf(stderr, "Error: Memory allocation failed for data fixups\n");
+            exit(1);
+        }
+    }
+    DataFixup* fixup = &data->fixups[data->fixup_count++];
+    copy_view(fixup->label, sizeof(fixup->label), name);
+    fixup->address = address;
+    fixup->size = size;
+    fixup->line = line_num;
+}
+
+// Function to define a data label at the data location counter
+bool add_data_label(SymbolTable* symbols, DataSection* data, StringView name, size_t line_num) {
+    if (!define_symbol(symbols, name, SYMBOL_DATA, (size_t)data->location, line_num)) return false;
+    data->label_count++;
+    return true;
+}
+
+// Function to assemble the comma-separated items of a db/dw/dd/dq directive into the data buffer.
+// Items are numbers, quoted strings (zero padded to a whole unit) and data label names, which become
+// fixups. A ';' outside quotes starts a comment. Returns false on a syntax error.
+static bool encode_data_items(DataSection* data, StringView items, size_t unit, size_t line_num) {
+    const char* c = items.data;
+    const char* end = items.data + items.length;
+    for (;;) {
+        while (c < end && (*c == ' ' || *c == '\t')) c++;
+        if (c < end && (*c == '"' || *c == '\'' || *c == '`')) {
+            char quote = *c++;
+            const char* start = c;
+            while (c < end && *c != quote) c++;
+            if (c == end) {
+                fprintf(stderr, "Error: Unterminated string in data directive at line %zu\n", line_num);
+                return false;
+            }
+            data_buffer_append(data, start, (size_t)(c - start));
+            static const uint8_t padding[8] = { 0 };
+            size_t partial = (size_t)(c - start) % unit;
+            if (partial) data_buffer_append(data, padding, unit - partial);
+            c++;
+        }
+        else {
+            StringView item = { c, 0 };
+            while (c < end && *c != ',' && *c != ';' && *c != ' ' && *c != '\t') c++;
+            item.length = (size_t)(c - item.data);
+            if (item.length == 0) {
+                fprintf(stderr, "Error: Missing data item at line %zu\n", line_num);
+                return false;
+            }
+            uint64_t value = 0;
+            if (is_symbol_name(item)) {
+                add_data_fixup(data, item, data->buffer_length, unit, line_num);
+            }
+            else if (!parse_data_number(item, &value)) {
+                fprintf(stderr, "Error: Invalid data item '%.*s' at line %zu\n", VIEW_ARGS(item), line_num);
+                return false;
+            }
+            uint8_t bytes[8];
+            for (size_t i = 0; i < unit; i++) {
+                bytes[i] = (uint8_t)(value >> (8 * i));
+            }
+            data_buffer_append(data, bytes, unit);
+        }
+        while (c < end && (*c == ' ' || *c == '\t')) c++;
+        if (c == end || *c == ';') return true;
+        if (*c != ',') {
+            fprintf(stderr, "Error: Expected ',' between data items at line %zu\n", line_num);
+            return false;
+        }
+        c++;
+    }
+}
+
+// Function to record that data was written to [address, address + length), extending the last extent if adjacent
+static void add_data_extent(DataSection* data, uint64_t address, uint64_t length) {
+    if (length == 0) return;
+    if (data->extent_count > 0) {
+        DataExtent* last = &data->extents[data->extent_count - 1];
+        if (last->address + last->length == address) {
+            last->length += length;
+            return;
+        }
+    }
+    if (data->extent_count == data->extent_capacity) {
+        data->extent_capacity = data->extent_capacity ? data->extent_capacity * 2 : 16;
+        data->extents = realloc(data->extents, data->extent_capacity * sizeof(DataExtent));
+        if (!data->extents) {
+            fprintf(stderr, "Error: Memory allocation failed for data extents\n");
+            exit(1);
+        }
+    }
+    data->extents[data->extent_count].address = address;
+    data->extents[data->extent_count].length = length;
+    data->extent_count++;
+}
+
+// Function to reserve or claim length bytes at the data location counter; false if they do not fit in memory
+static bool claim_data_bytes(Emulator* emu, DataSection* data, uint64_t length, size_t line_num) {
+    if (data->location > emu->memory_size || length > emu->memory_size - data->location) {
+        fprintf(stderr, "Error: Data at line %zu does not fit in memory at 0x%" PRIx64 " (use ORG to move it)\n", line_num, data->location);
+        return false;
+    }
+    return true;
+}
+
+// Function to assemble one data directive at the data location counter:
+//   [TIMES n] DB/DW/DD/DQ items    RESB/RESW/RESD/RESQ n    ORG address
+// Items are written straight into emulated memory, so the initial memory image is complete when the file
+// has been read and running the program costs nothing for its data. Reserved bytes are left untouched.
+// Returns false after reporting an error.
+bool assemble_data_directive(Emulator* emu, DataSection* data, StringView directive, StringView operands, size_t line_num) {
+    if (view_equals_nocase(directive, "ORG")) {
+        StringView address = next_source_token(&operands);
+        if (!parse_data_number(address, &data->location)) {
+            fprintf(stderr, "Error: Invalid ORG address at line %zu\n", line_num);
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t count = 1;
+    if (view_equals_nocase(directive, "TIMES")) {
+        StringView count_text = next_source_token(&operands);
+        directive = next_source_token(&operands);
+        if (!parse_data_number(count_text, &count) || view_equals_nocase(directive, "TIMES") ||
+            view_equals_nocase(directive, "ORG") || !is_data_directive(directive)) {
+            fprintf(stderr, "Error: Expected 'TIMES count directive' at line %zu\n", line_num);
+            return false;
+        }
+    }
+
+    if (directive.length == 4) {
+        // RESB/RESW/RESD/RESQ
+        uint64_t units;
+        StringView units_text = next_source_token(&operands);
+        if (!parse_data_number(units_text, &units)) {
+            fprintf(stderr, "Error: Invalid reservation size at line %zu\n", line_num);
+            return false;
+        }
+        // A size that overflows cannot fit in memory either
+        uint64_t length = data_unit_size(directive.data[3]);
+        if (units > UINT64_MAX / length) length = UINT64_MAX;
+        else length *= units;
+        if (count > 0 && length > UINT64_MAX / count) length = UINT64_MAX;
+        else length *= count;
+        if (!claim_data_bytes(emu, data, length, line_num)) return false;
+        data->location += length;
+        data->bytes += length;
+        return true;
+    }
+
+    size_t unit = data_unit_size(directive.data[1]);
+    size_t first_fixup = data->fixup_count;
+    data->buffer_length = 0;
+    if (!encode_data_items(data, operands, unit, line_num)) {
+        data->fixup_count = first_fixup;
+        return false;
+    }
+    uint64_t length = data->buffer_length;
+    if (count > 0 && length > UINT64_MAX / count) length = UINT64_MAX;
+    else length *= count;
+    if (!claim_data_bytes(emu, data, length, line_num)) {
+        data->fixup_count = first_fixup;
+        return false;
+    }
+
+    // Place the label items of every repetition, then write the data; zero data is filled in one go
+    size_t item_fixups = data->fixup_count - first_fixup;
+    for (uint64_t r = 1; r < count && item_fixups > 0; r++) {
+        for (size_t i = 0; i < item_fixups; i++) {
+            DataFixup fixup = data->fixups[first_fixup + i];
+            add_data_fixup(data, view_of(fixup.label), data->location + r * data->buffer_length + fixup.address, fixup.size, line_num);
+        }
+    }
+    for (size_t i = 0; i < item_fixups; i++) {
+        data->fixups[first_fixup + i].address += data->location;
+    }
+    bool zero = true;
+    for (size_t i = 0; i < data->buffer_length && zero; i++) {
+        zero = data->buffer[i] == 0;
+    }
+    if (zero) {
+        write_memory_block(emu, data->location, NULL, (size_t)length);
+    }
+    else {
+        for (uint64_t r = 0; r < count; r++) {
+            write_memory_block(emu, data->location + r * data->buffer_length, data->buffer, data->buffer_length);
+        }
+    }
+    add_data_extent(data, data->location, length);
+    data->location += length;
+    data->bytes += length;
+    return true;
+}
+
+// Function to add the address of the data label a memory operand names to its displacement.
+// Returns 1 if the label is unknown, 0 otherwise.
+static size_t resolve_memory_label(bool is_memory, MemoryOperand* operand, uint64_t* address, const SymbolTable* symbols, size_t rip) {
+    if (!is_memory || !operand->label[0]) return 0;
+    const Symbol* symbol = find_symbol(symbols, view_of(operand->label));
+    if (!symbol || symbol->kind != SYMBOL_DATA) {
+        fprintf(stderr, "Error: Data label '%s' not found for instruction at rip=%zu\n", operand->label, rip);
+        return 1;
+    }
+    operand->displacement += (int64_t)symbol->value;
+    operand->label[0] = '\0';
+    classify_memory_operand(operand);
+    if (operand->form == ADDRESS_ABSOLUTE) {
+        *address = (uint64_t)operand->displacement;
+    }
+    return 0;
+}
+
+// Function to patch data label references once the whole file is read: an operand naming a data label
+// loads its address ("MOV RAX, table"), a memory operand adds it to its displacement ("[table + RSI*8]"),
+// and a label used as a dw/dd/dq item stores its address. Returns the number of unknown or conflicting names.
+size_t resolve_data_references(Emulator* emu, Instruction* instructions, size_t instruction_count, DataSection* data, const SymbolTable* symbols) {
+    size_t unresolved = 0;
+    for (size_t i = 0; i < instruction_count; i++) {
+        Instruction* inst = &instructions[i];
+        if (is_jump_instruction(inst->type)) continue;
+        unresolved += resolve_memory_label(inst->dest_is_memory, &inst->dest_address, &inst->dest_mem_address, symbols, i);
+        unresolved += resolve_memory_label(inst->src_is_memory, &inst->src_address, &inst->src_mem_address, symbols, i);
+        unresolved += resolve_memory_label(inst->aux_is_memory, &inst->aux_address, &inst->aux_mem_address, symbols, i);
+        if (!inst->src_is_memory && !inst->src_is_string && !inst->src_is_vector && !REG_PRESENT(inst->src_reg) && is_symbol_name(view_of(inst->src_reg_name))) {
+            const Symbol* symbol = find_symbol(symbols, view_of(inst->src_reg_name));
+            if (!symbol || symbol->kind != SYMBOL_DATA) {
+                fprintf(stderr, "Error: Data label '%s' not found for instruction at rip=%zu\n", inst->src_reg_name, i);
+                unresolved++;
+            }
+            else {
+                inst->immediate = symbol->value;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < data->fixup_count; i++) {
+        DataFixup* fixup = &data->fixups[i];
+        const Symbol* symbol = find_symbol(symbols, view_of(fixup->label));
+        if (!symbol || symbol->kind != SYMBOL_DATA) {
+            fprintf(stderr, "Error: Data label '%s' not found at line %zu\n", fixup->label, fixup->line);
+            unresolved++;
+            continue;
+        }
+        uint8_t bytes[8];
+        for (size_t b = 0; b < fixup->size; b++) {
+            bytes[b] = (uint8_t)((uint64_t)symbol->value >> (8 * b));
+        }
+        write_memory_block(emu, fixup->address, bytes, fixup->size);
+    }
+    return unresolved;
+}
+
+// Function to release a data section's fixups, buffer and extents
+void free_data_section(DataSection* data) {
+    free(data->fixups);
+    free(data->extents);
+    free(data->buffer);
+    memset(data, 0, sizeof(*data));
+}
+
+// Function to compute the parity flag (set when the low byte has an even number of 1 bits)
+bool parity_even(uint64_t value) {
+    uint8_t byte = (uint8_t)value;
+    byte ^= byte >> 4;
+    byte ^= byte >> 2;
+    byte ^= byte >> 1;
+    return !(byte & 1);
+}
+
+// Function to compute the overflow flag of MUL: set when the result's sign bit differs from the sign bits of
+// both factors. sign_bit selects the operand width (bit 63 for 64-bit operands, bit 31 for 32-bit ones).
+// The reference engine and the lazy flags of the decoded engines both use it, so they agree.
+static inline bool multiply_overflow(uint64_t a, uint64_t b, uint64_t result, uint64_t sign_bit) {
+    return ((a ^ result) & (b ^ result) & sign_bit) != 0;
+}
+
+// Function to check whether an instruction is a jump
+bool is_jump_instruction(InstructionType type) {
+    return type >= INST_JMP && type <= INST_JNP;
+}
+
+// Function to evaluate the condition of a jump instruction
+bool jump_condition_met(Emulator* emu, InstructionType type) {
+    switch (type) {
+    case INST_JMP: return true;
+    case INST_JE:  return emu->flags.zero;                                           // ZF set
+    case INST_JNE: return !emu->flags.zero;                                          // ZF clear
+    case INST_JG:  return !emu->flags.zero && emu->flags.sign == emu->flags.overflow; // ZF clear and SF == OF
+    case INST_JGE: return emu->flags.sign == emu->flags.overflow;                    // SF == OF
+    case INST_JL:  return emu->flags.sign != emu->flags.overflow;                    // SF != OF
+    case INST_JLE: return emu->flags.zero || emu->flags.sign != emu->flags.overflow; // ZF set or SF != OF
+    case INST_JA:  return !emu->flags.carry && !emu->flags.zero;                     // CF and ZF clear
+    case INST_JAE: return !emu->flags.carry;                                         // CF clear
+    case INST_JB:  return emu->flags.carry;                                          // CF set
+    case INST_JBE: return emu->flags.carry || emu->flags.zero;                       // CF or ZF set
+    case INST_JO:  return emu->flags.overflow;                                       // OF set
+    case INST_JNO: return !emu->flags.overflow;                                      // OF clear
+    case INST_JS:  return emu->flags.sign;                                           // SF set
+    case INST_JNS: return !emu->flags.sign;                                          // SF clear
+    case INST_JP:  return emu->flags.parity;                                         // PF set
+    case INST_JNP: return !emu->flags.parity;                                        // PF clear
+    default:       return false;
+    }
+}
+
+// Function to resolve jump labels to instruction indices before execution, in one pass once every label
+// (forward references included) is defined. Stores the target in target_address and returns the number of unknown labels.
+size_t link_program(Instruction* instructions, size_t instruction_count, const SymbolTable* symbols) {
+    size_t unresolved = 0;
+
+    for (size_t i = 0; i < instruction_count; i++) {
+        Instruction* inst = &instructions[i];
+        if (!is_jump_instruction(inst->type)) {
+            continue;
+        }
+
+        const Symbol* symbol = find_symbol(symbols, view_of(inst->label));
+        if (!symbol || symbol->kind != SYMBOL_CODE) {
+            fprintf(stderr, "Error: Label '%s' not found for jump instruction at rip=%zu\n", inst->label, i);
+            unresolved++;
+            continue;
+        }
+        inst->target_address = symbol->value;
+    }
+    return unresolved;
+}
+
+// Custom ROOT instruction implementation
+void execute_root_instruction(Emulator* emu, Instruction* inst) {
+    // Get base value
+    uint64_t base;
+    if (REG_PRESENT(inst->src_reg)) {
+        base = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("ROOT: Using base value from register: %lu\n", base);
+    }
+    else if (inst->src_is_memory) {
+        base = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("ROOT: Using base value from memory [0x%lx]: %lu\n", inst->src_mem_address, base);
+    }
+    else {
+        base = inst->immediate;
+        LOG_TRACE("ROOT: Using immediate base value: %lu\n", base);
+    }
+
+    // Get exponent value
+    uint64_t exponent;
+    if (REG_PRESENT(inst->aux_reg)) {
+        exponent = REG_VALUE(emu, inst->aux_reg);
+        LOG_TRACE("ROOT: Using exponent from register: %lu\n", exponent);
+    }
+    else if (inst->aux_is_memory) {
+        exponent = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
+        LOG_TRACE("ROOT: Using exponent from memory [0x%lx]: %lu\n", inst->aux_mem_address, exponent);
+    }
+    else {
+        exponent = inst->aux_immediate;
+        LOG_TRACE("ROOT: Using immediate exponent value: %lu\n", exponent);
+    }
+
+    // Check for zero exponent
+    if (exponent == 0) {
+        fprintf(stderr, "ROOT: Division by zero (exponent is zero)\n");
+        return;
+    }
+
+    // Calculate the root
+    double result = pow((double)base, 1.0 / (double)exponent);
+    uint64_t final_result = (uint64_t)result;
+
+    // Store result
+    if (REG_PRESENT(inst->dest_reg)) {
+        REG_VALUE(emu, inst->dest_reg) = final_result;
+        LOG_TRACE("ROOT: Stored result in register: %lu\n", final_result);
+    }
+    else if (inst->dest_is_memory) {
+        write_memory(emu, inst->dest_mem_address, final_result, sizeof(uint64_t));
+        LOG_TRACE("ROOT: Stored result in memory [0x%lx]: %lu\n", inst->dest_mem_address, final_result);
+    }
+
+    // Update flags
+    emu->flags.zero = (final_result == 0);
+    emu->flags.sign = (final_result & (1ULL << 63)) != 0;
+}
+
+// Custom AVG instruction implementation
+void execute_avg_instruction(Emulator* emu, Instruction* inst) {
+    uint64_t val1 = 0, val2 = 0, val3 = 0;
+
+    // Get first value (always from destination register)
+    if (!REG_PRESENT(inst->dest_reg)) {
+        fprintf(stderr, "AVG: First operand must be a register\n");
+        return;
+    }
+    val1 = REG_VALUE(emu, inst->dest_reg);
+    LOG_TRACE("AVG: First value from register: 0x%llX\n", (unsigned long long)val1);
+
+    // Get second value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->src_reg)) {
+        val2 = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("AVG: Second value from register: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_is_memory) {
+        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("AVG: Second value from memory: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_immediate) {
+        val2 = inst->immediate;
+        LOG_TRACE("AVG: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
+    }
+    else {
+        fprintf(stderr, "AVG: Invalid second operand\n");
+        return;
+    }
+
+    // Get third value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->aux_reg)) {
+        val3 = REG_VALUE(emu, inst->aux_reg);
+        LOG_TRACE("AVG: Third value from register: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_is_memory) {
+        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
+        LOG_TRACE("AVG: Third value from memory: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_immediate) {
+        val3 = inst->aux_immediate;
+        LOG_TRACE("AVG: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
+    }
+    else {
+        fprintf(stderr, "AVG: Invalid third operand\n");
+        return;
+    }
+
+    // Calculate average
+    uint64_t sum = val1 + val2 + val3;
+    uint64_t avg = sum / 3;
+
+    // Store result in destination register
+    REG_VALUE(emu, inst->dest_reg) = avg;
+    LOG_TRACE("AVG: Result 0x%llX stored in destination register\n", (unsigned long long)avg);
+
+    // Update flags
+    emu->flags.zero = (avg == 0);
+    emu->flags.sign = (avg & (1ULL << 63)) ? 1 : 0;
+}
+
+// Custom POW instruction implementation
+
+void execute_pow_instruction(Emulator* emu, Instruction* inst) {
+    uint64_t base = 0, exponent = 0;
+
+    // Determine the base value (from memory or register)
+    if (inst->dest_is_memory) {
+        base = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+        LOG_TRACE("POW: Reading base value 0x%llX from memory address 0x%llX\n",
+               base, inst->dest_mem_address);
+    } else if (REG_PRESENT(inst->dest_reg)) {
+        base = (REG_VALUE(emu, inst->dest_reg));
+        LOG_TRACE("POW: Using base value 0x%llX from destination register\n",
+               base);
+    } else {
+        fprintf(stderr, "POW: Invalid destination operand\n");
+        return;
+    }
+
+    // Determine the exponent value (from memory, register, or immediate)
+    if (inst->src_is_memory) {
+        exponent = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("POW: Reading exponent value 0x%llX from memory address 0x%llX\n",
+               exponent, inst->src_mem_address);
+    } else if (REG_PRESENT(inst->src_reg)) {
+        exponent = (REG_VALUE(emu, inst->src_reg));
+        LOG_TRACE("POW: Using exponent value 0x%llX from source register\n",
+               exponent);
+    } else {
+        exponent = (inst->immediate);
+        LOG_TRACE("POW: Using immediate exponent value 0x%llX\n", exponent);
+    }
+
+    // Perform the power operation
+    double result = pow((double)base, (double)exponent);
+
+    // Check if the result is within the valid range for uint64_t
+    if (result > (double)UINT64_MAX || result < 0) {
+        fprintf(stderr, "POW: Result overflow or invalid (result = %lf)\n", result);
+        return;
+    }
+
+    // Check if the result is an exact integer
+    if (result != floor(result)) {
+        fprintf(stderr, "POW: Result is not an exact integer (result = %lf)\n", result);
+        return;
+    }
+
+    // Convert the result to uint64_t
+    uint64_t res = (uint64_t)result;
+
+    // Handle result based on destination operand type
+    if (inst->dest_is_memory) {
+        write_memory(emu, inst->dest_mem_address, res, sizeof(uint64_t));
+        LOG_TRACE("POW: Writing result 0x%llX to memory address 0x%llX\n",
+               res, inst->dest_mem_address);
+    } else if (REG_PRESENT(inst->dest_reg)) {
+        REG_VALUE(emu, inst->dest_reg) = res;
+        LOG_TRACE("POW: Writing result 0x%llX to destination register\n", res);
+    }
+}
+
+// Custom MOD instruction implementation
+void execute_mod_instruction(Emulator* emu, Instruction* inst) {
+    uint64_t dividend = 0, divisor = 0;
+
+    // Determine the dividend (destination operand)
+    if (inst->dest_is_memory) {
+        dividend = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MOD: Reading dividend value 0x%llX from memory address 0x%llX\n",
+            (uint64_t)dividend, inst->dest_mem_address);
+    }
+    else if (REG_PRESENT(inst->dest_reg)) {
+        dividend = (REG_VALUE(emu, inst->dest_reg));
+        LOG_TRACE("MOD: Using dividend value 0x%llX from destination register\n",
+            (uint64_t)dividend);
+    }
+    else {
+        fprintf(stderr, "MOD: Invalid destination operand\n");
+        return;
+    }
+
+    // Determine the divisor (source operand)
+    if (inst->src_is_memory) {
+        divisor = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MOD: Reading divisor value 0x%llX from memory address 0x%llX\n",
+            (uint64_t)divisor, inst->src_mem_address);
+    }
+    else if (REG_PRESENT(inst->src_reg)) {
+        divisor = (REG_VALUE(emu, inst->src_reg));
+        LOG_TRACE("MOD: Using divisor value 0x%llX from source register\n",
+            (uint64_t)divisor);
+    }
+    else {
+        divisor = (inst->immediate);
+        LOG_TRACE("MOD: Using immediate divisor value 0x%llX\n", (uint64_t)divisor);
+    }
+
+    // Handle division by zero
+    if (divisor == 0) {
+        fprintf(stderr, "MOD: Division by zero error\n");
+        return;
+    }
+
+    // Perform the modulus operation
+    uint64_t result = dividend % divisor;
+
+    // Handle result based on destination operand type
+    if (inst->dest_is_memory) {
+        write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        LOG_TRACE("MOD: Writing result 0x%llX to memory address 0x%llX\n",
+            (uint64_t)result, inst->dest_mem_address);
+    }
+    else if (REG_PRESENT(inst->dest_reg)) {
+        REG_VALUE(emu, inst->dest_reg) = result;
+        LOG_TRACE("MOD: Writing result 0x%llX to destination register\n", (uint64_t)result);
+    }
+
+    // Set flags (optional, if flags are implemented in the emulator)
+    emu->flags.zero = (result == 0) ? 1 : 0;         // Zero Flag (ZF)
+    emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0; // Sign Flag (SF)
+}
+
+// Function to check if a number is prime
+bool is_prime(uint64_t n) {
+    if (n <= 1) return false;
+    if (n <= 3) return true;
+    if (n % 2 == 0 || n % 3 == 0) return false;
+    for (uint64_t i = 5; i * i <= n; i += 6) {
+        if (n % i == 0 || n % (i + 2) == 0) return false;
+    }
+    return true;
+}
+
+// Function to execute the isprime instruction
+void execute_isprime_instruction(Emulator* emu, Instruction* inst) {
+    if (!REG_PRESENT(inst->src_reg) && !inst->src_is_memory) {
+        fprintf(stderr, "ISPRIME: Invalid source operand\n");
+        return;
+    }
+
+    uint64_t src_value = 0;
+
+    // Determine the source operand value (memory or register)
+    if (inst->src_is_memory) {
+        src_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("ISPRIME: Reading source value 0x%llX from memory address 0x%llX\n",
+            (uint64_t)src_value, inst->src_mem_address);
+    }
+    else if (REG_PRESENT(inst->src_reg)) {
+        src_value = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("ISPRIME: Using source value 0x%llX from source register\n",
+            (uint64_t)src_value);
+    }
+
+    bool prime = is_prime(src_value);
+
+    if (REG_PRESENT(inst->dest_reg)) {
+        REG_VALUE(emu, inst->dest_reg) = prime ? 1 : 0;
+        LOG_TRACE("ISPRIME: Writing result 0x%llX to destination register\n", (uint64_t)(prime ? 1 : 0));
+    }
+    else if (inst->dest_is_memory) {
+        write_memory(emu, inst->dest_mem_address, prime ? 1 : 0, sizeof(uint64_t));
+        LOG_TRACE("ISPRIME: Writing result 0x%llX to memory address 0x%llX\n",
+            (uint64_t)(prime ? 1 : 0), inst->dest_mem_address);
+    }
+    else {
+        fprintf(stderr, "ISPRIME: Invalid destination operand\n");
+        return;
+    }
+
+    LOG_TRACE("Executed ISPRIME Instruction: %" PRIu64 " is %s\n",
+        src_value, prime ? "TRUE" : "FALSE");
+
+    // Determine register size and ensure the result fits if the destination is a register
+    if (REG_PRESENT(inst->dest_reg)) {
+        const char* dest_name = get_register_name(inst->dest_reg);
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && REG_VALUE(emu, inst->dest_reg) > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: Result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n",
+                REG_VALUE(emu, inst->dest_reg), dest_name);
+        }
+    }
+}
+
+// Function to mirror decimal bits
+uint64_t mirror_decimal(uint64_t decimal_value) {
+    uint64_t mirrored = 0;
+    uint64_t temp = decimal_value;
+
+    // Calculate the bit-width of the decimal value
+    int bit_width = 0;
+    if (decimal_value == 0) bit_width = 1;
+    while (temp > 0) {
+        temp >>= 1;
+        bit_width++;
+    }
+
+    // Perform bit mirroring
+    for (int i = 0; i < bit_width; ++i) {
+        mirrored <<= 1;                         // Shift mirrored value left
+        mirrored |= (decimal_value & 1);        // Add the least significant bit of value to mirrored
+        decimal_value >>= 1;                    // Shift decimal_value right to process the next bit
+    }
+
+    return mirrored;
+}
+
+// Custom MIRROR instruction implementation
+void execute_mirror_instruction(Emulator* emu, Instruction* inst) {
+    if (!REG_PRESENT(inst->src_reg) && !inst->src_is_memory) {
+        fprintf(stderr, "MIRROR: Invalid source operand\n");
+        return;
+    }
+
+    uint64_t src_value = 0;
+
+    // Determine the source operand value (memory or register)
+    if (inst->src_is_memory) {
+        src_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MIRROR: Reading source value 0x%llX from memory address 0x%llX\n",
+            (uint64_t)src_value, inst->src_mem_address);
+    }
+    else if (REG_PRESENT(inst->src_reg)) {
+        src_value = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("MIRROR: Using source value 0x%llX from source register\n",
+            (uint64_t)src_value);
+    }
+
+    uint64_t mirrored_value = mirror_decimal(src_value);
+
+    // Store the result
+    if (REG_PRESENT(inst->dest_reg)) {
+        REG_VALUE(emu, inst->dest_reg) = mirrored_value;
+        LOG_TRACE("MIRROR: Writing result 0x%llX to destination register\n", (uint64_t)mirrored_value);
+    }
+    else if (inst->dest_is_memory) {
+        write_memory(emu, inst->dest_mem_address, mirrored_value, sizeof(uint64_t));
+        LOG_TRACE("MIRROR: Writing result 0x%llX to memory address 0x%llX\n",
+            (uint64_t)mirrored_value, inst->dest_mem_address);
+    }
+    else {
+        fprintf(stderr, "MIRROR: Invalid destination operand\n");
+        return;
+    }
+
+    LOG_TRACE("Executed MIRROR Instruction: Mirror of %" PRIu64 " = %" PRIu64 "\n", src_value, mirrored_value);
+
+    // Ensure the result fits in the destination register size
+    if (REG_PRESENT(inst->dest_reg)) {
+        const char* dest_name = get_register_name(inst->dest_reg);
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && mirrored_value > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: Mirrored value 0x%016" PRIx64 " exceeds 32-bit register size for %s\n",
+                mirrored_value, dest_name);
+        }
+    }
+}
+
+// Execute MIN with three parameters
+void execute_min_instruction(Emulator* emu, Instruction* inst) {
+    uint64_t val1 = 0, val2 = 0, val3 = 0;
+
+    // Get first value (always from destination register)
+    if (!REG_PRESENT(inst->dest_reg)) {
+        fprintf(stderr, "MIN: First operand must be a register\n");
+        return;
+    }
+    val1 = REG_VALUE(emu, inst->dest_reg);
+    LOG_TRACE("MIN: First value from register: 0x%llX\n", (unsigned long long)val1);
+
+    // Get second value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->src_reg)) {
+        val2 = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("MIN: Second value from register: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_is_memory) {
+        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MIN: Second value from memory: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_immediate) {
+        val2 = inst->immediate;
+        LOG_TRACE("MIN: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
+    }
+    else {
+        fprintf(stderr, "MIN: Invalid second operand\n");
+        return;
+    }
+
+    // Get third value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->aux_reg)) {
+        val3 = REG_VALUE(emu, inst->aux_reg);
+        LOG_TRACE("MIN: Third value from register: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_is_memory) {
+        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MIN: Third value from memory: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_immediate) {
+        val3 = inst->aux_immediate;
+        LOG_TRACE("MIN: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
+    }
+    else {
+        fprintf(stderr, "MIN: Invalid third operand\n");
+        return;
+    }
+
+    // Find minimum value
+    uint64_t min_val = val1;
+    if (val2 < min_val) min_val = val2;
+    if (val3 < min_val) min_val = val3;
+
+    // Store result in destination register
+    REG_VALUE(emu, inst->dest_reg) = min_val;
+    LOG_TRACE("MIN: Result 0x%llX stored in destination register\n", (unsigned long long)min_val);
+
+    // Update flags
+    emu->flags.zero = (min_val == 0);
+    emu->flags.sign = (min_val & (1ULL << 63)) ? 1 : 0;
+}
+
+void execute_max_instruction(Emulator* emu, Instruction* inst) {
+    uint64_t val1 = 0, val2 = 0, val3 = 0;
+
+    // Get first value (always from destination register)
+    if (!REG_PRESENT(inst->dest_reg)) {
+        fprintf(stderr, "MAX: First operand must be a register\n");
+        return;
+    }
+    val1 = REG_VALUE(emu, inst->dest_reg);
+    LOG_TRACE("MAX: First value from register: 0x%llX\n", (unsigned long long)val1);
+
+    // Get second value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->src_reg)) {
+        val2 = REG_VALUE(emu, inst->src_reg);
+        LOG_TRACE("MAX: Second value from register: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_is_memory) {
+        val2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MAX: Second value from memory: 0x%llX\n", (unsigned long long)val2);
+    }
+    else if (inst->src_immediate) {
+        val2 = inst->immediate;
+        LOG_TRACE("MAX: Second value from immediate: 0x%llX\n", (unsigned long long)val2);
+    }
+    else {
+        fprintf(stderr, "MAX: Invalid second operand\n");
+        return;
+    }
+
+    // Get third value (from register, memory, or immediate)
+    if (REG_PRESENT(inst->aux_reg)) {
+        val3 = REG_VALUE(emu, inst->aux_reg);
+        LOG_TRACE("MAX: Third value from register: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_is_memory) {
+        val3 = read_memory(emu, inst->aux_mem_address, sizeof(uint64_t));
+        LOG_TRACE("MAX: Third value from memory: 0x%llX\n", (unsigned long long)val3);
+    }
+    else if (inst->aux_immediate) {
+        val3 = inst->aux_immediate;
+        LOG_TRACE("MAX: Third value from immediate: 0x%llX\n", (unsigned long long)val3);
+    }
+    else {
+        fprintf(stderr, "MAX: Invalid third operand\n");
+        return;
+    }
+
+    // Find maximum value
+    uint64_t max_val = val1;
+    if (val2 > max_val) max_val = val2;
+    if (val3 > max_val) max_val = val3;
+
+    // Store result in destination register
+    REG_VALUE(emu, inst->dest_reg) = max_val;
+    LOG_TRACE("MAX: Result 0x%llX stored in destination register\n", (unsigned long long)max_val);
+
+    // Update flags
+    emu->flags.zero = (max_val == 0);
+    emu->flags.sign = (max_val & (1ULL << 63)) ? 1 : 0;
+}
+
+// Function to set the flags of an 8-bit compare a - b (CMPSB, SCASB)
+static void set_byte_compare_flags(Emulator* emu, uint8_t a, uint8_t b) {
+    uint8_t result = (uint8_t)(a - b);
+    emu->flags.zero = (result == 0);
+    emu->flags.sign = (result >> 7) & 1;
+    emu->flags.carry = a < b;
+    emu->flags.overflow = (((a ^ b) & (a ^ result)) >> 7) & 1;
+    emu->flags.parity = parity_even(result);
+}
+
+// Function to check that a string instruction's elements lie in memory
+static bool string_range_valid(const Emulator* emu, uint64_t low, uint64_t length) {
+    if (low >= emu->memory_size || length > emu->memory_size - low) {
+        fprintf(stderr, "Error: String operation out of bounds at address 0x%" PRIx64 "\n", low);
+        return false;
+    }
+    return true;
+}
+
+// Function to execute MOVSB/MOVSQ/STOSB/STOSQ/CMPSB/SCASB, with a REP prefix as one bulk operation:
+// MOVS is a memcpy, STOS a memset or pattern fill, SCASB a memchr and CMPSB a memcmp over the whole range
+// instead of one emulated iteration per element. The direction flag picks increasing or decreasing addresses.
+void execute_string_instruction(Emulator* emu, Instruction* inst) {
+    size_t size = (inst->type == INST_MOVSQ || inst->type == INST_STOSQ) ? 8 : 1;
+    bool repeated = inst->rep_prefix != REP_NONE;
+    uint64_t count = repeated ? emu->rcx : 1;
+    if (count == 0) return;
+    if (count > emu->memory_size / size) {
+        fprintf(stderr, "Error: String operation count 0x%" PRIx64 " exceeds memory\n", count);
+        return;
+    }
+    bool backward = emu->flags.direction;
+    uint64_t span = (count - 1) * size;  // Distance between the first and last element
+    uint64_t length = count * size;
+    uint64_t source_low = backward ? emu->rsi - span : emu->rsi;
+    uint64_t destination_low = backward ? emu->rdi - span : emu->rdi;
+    bool uses_source = inst->type == INST_MOVSB || inst->type == INST_MOVSQ || inst->type == INST_CMPSB;
+    if ((uses_source && !string_range_valid(emu, source_low, length)) || !string_range_valid(emu, destination_low, length)) {
+        return;
+    }
+
+    // Elements executed; a REPE/REPNE compare may stop early
+    uint64_t done = count;
+    bool stop_on_equal = inst->rep_prefix == REP_NOT_EQUAL;
+    switch (inst->type) {
+    case INST_MOVSB:
+    case INST_MOVSQ:
+        if (source_low < destination_low + length && destination_low < source_low + length && source_low != destination_low) {
+            // Overlapping copies keep the element-by-element result
+            for (uint64_t i = 0; i < count; i++) {
+                uint64_t offset = backward ? span - i * size : i * size;
+                write_memory(emu, destination_low + offset, read_memory(emu, source_low + offset, size), size);
+            }
+        }
+        else {
+            copy_memory_block(emu, destination_low, source_low, length);
+        }
+        break;
+
+    case INST_STOSB:
+    case INST_STOSQ:
+        fill_memory_block(emu, destination_low, length, emu->rax, size);
+        break;
+
+    case INST_SCASB: {
+        uint8_t value = (uint8_t)emu->rax;
+        done = scan_memory_block(emu, emu->rdi, count, value, stop_on_equal, backward);
+        uint64_t last = backward ? emu->rdi - (done - 1) : emu->rdi + (done - 1);
+        set_byte_compare_flags(emu, value, (uint8_t)read_memory(emu, last, 1));
+        break;
+    }
+
+    case INST_CMPSB: {
+        done = compare_memory_blocks(emu, emu->rsi, emu->rdi, count, stop_on_equal, backward);
+        uint64_t step = done - 1;
+        uint64_t last_source = backward ? emu->rsi - step : emu->rsi + step;
+        uint64_t last_destination = backward ? emu->rdi - step : emu->rdi + step;
+        set_byte_compare_flags(emu, (uint8_t)read_memory(emu, last_source, 1), (uint8_t)read_memory(emu, last_destination, 1));
+        break;
+    }
+
+    default:
+        return;
+    }
+
+    uint64_t advance = done * size;
+    if (uses_source) {
+        emu->rsi = backward ? emu->rsi - advance : emu->rsi + advance;
+    }
+    emu->rdi = backward ? emu->rdi - advance : emu->rdi + advance;
+    if (repeated) {
+        emu->rcx -= done;
+    }
+    LOG_TRACE("Executed string instruction: %" PRIu64 " elements, RSI = 0x%016" PRIx64 ", RDI = 0x%016" PRIx64 ", RCX = 0x%016" PRIx64 "\n",
+        done, emu->rsi, emu->rdi, emu->rcx);
+}
+
+// Packed operations in INST_PADDQ..INST_PMAXUB order. Each has a scalar, an SSE2 and an AVX2 kernel;
+// select_vector_kernels picks one set for the whole run from what the host CPU supports.
+// X(name, lane bytes, scalar expression on lanes a and b, SSE2 expression, AVX2 expression)
+#define VECTOR_OPS(X) \
+    X(PADDQ,   8, a + b,                     _mm_add_epi64(a, b),   _mm256_add_epi64(a, b)) \
+    X(PSUBQ,   8, a - b,                     _mm_sub_epi64(a, b),   _mm256_sub_epi64(a, b)) \
+    X(PAND,    8, a & b,                     _mm_and_si128(a, b),   _mm256_and_si256(a, b)) \
+    X(POR,     8, a | b,                     _mm_or_si128(a, b),    _mm256_or_si256(a, b)) \
+    X(PXOR,    8, a ^ b,                     _mm_xor_si128(a, b),   _mm256_xor_si256(a, b)) \
+    X(PCMPEQB, 1, a == b ? UINT64_MAX : 0,   _mm_cmpeq_epi8(a, b),  _mm256_cmpeq_epi8(a, b)) \
+    X(PCMPEQQ, 8, a == b ? UINT64_MAX : 0,   sse2_cmpeq_epi64(a, b), _mm256_cmpeq_epi64(a, b)) \
+    X(PMINUB,  1, a < b ? a : b,             _mm_min_epu8(a, b),    _mm256_min_epu8(a, b)) \
+    X(PMAXUB,  1, a > b ? a : b,             _mm_max_epu8(a, b),    _mm256_max_epu8(a, b))
+
+// Vector kernel: destination = destination op source over length (16 or 32) bytes
+typedef void (*VectorKernel)(uint8_t* destination, const uint8_t* source, size_t length);
+
+// Scalar kernels work on any host; lanes are loaded into the low bytes of a uint64_t (hosts are little-endian)
+#define SCALAR_VECTOR_KERNEL(name, lane, scalar, sse2, avx2) \
+static void scalar_##name(uint8_t* destination, const uint8_t* source, size_t length) { \
+    for (size_t i = 0; i < length; i += lane) { \
+        uint64_t a = 0, b = 0; \
+        memcpy(&a, destination + i, lane); \
+        memcpy(&b, source + i, lane); \
+        uint64_t result = scalar; \
+        memcpy(destination + i, &result, lane); \
+    } \
+}
+VECTOR_OPS(SCALAR_VECTOR_KERNEL)
+#undef SCALAR_VECTOR_KERNEL
+
+static const VectorKernel scalar_vector_kernels[] = {
+#define SCALAR_VECTOR_ENTRY(name, lane, scalar, sse2, avx2) scalar_##name,
+    VECTOR_OPS(SCALAR_VECTOR_ENTRY)
+#undef SCALAR_VECTOR_ENTRY
+};
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+// Function to compare quadwords with SSE2, which only compares doublewords: both halves must be equal
+static inline __m128i sse2_cmpeq_epi64(__m128i a, __m128i b) {
+    __m128i halves = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// SSE2 is part of x86-64, so these kernels need no CPU check
+#define SSE2_VECTOR_KERNEL(name, lane, scalar, sse2, avx2) \
+static void sse2_##name(uint8_t* destination, const uint8_t* source, size_t length) { \
+    for (size_t i = 0; i < length; i += 16) { \
+        __m128i a = _mm_loadu_si128((const __m128i*)(destination + i)); \
+        __m128i b = _mm_loadu_si128((const __m128i*)(source + i)); \
+        _mm_storeu_si128((__m128i*)(destination + i), sse2); \
+    } \
+}
+VECTOR_OPS(SSE2_VECTOR_KERNEL)
+#undef SSE2_VECTOR_KERNEL
+
+// AVX2 kernels do a YMM operand in one host instruction and hand XMM operands to the SSE2 kernel
+#define AVX2_VECTOR_KERNEL(name, lane, scalar, sse2, avx2) \
+static TARGET_AVX2 void avx2_##name(uint8_t* destination, const uint8_t* source, size_t length) { \
+    if (length < 32) { \
+        sse2_##name(destination, source, length); \
+        return; \
+    } \
+    __m256i a = _mm256_loadu_si256((const __m256i*)destination); \
+    __m256i b = _mm256_loadu_si256((const __m256i*)source); \
+    _mm256_storeu_si256((__m256i*)destination, avx2); \
+}
+VECTOR_OPS(AVX2_VECTOR_KERNEL)
+#undef AVX2_VECTOR_KERNEL
+
+static const VectorKernel sse2_vector_kernels[] = {
+#define SSE2_VECTOR_ENTRY(name, lane, scalar, sse2, avx2) sse2_##name,
+    VECTOR_OPS(SSE2_VECTOR_ENTRY)
+#undef SSE2_VECTOR_ENTRY
+};
+
+static const VectorKernel avx2_vector_kernels[] = {
+#define AVX2_VECTOR_ENTRY(name, lane, scalar, sse2, avx2) avx2_##name,
+    VECTOR_OPS(AVX2_VECTOR_ENTRY)
+#undef AVX2_VECTOR_ENTRY
+};
+
+// Function to check whether the host CPU and OS support AVX2 (the OS must save YMM state)
+static bool host_supports_avx2(void) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] >> 27) & 1;
+    bool avx = (info[2] >> 28) & 1;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+// Kernels of the packed instructions, indexed by type - INST_PADDQ
+static const VectorKernel* vector_kernels = scalar_vector_kernels;
+static VectorIsa active_vector_isa = VECTOR_ISA_SCALAR;
+static const char* const vector_isa_names[] = { "scalar", "SSE2", "AVX2" };
+
+// Function to pick the best vector kernels the host supports, up to limit; returns the instruction set chosen
+VectorIsa select_vector_kernels(VectorIsa limit) {
+    vector_kernels = scalar_vector_kernels;
+    active_vector_isa = VECTOR_ISA_SCALAR;
+#if defined(__x86_64__) || defined(_M_X64)
+    if (limit >= VECTOR_ISA_AVX2 && host_supports_avx2()) {
+        vector_kernels = avx2_vector_kernels;
+        active_vector_isa = VECTOR_ISA_AVX2;
+    }
+    else if (limit >= VECTOR_ISA_SSE2) {
+        vector_kernels = sse2_vector_kernels;
+        active_vector_isa = VECTOR_ISA_SSE2;
+    }
+#endif
+    return active_vector_isa;
+}
+
+// Function to execute a packed vector instruction. Memory operands are read and written as one block,
+// in place in the page when the TLB holds it. Vector instructions leave the flags unchanged.
+void execute_vector_instruction(Emulator* emu, const Instruction* inst) {
+    size_t length = inst->vector_bytes;
+    uint8_t buffer[32];
+    uint64_t dest_address = 0;
+    uint64_t src_address = 0;
+    if (inst->dest_is_memory) {
+        dest_address = inst->dest_address.form == ADDRESS_ABSOLUTE ? inst->dest_mem_address : effective_address(emu, &inst->dest_address);
+    }
+    if (inst->src_is_memory) {
+        src_address = inst->src_address.form == ADDRESS_ABSOLUTE ? inst->src_mem_address : effective_address(emu, &inst->src_address);
+    }
+    uint8_t* destination = emu->vector[inst->vector_dest].bytes;
+    const uint8_t* source = emu->vector[inst->vector_src].bytes;
+
+    switch (inst->type) {
+    case INST_MOVDQU:
+        if (inst->dest_is_memory) {
+            write_vector_memory(emu, dest_address, source, length);
+        }
+        else if (inst->src_is_memory) {
+            const uint8_t* loaded = read_vector_memory(emu, src_address, buffer, length);
+            if (loaded) memcpy(destination, loaded, length);
+        }
+        else {
+            memmove(destination, source, length);
+        }
+        break;
+
+    case INST_MOVQ: {
+        // A vector destination gets the quadword and zeros in the rest of the register named
+        uint64_t value;
+        if (inst->dest_is_vector) {
+            if (inst->src_is_memory) {
+                const uint8_t* loaded = read_vector_memory(emu, src_address, buffer, sizeof(uint64_t));
+                if (!loaded) break;
+                memcpy(&value, loaded, sizeof(value));
+            }
+            else if (inst->src_is_vector) {
+                memcpy(&value, source, sizeof(value));
+            }
+            else {
+                value = REG_VALUE(emu, inst->src_reg);
+            }
+            memset(destination, 0, length);
+            memcpy(destination, &value, sizeof(value));
+        }
+        else if (inst->dest_is_memory) {
+            write_vector_memory(emu, dest_address, source, sizeof(uint64_t));
+        }
+        else {
+            memcpy(&value, source, sizeof(value));
+            REG_VALUE(emu, inst->dest_reg) = value;
+        }
+        break;
+    }
+
+    default:
+        if (inst->type < INST_PADDQ || inst->type > INST_PMAXUB) return;
+        if (inst->src_is_memory) {
+            source = read_vector_memory(emu, src_address, buffer, length);
+            if (!source) break;
+        }
+        vector_kernels[inst->type - INST_PADDQ](destination, source, length);
+        break;
+    }
+    LOG_TRACE("Executed vector instruction: %s = 0x%016" PRIx64 "%016" PRIx64 " (low 16 bytes)\n",
+        inst->dest_reg_name, emu->vector[inst->vector_dest].qwords[1], emu->vector[inst->vector_dest].qwords[0]);
+}
+
+// Function to print a register in specified format
+void print_reg(const char* name, uint64_t value, NumberFormat format, size_t size) {
+    if (format == HEX) {
+        switch (size) {
+        case 32:
+            printf("%-6s: 0x%08" PRIx64 "    ", name, value);
+            break;
+        case 64:
+            printf("%-6s: 0x%016" PRIx64 "    ", name, value);
+            break;
+        default:
+            printf("%-6s: 0x%016" PRIx64 "    ", name, value);
+            break;
+        }
+    }
+    else {
+        switch (size) {
+        case 32:
+            printf("%-6s: %" PRIu32 "    ", name, (uint32_t)value);
+            break;
+        case 64:
+            printf("%-6s: %" PRIu64 "    ", name, value);
+            break;
+        default:
+            printf("%-6s: %" PRIu64 "    ", name, value);
+            break;
+        }
+    }
+}
+
+// Print current emulator state
+void print_emulator_state(Emulator* emu, const char* phase) {
+    // Allow printing if tracing is enabled or if it's the final state
+    if (!tracing_enabled && strcmp(phase, "Final State") != 0) return;
+
+    printf("\n--- Emulator State: %s ---\n", phase);
+    printf("Registers:\n");
+
+    NumberFormat format = HEX; // Set format to HEX for all registers
+
+    // Print primary registers
+    print_reg("RAX", emu->rax, format, 64);
+    print_reg("EAX", emu->eax, format, 32);
+    printf("\n");
+
+    print_reg("RBX", emu->rbx, format, 64);
+    print_reg("EBX", emu->ebx, format, 32);
+    printf("\n");
+
+    print_reg("RCX", emu->rcx, format, 64);
+    print_reg("ECX", emu->ecx, format, 32);
+    printf("\n");
+
+    print_reg("RDX", emu->rdx, format, 64);
+    print_reg("EDX", emu->edx, format, 32);
+    printf("\n");
+
+    print_reg("RSI", emu->rsi, format, 64);
+    print_reg("ESI", emu->esi, format, 32);
+    printf("\n");
+
+    print_reg("RDI", emu->rdi, format, 64);
+    print_reg("EDI", emu->edi, format, 32);
+    printf("\n");
+
+    print_reg("RSP", emu->rsp, format, 64);
+    print_reg("ESP", emu->esp, format, 32);
+    printf("\n");
+
+    print_reg("RBP", emu->rbp, format, 64);
+    print_reg("EBP", emu->ebp, format, 32);
+    printf("\n");
+
+    print_reg("R8", emu->r8, format, 64);
+    print_reg("R8D", emu->r8d, format, 32);
+    printf("\n");
+
+    print_reg("R9", emu->r9, format, 64);
+    print_reg("R9D", emu->r9d, format, 32);
+    printf("\n");
+
+    print_reg("R10", emu->r10, format, 64);
+    print_reg("R10D", emu->r10d, format, 32);
+    printf("\n");
+
+    print_reg("R11", emu->r11, format, 64);
+    print_reg("R11D", emu->r11d, format, 32);
+    printf("\n");
+
+    print_reg("R12", emu->r12, format, 64);
+    print_reg("R12D", emu->r12d, format, 32);
+    printf("\n");
+
+    print_reg("R13", emu->r13, format, 64);
+    print_reg("R13D", emu->r13d, format, 32);
+    printf("\n");
+
+    print_reg("R14", emu->r14, format, 64);
+    print_reg("R14D", emu->r14d, format, 32);
+    printf("\n");
+
+    print_reg("R15", emu->r15, format, 64);
+    print_reg("R15D", emu->r15d, format, 32);
+    printf("\n");
+
+    // Vector registers are listed only once a program has used them
+    for (int i = 0; i < 16; i++) {
+        const uint64_t* lanes = emu->vector[i].qwords;
+        if (lanes[0] | lanes[1] | lanes[2] | lanes[3]) {
+            printf("YMM%-2d : 0x%016" PRIx64 "_%016" PRIx64 "_%016" PRIx64 "_%016" PRIx64 "\n",
+                i, lanes[3], lanes[2], lanes[1], lanes[0]);
+        }
+    }
+
+    printf("\nFlags:\n");
+    printf("Carry: %d\tParity: %d\tZero: %d\tSign: %d\tOverflow: %d\tDirection: %d\tInterrupt: %d\tTrap: %d\tAlignment: %d\n",
+        emu->flags.carry, emu->flags.parity, emu->flags.zero, emu->flags.sign, emu->flags.overflow,
+        emu->flags.direction, emu->flags.interrupt, emu->flags.trap, emu->flags.alignment);
+
+    printf("\nSegment Registers:\n");
+    printf("CS: 0x%04X\tDS: 0x%04X\tSS: 0x%04X\tES: 0x%04X\tFS: 0x%04X\tGS: 0x%04X\n",
+        emu->cs, emu->ds, emu->ss, emu->es, emu->fs, emu->gs);
+
+    printf("\nInstruction Pointer (RIP): 0x%016" PRIx64 "\n", emu->rip);
+    printf("----------------------------------------\n");
+}
+
+// Comprehensive instruction execution
+// Function to print one operand slot of an instruction for tracing
+static void print_operand(const Instruction* inst, OperandSlot slot) {
+    bool is_memory = slot == OPERAND_SLOT_DEST ? inst->dest_is_memory : slot == OPERAND_SLOT_SRC ? inst->src_is_memory : inst->aux_is_memory;
+    uint64_t address = slot == OPERAND_SLOT_DEST ? inst->dest_mem_address : slot == OPERAND_SLOT_SRC ? inst->src_mem_address : inst->aux_mem_address;
+    RegOperand reg = slot == OPERAND_SLOT_DEST ? inst->dest_reg : slot == OPERAND_SLOT_SRC ? inst->src_reg : inst->aux_reg;
+    const char* name = slot == OPERAND_SLOT_DEST ? inst->dest_reg_name : slot == OPERAND_SLOT_SRC ? inst->src_reg_name : inst->aux_reg_name;
+
+    if (is_memory) {
+        printf("[0x%" PRIX64 "]", address);
+    } else if (REG_PRESENT(reg)) {
+        printf("%s", name);
+    } else if (slot == OPERAND_SLOT_SRC && inst->src_is_string) {
+        printf("\"%s\"", inst->src_string);
+    } else {
+        printf("0x%016" PRIx64, slot == OPERAND_SLOT_AUX ? inst->aux_immediate : inst->immediate);
+    }
+}
+
+// Function to print an instruction as the tracer shows it, driven by its opcode table entry
+static void print_instruction(const Instruction* inst) {
+    static const char* const prefix_names[] = { "", "REP ", "REPE ", "REPNE " };
+    const OpcodeInfo* info = inst->type < sizeof(opcode_table) / sizeof(opcode_table[0]) ? &opcode_table[inst->type] : NULL;
+    if (!info || !info->mnemonic) {
+        printf("UNKNOWN");
+        return;
+    }
+
+    printf("%s%s", prefix_names[inst->rep_prefix], info->mnemonic);
+    switch (info->syntax) {
+    case SYNTAX_OPERANDS:
+        for (int slot = OPERAND_SLOT_DEST; slot <= OPERAND_SLOT_AUX && info->rules[slot]; slot++) {
+            printf(slot == OPERAND_SLOT_DEST ? " " : ", ");
+            print_operand(inst, (OperandSlot)slot);
+        }
+        break;
+    case SYNTAX_INTERRUPT:
+        printf(" 0x%02" PRIx64, inst->immediate);
+        if (inst->function) printf(", 0x%02" PRIx64, inst->function);
+        break;
+    case SYNTAX_LABEL:
+        printf(" %s", inst->label);
+        break;
+    case SYNTAX_VECTOR:
+        printf(" %s, %s", inst->dest_reg_name, inst->src_reg_name);
+        break;
+    default:
+        break;
+    }
+}
+
+void execute_instruction(Emulator* emu, Instruction* inst, size_t inst_num) {  // Comprehensive instruction execution
+    // Register-based memory operands run on a copy holding this execution's addresses
+    Instruction resolved;
+    if ((inst->dest_is_memory && inst->dest_address.form != ADDRESS_ABSOLUTE) ||
+        (inst->src_is_memory && inst->src_address.form != ADDRESS_ABSOLUTE) ||
+        (inst->aux_is_memory && inst->aux_address.form != ADDRESS_ABSOLUTE)) {
+        resolved = *inst;
+        if (inst->dest_is_memory) resolved.dest_mem_address = effective_address(emu, &inst->dest_address);
+        if (inst->src_is_memory) resolved.src_mem_address = effective_address(emu, &inst->src_address);
+        if (inst->aux_is_memory) resolved.aux_mem_address = effective_address(emu, &inst->aux_address);
+        inst = &resolved;
+    }
+
+    if (tracing_enabled) {
+        // Print the current instruction being executed with actual register names
+        printf("\n=== Executing Instruction %zu ===\n", inst_num + 1);
+        printf("Instruction: ");
+
+        print_instruction(inst);
+        printf("\n");
+
+        // Print registers before execution
+        print_emulator_state(emu, "Before Execution");
+    }
+
+    // Execute the instruction based on its type
+    switch (inst->type) {
+        // Data Movement Instructions
+        case INST_INT:
+            if (inst->immediate < 256 && interrupt_handlers[inst->immediate]) {
+                // Handlers read the function number from the immediate field; pass them a copy
+                // so the shared instruction is never modified
+                Instruction call = *inst;
+                call.immediate = inst->function;  // Set the function number (09 in your case)
+                interrupt_handlers[inst->immediate](emu, &call);
+            } else {
+                fprintf(stderr, "Error: Unsupported interrupt number 0x%I64X\n", inst->immediate);
+            }
+        break;
+case INST_MOV:
+    if (inst->dest_is_memory) {
+        // Writing to memory
+        uint64_t value = 0;
+        if (inst->src_is_string) {
+            // Source is a string literal
+            const char* string = inst->src_string;
+            uint64_t address = inst->dest_mem_address;
+            size_t str_len = strlen(string);
+
+            // Write string to memory
+            for (size_t i = 0; i < str_len; ++i) {
+                write_memory(emu, address + i, string[i], sizeof(uint8_t));
+            }
+
+            // Null-terminate the string in memory
+            write_memory(emu, address + str_len, '\0', sizeof(uint8_t));
+
+            LOG_TRACE("MOV: Wrote string \"%s\" to memory address 0x%llX\n", string, address);
+        }
+        else if (inst->src_is_memory) {
+            // Source is memory
+            uint64_t value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
+
+            LOG_TRACE("MOV: Copied value 0x%016" PRIx64 " from memory address 0x%llX to 0x%llX\n",
+                   value, inst->src_mem_address, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            // Source is a register
+            uint64_t value = REG_VALUE(emu, inst->src_reg);
+            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
+            LOG_TRACE("MOV: Copied value 0x%016" PRIx64 " from source register %s to memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
+        }
+        else {
+            // Source is an immediate value
+            uint64_t value = inst->immediate;
+            write_memory(emu, inst->dest_mem_address, value, sizeof(uint64_t));
+
+            LOG_TRACE("MOV: Wrote immediate value 0x%016" PRIx64 " to memory address 0x%llX\n",
+                   value, inst->dest_mem_address);
+        }
+    }
+    else if (REG_PRESENT(inst->dest_reg)) {
+        // Writing to a register
+        uint64_t value = 0;
+
+        if (inst->src_is_memory) {
+            // Source is memory
+            value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+
+            LOG_TRACE("MOV: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64
+                   " into destination register %s\n",
+                   value, inst->src_mem_address, inst->dest_reg_name);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            // Source is another register
+            value = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("MOV: Moving value 0x%016" PRIx64 " from source register %s to destination register %s\n",
+                   value, inst->src_reg_name, inst->dest_reg_name);
+        }
+        else if (inst->src_is_string) {
+            // Convert first character of string to its ASCII value
+            value = (uint64_t)inst->src_string[0];
+
+            LOG_TRACE("MOV: Moving first character '%c' (ASCII 0x%016" PRIx64 ") from string to register %s\n",
+                   inst->src_string[0], value, inst->dest_reg_name);
+        }
+        else {
+            // Source is an immediate value
+            value = inst->immediate;
+
+            LOG_TRACE("MOV: Moving immediate value 0x%016" PRIx64 " to destination register %s\n",
+                   value, inst->dest_reg_name);
+        }
+
+        // Move the value to the destination register
+        REG_VALUE(emu, inst->dest_reg) = value;
+    }
+    else {
+        // Invalid instruction format
+        fprintf(stderr, "MOV: Invalid instruction format\n");
+        // Consider adding more detailed error logging
+        exit(EXIT_FAILURE);
+    }
+    break;
+
+    case INST_PUSH:
+    {
+        // Determine the value to push onto the stack
+        uint64_t value = 0;
+
+        if (inst->dest_is_memory) {
+            // Push the value from memory to the stack
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("PUSH: Pushing value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 " onto the stack\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Push the value from a register to the stack
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("PUSH: Pushing value 0x%016" PRIx64 " from register %s onto the stack\n", value, inst->dest_reg_name);
+        }
+        else {
+            fprintf(stderr, "PUSH: Invalid operand (must be a register or memory)\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Push the value onto the stack
+        push(emu, value);
+
+        LOG_TRACE("Executed PUSH Instruction: Pushed 0x%016" PRIx64 " to stack\n", value);
+    }
+    break;
+
+    case INST_POP:
+    {
+        // Pop the value from the stack
+        uint64_t value = pop(emu);
+
+        // Determine where to store the popped value
+        if (inst->dest_is_memory) {
+            // Pop a value from the stack into memory; an RSP-based address uses RSP after the pop
+            uint64_t address = inst->dest_address.form == ADDRESS_ABSOLUTE ? inst->dest_mem_address : effective_address(emu, &inst->dest_address);
+            LOG_TRACE("POP: Popping value 0x%016" PRIx64 " from the stack into memory address 0x%016" PRIx64 "\n", value, address);
+            write_memory(emu, address, value, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Pop a value from the stack into a register
+            LOG_TRACE("POP: Popping value 0x%016" PRIx64 " from the stack into register %s\n", value, inst->dest_reg_name);
+            REG_VALUE(emu, inst->dest_reg) = value;
+
+            // Determine register size
+            size_t size = inst->dest_reg.width;
+
+            // Check if the popped value fits in the register size
+            if (size == 32 && value > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Popped value 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", value, inst->dest_reg_name);
+            }
+            // 64-bit can hold all values
+        }
+        else {
+            fprintf(stderr, "POP: Invalid operand (must be a register or memory)\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed POP Instruction: Popped 0x%016" PRIx64 " from stack\n", value);
+    }
+    break;
+
+    case INST_XCHG:
+    {
+        // Check for invalid memory-to-memory exchange
+        if (inst->dest_is_memory && inst->src_is_memory) {
+            fprintf(stderr, "XCHG: Invalid instruction format (memory-to-memory exchange is not supported)\n");
+            exit(EXIT_FAILURE);
+        }
+
+        uint64_t temp_value = 0;
+
+        // If the destination is memory
+        if (inst->dest_is_memory) {
+            // Read the current value from the destination memory
+            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("XCHG: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
+
+            // Determine the source value
+            if (inst->src_is_memory) {
+                // Source is memory, read value from memory
+                temp_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("XCHG: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", temp_value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                // Source is a register, swap with memory
+                temp_value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("XCHG: Reading value 0x%016" PRIx64 " from source register %s and swapping with memory address 0x%016" PRIx64 "\n", temp_value, inst->src_reg_name, inst->dest_mem_address);
+            }
+            else {
+                // Source is an immediate value
+                temp_value = inst->immediate;
+                LOG_TRACE("XCHG: Swapping immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", temp_value, inst->dest_mem_address);
+            }
+
+            // Write the source value (temp_value) to the destination memory
+            write_memory(emu, inst->dest_mem_address, temp_value, sizeof(uint64_t));
+
+            // Write the original memory value to the source memory (or register)
+            if (inst->src_is_memory) {
+                write_memory(emu, inst->src_mem_address, mem_value, sizeof(uint64_t));
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                REG_VALUE(emu, inst->src_reg) = mem_value;
+            }
+            else {
+                // Immediate case, should not happen for memory-based XCHG
+                fprintf(stderr, "XCHG: Invalid operand handling\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        // If the destination is a register
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Determine the source value
+            if (inst->src_is_memory) {
+                // Source is memory
+                temp_value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("XCHG: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 " into destination register %s\n", temp_value, inst->src_mem_address, inst->dest_reg_name);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                // Source is another register
+                temp_value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("XCHG: Reading value 0x%016" PRIx64 " from source register %s and swapping with destination register %s\n", temp_value, inst->src_reg_name, inst->dest_reg_name);
+            }
+            else {
+                // Source is an immediate value
+                temp_value = inst->immediate;
+                LOG_TRACE("XCHG: Swapping immediate value 0x%016" PRIx64 " with destination register %s\n", temp_value, inst->dest_reg_name);
+            }
+
+            // Swap the values between source and destination
+            uint64_t temp = REG_VALUE(emu, inst->dest_reg);
+            REG_VALUE(emu, inst->dest_reg) = temp_value;
+
+            if (inst->src_is_memory) {
+                write_memory(emu, inst->src_mem_address, temp, sizeof(uint64_t));
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                REG_VALUE(emu, inst->src_reg) = temp;
+            }
+
+            LOG_TRACE("XCHG: Swapped value 0x%016" PRIx64 " with destination register %s\n", temp, inst->dest_reg_name);
+        }
+        else {
+            // Invalid instruction format
+            fprintf(stderr, "XCHG: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    break;
+
+        // Arithmetic Instructions
+    case INST_ADD:
+    {
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+        uint64_t original_value = 0;
+        uint64_t result = 0;
+
+        if (inst->dest_is_memory) {
+            // Destination is memory
+            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("ADD: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("ADD: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("ADD: Adding value 0x%016" PRIx64 " from source register %s to memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("ADD: Adding immediate value 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+            }
+
+            // Perform the addition
+            result = mem_value + value;
+            LOG_TRACE("ADD: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < mem_value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((mem_value ^ result) & (value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Destination is a register
+            original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("ADD: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("ADD: Adding value 0x%016" PRIx64 " from source register %s to destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("ADD: Adding immediate value 0x%016" PRIx64 " to destination register %s\n", value, inst->dest_reg_name);
+            }
+
+            // Perform the addition
+            result = original_value + value;
+            LOG_TRACE("ADD: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
+
+            // Write the result to the destination register
+            REG_VALUE(emu, inst->dest_reg) = result;
+
+            // Check for overflow
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Addition result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+                return;
+            }
+            // 64-bit can hold all results
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < original_value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((original_value ^ result) & (value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else {
+            fprintf(stderr, "ADD: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed ADD Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
+    }
+    break;
+
+    case INST_SUB:
+    {
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+        uint64_t original_value = 0;
+        uint64_t result = 0;
+
+        if (inst->dest_is_memory) {
+            // Destination is memory
+            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("SUB: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("SUB: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("SUB: Subtracting value 0x%016" PRIx64 " from source register %s from memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("SUB: Subtracting immediate value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+            }
+
+            // Perform the subtraction
+            result = mem_value - value;
+            LOG_TRACE("SUB: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (mem_value < value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((mem_value ^ value) & (mem_value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Destination is a register
+            original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("SUB: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("SUB: Subtracting value 0x%016" PRIx64 " from source register %s from destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("SUB: Subtracting immediate value 0x%016" PRIx64 " from destination register %s\n", value, inst->dest_reg_name);
+            }
+
+            // Perform the subtraction
+            result = original_value - value;
+            LOG_TRACE("SUB: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
+
+            // Write the result to the destination register
+            REG_VALUE(emu, inst->dest_reg) = result;
+
+            // Check for underflow
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Subtraction result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+                return;
+            }
+            // 64-bit can hold all results
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (original_value < value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((original_value ^ value) & (original_value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else {
+            fprintf(stderr, "SUB: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed SUB Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
+    }
+    break;
+
+    case INST_MUL:
+    {
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+        uint64_t original_value = 0;
+        uint64_t result = 0;
+
+        if (inst->dest_is_memory) {
+            // Destination is memory
+            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("MUL: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("MUL: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("MUL: Multiplying value 0x%016" PRIx64 " from source register %s with memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("MUL: Multiplying immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+            }
+
+            // Perform the multiplication
+            result = mem_value * value;
+            LOG_TRACE("MUL: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < mem_value || result < value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = multiply_overflow(mem_value, value, result, 1ULL << 63) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Destination is a register
+            original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("MUL: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("MUL: Multiplying value 0x%016" PRIx64 " from source register %s with destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("MUL: Multiplying immediate value 0x%016" PRIx64 " with destination register %s\n", value, inst->dest_reg_name);
+            }
+
+            // Perform the multiplication
+            result = original_value * value;
+            LOG_TRACE("MUL: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
+
+            // Write the result to the destination register
+            REG_VALUE(emu, inst->dest_reg) = result;
+
+            // Check for overflow
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Multiplication result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+                return;
+            }
+            // 64-bit can hold all results
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < original_value || result < value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = multiply_overflow(original_value, value, result, 1ULL << (size * 8 - 1)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else {
+            fprintf(stderr, "MUL: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed MUL Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
+    }
+    break;
+
+    case INST_DIV:
+    {
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+        uint64_t original_value = 0;
+        uint64_t result = 0;
+
+        if (inst->dest_is_memory) {
+            // Destination is memory
+            uint64_t mem_value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("DIV: Reading value 0x%016" PRIx64 " from destination memory address 0x%016" PRIx64 "\n", mem_value, inst->dest_mem_address);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("DIV: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("DIV: Dividing value 0x%016" PRIx64 " from source register %s with memory address 0x%016" PRIx64 "\n", value, inst->src_reg_name, inst->dest_mem_address);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("DIV: Dividing immediate value 0x%016" PRIx64 " with memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+            }
+
+            // Perform the division, ensuring no divide by zero
+            if (value == 0) {
+                fprintf(stderr, "DIV: Division by zero error\n");
+                exit(EXIT_FAILURE);
+            }
+
+            // Perform the division
+            result = mem_value / value;
+            LOG_TRACE("DIV: Writing result 0x%016" PRIx64 " to destination memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = 0;  // Carry Flag (CF) is not applicable for division
+            emu->flags.overflow = 0;  // Overflow Flag (OF) is not applicable for division
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Destination is a register
+            original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Get the value from the source operand
+            uint64_t value = 0;
+            if (inst->src_is_memory) {
+                value = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+                LOG_TRACE("DIV: Reading value 0x%016" PRIx64 " from source memory address 0x%016" PRIx64 "\n", value, inst->src_mem_address);
+            }
+            else if (REG_PRESENT(inst->src_reg)) {
+                value = REG_VALUE(emu, inst->src_reg);
+                LOG_TRACE("DIV: Dividing value 0x%016" PRIx64 " from source register %s with destination register %s\n", value, inst->src_reg_name, inst->dest_reg_name);
+            }
+            else {
+                value = inst->immediate;
+                LOG_TRACE("DIV: Dividing immediate value 0x%016" PRIx64 " with destination register %s\n", value, inst->dest_reg_name);
+            }
+
+            // Perform the division, ensuring no divide by zero
+            if (value == 0) {
+                fprintf(stderr, "DIV: Division by zero error\n");
+                exit(EXIT_FAILURE);
+            }
+
+            // Perform the division
+            result = original_value / value;
+            LOG_TRACE("DIV: Writing result 0x%016" PRIx64 " to destination register %s\n", result, inst->dest_reg_name);
+
+            // Write the result to the destination register
+            REG_VALUE(emu, inst->dest_reg) = result;
+
+            // Check if result fits in the register size
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Division result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+            }
+            // 64-bit can hold all results
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = 0;  // Carry Flag (CF) is not applicable for division
+            emu->flags.overflow = 0;  // Overflow Flag (OF) is not applicable for division
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else {
+            fprintf(stderr, "DIV: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed DIV Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
+    }
+    break;
+
+    case INST_INC:
+    {
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+        uint64_t original_value = 0;
+        uint64_t result = 0;
+
+        if (inst->dest_is_memory) {
+            // Destination is memory
+            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("INC: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+
+            // Perform the increment
+            result = value + 1;
+            LOG_TRACE("INC: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the incremented result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Destination is a register
+            original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Perform the increment
+            result = original_value + 1;
+            LOG_TRACE("INC: Writing result 0x%016" PRIx64 " to register %s\n", result, inst->dest_reg_name);
+
+            // Write the incremented result to the register
+            REG_VALUE(emu, inst->dest_reg) = result;
+
+            // Check for overflow
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Increment result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+                return;
+            }
+            // 64-bit can hold all results
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (result < original_value) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((original_value ^ result) & (1ULL << (size * 8 - 1))) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else {
+            fprintf(stderr, "INC: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+
+        LOG_TRACE("Executed INC Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, result);
+    }
+    break;
+
+    case INST_DEC:
+    {
+        // Determine if the destination is a register or memory
+        if (inst->dest_is_memory) {
+            // Read the current value from memory
+            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("DEC: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+
+            // Perform the decrement
+            uint64_t result = value - 1;
+            LOG_TRACE("DEC: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the decremented result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (value == 0) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = ((value ^ result) & (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Determine register size
+            const char* dest_name = inst->dest_reg_name;
+            size_t size = inst->dest_reg.width;
+            uint64_t original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Perform the decrement
+            (REG_VALUE(emu, inst->dest_reg))--;
+
+            // Check for underflow (since unsigned, it wraps around)
+            // For simplicity, we'll allow it but notify
+            if (size == 32 && REG_VALUE(emu, inst->dest_reg) > 0xFFFFFFFF) {
+                LOG_WARN("Warning: Decrement result 0x%016" PRIx64 " wrapped around for 32-bit register %s\n", REG_VALUE(emu, inst->dest_reg), dest_name);
+            }
+            // 64-bit can hold all results without wrapping in most practical scenarios
+
+            // Update zero flag
+            emu->flags.zero = (REG_VALUE(emu, inst->dest_reg) == 0);
+
+            // Update sign flag
+            emu->flags.sign = (REG_VALUE(emu, inst->dest_reg) & (1ULL << (size * 8 - 1))) != 0;
+
+            // Update overflow flag
+            emu->flags.overflow = ((original_value ^ REG_VALUE(emu, inst->dest_reg)) & (1ULL << (size * 8 - 1))) != 0;
+
+            // Update parity flag
+            emu->flags.parity = parity_even(REG_VALUE(emu, inst->dest_reg));
+
+            LOG_TRACE("Executed DEC Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, REG_VALUE(emu, inst->dest_reg));
+        }
+        else {
+            fprintf(stderr, "DEC: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    break;
+
+    case INST_NEG:
+    {
+        // Determine if the destination is a register or memory
+        if (inst->dest_is_memory) {
+            // Read the current value from memory
+            uint64_t value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("NEG: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+
+            // Perform the negation
+            uint64_t result = -value;
+            LOG_TRACE("NEG: Writing result 0x%016" PRIx64 " to memory address 0x%016" PRIx64 "\n", result, inst->dest_mem_address);
+
+            // Write the negated result to memory
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+
+            // Set flags
+            emu->flags.zero = (result == 0) ? 1 : 0;  // Zero Flag (ZF)
+            emu->flags.sign = (result & (1ULL << 63)) ? 1 : 0;  // Sign Flag (SF)
+            emu->flags.carry = (value != 0) ? 1 : 0;  // Carry Flag (CF)
+            emu->flags.overflow = (value == (1ULL << 63)) ? 1 : 0;  // Overflow Flag (OF)
+            emu->flags.parity = parity_even(result) ? 1 : 0;  // Parity Flag (PF)
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            // Determine register size
+            const char* dest_name = inst->dest_reg_name;
+            size_t size = inst->dest_reg.width;
+            uint64_t original_value = REG_VALUE(emu, inst->dest_reg);
+
+            // Perform the negation
+            REG_VALUE(emu, inst->dest_reg) = -(REG_VALUE(emu, inst->dest_reg));
+
+            // Check if result fits in the register size
+            if (size == 32 && REG_VALUE(emu, inst->dest_reg) > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: Negation result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", REG_VALUE(emu, inst->dest_reg), dest_name);
+                return;
+            }
+            // 64-bit can hold all results
+
+            // Update zero flag
+            emu->flags.zero = (REG_VALUE(emu, inst->dest_reg) == 0);
+
+            // Update sign flag
+            emu->flags.sign = (REG_VALUE(emu, inst->dest_reg) & (1ULL << (size * 8 - 1))) != 0;
+
+            // Update overflow flag
+            emu->flags.overflow = (original_value == (1ULL << (size * 8 - 1)));
+
+            // Update parity flag
+            emu->flags.parity = parity_even(REG_VALUE(emu, inst->dest_reg));
+
+            // Update carry flag
+            emu->flags.carry = (original_value != 0);
+
+            LOG_TRACE("Executed NEG Instruction: %s = 0x%016" PRIx64 "\n", inst->dest_reg_name, REG_VALUE(emu, inst->dest_reg));
+        }
+        else {
+            fprintf(stderr, "NEG: Invalid instruction format\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    break;
+
+    case INST_CMP:
+        // Handle CMP instruction
+    {
+        // Determine register size
+        size_t size = inst->dest_reg.width;
+
+        uint64_t result;
+        if (REG_PRESENT(inst->src_reg))
+            result = REG_VALUE(emu, inst->dest_reg) - REG_VALUE(emu, inst->src_reg);
+        else
+            result = REG_VALUE(emu, inst->dest_reg) - inst->immediate;
+
+
+        // Update zero flag
+        emu->flags.zero = (result == 0);
+
+        // Update sign flag
+        emu->flags.sign = (result & (1ULL << (size * 8 - 1))) != 0;
+
+        uint64_t operand_value = REG_PRESENT(inst->src_reg) ? REG_VALUE(emu, inst->src_reg) : inst->immediate;
+        // Update carry flag
+        emu->flags.carry = (REG_VALUE(emu, inst->dest_reg) < operand_value);
+
+        // Update overflow flag
+        emu->flags.overflow = ((REG_VALUE(emu, inst->dest_reg) ^ operand_value) & (REG_VALUE(emu, inst->dest_reg) ^ result) & (1ULL << (size * 8 - 1))) != 0;
+
+        // Update parity flag
+        emu->flags.parity = parity_even(result);
+
+        LOG_TRACE("Executed CMP Instruction: Zero Flag = %d, Sign Flag = %d, Carry Flag = %d, Overflow Flag = %d\n",
+            emu->flags.zero, emu->flags.sign, emu->flags.carry, emu->flags.overflow);
+    }
+    break;
+    // Logical Instructions
+    case INST_AND:
+    {
+        uint64_t value1 = 0;
+        uint64_t value2 = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("AND: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value1 = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("AND: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
+        }
+
+        // Get the source operand
+        if (inst->src_is_memory) {
+            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("AND: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            value2 = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("AND: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
+        }
+        else {
+            value2 = inst->immediate;
+            LOG_TRACE("AND: Using immediate value 0x%016" PRIx64 " for AND operation\n", value2);
+        }
+
+        // Perform the bitwise AND
+        uint64_t result = value1 & value2;
+        LOG_TRACE("AND: Result of 0x%016" PRIx64 " AND 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && result > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: AND result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+        }
+        // 64-bit can hold all results
+    }
+    break;
+
+    case INST_OR:
+    {
+        uint64_t value1 = 0;
+        uint64_t value2 = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("OR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value1 = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("OR: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
+        }
+
+        // Get the source operand
+        if (inst->src_is_memory) {
+            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("OR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            value2 = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("OR: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
+        }
+        else {
+            value2 = inst->immediate;
+            LOG_TRACE("OR: Using immediate value 0x%016" PRIx64 " for OR operation\n", value2);
+        }
+
+        // Perform the bitwise OR
+        uint64_t result = value1 | value2;
+        LOG_TRACE("OR: Result of 0x%016" PRIx64 " OR 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && result > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: OR result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+        }
+        // 64-bit can hold all results
+
+        // Update zero flag
+        emu->flags.zero = (result == 0);
+
+        // Update sign flag
+        emu->flags.sign = (result & (1ULL << (size * 8 - 1))) != 0;
+
+        // Update parity flag
+        emu->flags.parity = parity_even(result);
+    }
+    break;
+
+    case INST_XOR:
+    {
+        uint64_t value1 = 0;
+        uint64_t value2 = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value1 = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("XOR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value1, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value1 = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("XOR: Reading value 0x%016" PRIx64 " from register %s\n", value1, inst->dest_reg_name);
+        }
+
+        // Get the source operand
+        if (inst->src_is_memory) {
+            value2 = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("XOR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value2, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            value2 = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("XOR: Reading value 0x%016" PRIx64 " from register %s\n", value2, inst->src_reg_name);
+        }
+        else {
+            value2 = inst->immediate;
+            LOG_TRACE("XOR: Using immediate value 0x%016" PRIx64 " for XOR operation\n", value2);
+        }
+
+        // Perform the bitwise XOR
+        uint64_t result = value1 ^ value2;
+        LOG_TRACE("XOR: Result of 0x%016" PRIx64 " XOR 0x%016" PRIx64 " is 0x%016" PRIx64 "\n", value1, value2, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && result > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: XOR result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+        }
+        // 64-bit can hold all results
+    }
+    break;
+
+    case INST_NOT:
+    {
+        uint64_t value = 0;
+
+        // Get the operand (only one operand for NOT instruction)
+        if (inst->dest_is_memory) {
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("NOT: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("NOT: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
+        }
+
+        // Perform the bitwise NOT (invert all bits)
+        uint64_t result = ~value;
+        LOG_TRACE("NOT: Inverted value 0x%016" PRIx64 " to 0x%016" PRIx64 "\n", value, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+
+        // Determine register size
+        const char* dest_name = inst->dest_reg_name;
+        size_t size = inst->dest_reg.width;
+
+        // Ensure the result fits in the register size
+        if (size == 32 && result > 0xFFFFFFFF) {
+            fprintf(stderr, "Error: NOT result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+        }
+        // 64-bit can hold all results
+    }
+    break;
+
+    // Shift and Rotate Instructions
+    case INST_SHL:
+    {
+        uint64_t value = 0;
+        uint64_t shift_count = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("SHL: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("SHL: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
+        }
+
+        // Get the shift count (immediate or register value)
+        if (inst->src_is_memory) {
+            shift_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("SHL: Reading shift count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", shift_count, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            shift_count = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("SHL: Reading shift count 0x%016" PRIx64 " from register %s\n", shift_count, inst->src_reg_name);
+        }
+        else {
+            shift_count = inst->immediate;
+            LOG_TRACE("SHL: Using immediate shift count 0x%016" PRIx64 "\n", shift_count);
+        }
+
+        // Perform the left shift
+        uint64_t result = value << shift_count;
+        LOG_TRACE("SHL: Shifted value 0x%016" PRIx64 " left by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, shift_count, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+
+        // Determine register size for overflow check
+        if (REG_PRESENT(inst->dest_reg)) {
+            const char* dest_name = inst->dest_reg_name;
+            size_t size = inst->dest_reg.width;
+
+            // Check for overflow by ensuring the value fits in the register size
+            if (size == 32 && result > 0xFFFFFFFF) {
+                fprintf(stderr, "Error: SHL result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n", result, dest_name);
+            }
+        }
+    }
+    break;
+
+    case INST_SHR:
+    {
+        uint64_t value = 0;
+        uint64_t shift_count = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("SHR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("SHR: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
+        }
+
+        // Get the shift count (immediate or register value)
+        if (inst->src_is_memory) {
+            shift_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("SHR: Reading shift count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", shift_count, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            shift_count = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("SHR: Reading shift count 0x%016" PRIx64 " from register %s\n", shift_count, inst->src_reg_name);
+        }
+        else {
+            shift_count = inst->immediate;
+            LOG_TRACE("SHR: Using immediate shift count 0x%016" PRIx64 "\n", shift_count);
+        }
+
+        // Perform the right shift
+        uint64_t result = value >> shift_count;
+        LOG_TRACE("SHR: Shifted value 0x%016" PRIx64 " right by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, shift_count, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+    }
+    break;
+
+    case INST_ROL:
+    {
+        uint64_t value = 0;
+        uint64_t rotate_count = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("ROL: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("ROL: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
+        }
+
+        // Get the rotate count (immediate or register value)
+        if (inst->src_is_memory) {
+            rotate_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("ROL: Reading rotate count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", rotate_count, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            rotate_count = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("ROL: Reading rotate count 0x%016" PRIx64 " from register %s\n", rotate_count, inst->src_reg_name);
+        }
+        else {
+            rotate_count = inst->immediate;
+            LOG_TRACE("ROL: Using immediate rotate count 0x%016" PRIx64 "\n", rotate_count);
+        }
+
+        // Perform the left rotate
+        uint64_t result = (value << rotate_count) | (value >> (64 - rotate_count));
+        LOG_TRACE("ROL: Rotated value 0x%016" PRIx64 " left by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, rotate_count, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+    }
+    break;
+
+    case INST_ROR:
+    {
+        uint64_t value = 0;
+        uint64_t rotate_count = 0;
+
+        // Get the destination operand
+        if (inst->dest_is_memory) {
+            value = read_memory(emu, inst->dest_mem_address, sizeof(uint64_t));
+            LOG_TRACE("ROR: Reading value 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", value, inst->dest_mem_address);
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            value = REG_VALUE(emu, inst->dest_reg);
+            LOG_TRACE("ROR: Reading value 0x%016" PRIx64 " from register %s\n", value, inst->dest_reg_name);
+        }
+
+        // Get the rotate count (immediate or register value)
+        if (inst->src_is_memory) {
+            rotate_count = read_memory(emu, inst->src_mem_address, sizeof(uint64_t));
+            LOG_TRACE("ROR: Reading rotate count 0x%016" PRIx64 " from memory address 0x%016" PRIx64 "\n", rotate_count, inst->src_mem_address);
+        }
+        else if (REG_PRESENT(inst->src_reg)) {
+            rotate_count = REG_VALUE(emu, inst->src_reg);
+            LOG_TRACE("ROR: Reading rotate count 0x%016" PRIx64 " from register %s\n", rotate_count, inst->src_reg_name);
+        }
+        else {
+            rotate_count = inst->immediate;
+            LOG_TRACE("ROR: Using immediate rotate count 0x%016" PRIx64 "\n", rotate_count);
+        }
+
+        // Perform the right rotate
+        uint64_t result = (value >> rotate_count) | (value << (64 - rotate_count));
+        LOG_TRACE("ROR: Rotated value 0x%016" PRIx64 " right by 0x%016" PRIx64 " positions, result is 0x%016" PRIx64 "\n", value, rotate_count, result);
+
+        // Store the result in the destination (register or memory)
+        if (inst->dest_is_memory) {
+            write_memory(emu, inst->dest_mem_address, result, sizeof(uint64_t));
+        }
+        else if (REG_PRESENT(inst->dest_reg)) {
+            REG_VALUE(emu, inst->dest_reg) = result;
+        }
+    }
+    break;
+
+    // Control Flow Instructions (targets are resolved by link_program before execution)
+    case INST_JMP:
+    case INST_JE:
+    case INST_JNE:
+    case INST_JG:
+    case INST_JGE:
+    case INST_JL:
+    case INST_JLE:
+    case INST_JA:
+    case INST_JAE:
+    case INST_JB:
+    case INST_JBE:
+    case INST_JO:
+    case INST_JNO:
+    case INST_JS:
+    case INST_JNS:
+    case INST_JP:
+    case INST_JNP: {
+        const char* name = opcode_table[inst->type].mnemonic;
+
+        // Jumps set rip themselves: the target when taken, the next instruction otherwise
+        if (jump_condition_met(emu, inst->type)) {
+            LOG_TRACE("%s to label: %s\n", name, inst->label);
+            emu->rip = inst->target_address;
+        }
+        else {
+            LOG_TRACE("%s condition not met, continuing execution\n", name);
+            emu->rip = inst_num + 1;
+        }
+        break;
+    }
+        // Custom Instructions
+    case INST_POW:
+        execute_pow_instruction(emu, inst);
+        break;
+
+    case INST_ROOT:
+        execute_root_instruction(emu, inst);
+        break;
+
+    case INST_AVG:
+        execute_avg_instruction(emu, inst);
+        break;
+
+    case INST_MAX:
+        execute_max_instruction(emu, inst);
+        break;
+
+    case INST_MIN:
+        execute_min_instruction(emu, inst);
+        break;
+
+    case INST_MOD:
+        execute_mod_instruction(emu, inst);
+        break;
+
+    case INST_ISPRIME:
+        execute_isprime_instruction(emu, inst);
+        break;
+
+    case INST_MIRROR:
+        execute_mirror_instruction(emu, inst);
+        break;
+
+    case INST_NOP:
+        LOG_TRACE("Executed NOP Instruction: No operation performed\n");
+        break;
+
+    case INST_MOVSB:
+    case INST_MOVSQ:
+    case INST_STOSB:
+    case INST_STOSQ:
+    case INST_CMPSB:
+    case INST_SCASB:
+        execute_string_instruction(emu, inst);
+        break;
+
+    case INST_MOVDQU:
+    case INST_MOVQ:
+    case INST_PADDQ:
+    case INST_PSUBQ:
+    case INST_PAND:
+    case INST_POR:
+    case INST_PXOR:
+    case INST_PCMPEQB:
+    case INST_PCMPEQQ:
+    case INST_PMINUB:
+    case INST_PMAXUB:
+        execute_vector_instruction(emu, inst);
+        break;
+
+    case INST_CLD:
+    case INST_STD:
+        emu->flags.direction = (inst->type == INST_STD);
+        LOG_TRACE("Executed %s Instruction: Direction Flag = %d\n", opcode_table[inst->type].mnemonic, emu->flags.direction);
+        break;
+
+    case INST_LABEL:
+        // Labels are handled during parsing; no action needed during execution
+        break;
+
+    case INST_COMMENT:
+        // Comments are ignored in execution
+        break;
+
+    default:
+        fprintf(stderr, "Unknown instruction type\n");
+    }
+
+    if (tracing_enabled) {
+        // Print registers after execution
+        print_emulator_state(emu, "After Execution");
+    }
+}
+
+
+// Function to read a monotonic host clock in seconds
+double host_time_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+// Function to print execution statistics
+void print_execution_stats(Emulator* emu) {
+    double seconds = emu->stats.execution_seconds;
+    double mips = seconds > 0.0 ? (double)emu->stats.instructions_executed / seconds / 1e6 : 0.0;
+
+    printf("\n=== Execution Statistics ===\n");
+    printf("Instructions executed: %" PRIu64 "\n", emu->stats.instructions_executed);
+    printf("Blocks executed:       %" PRIu64 "\n", emu->stats.blocks_executed);
+    printf("Tier thresholds:       optimize at %" PRIu64 " entries, ", optimize_threshold);
+    if (jit_enabled) {
+        printf("JIT at %" PRIu64 " entries\n", jit_threshold);
+    }
+    else {
+        printf("JIT off\n");
+    }
+    printf("Vector kernels:        %s\n", vector_isa_names[active_vector_isa]);
+    printf("Blocks optimized:      %" PRIu64 "\n", emu->stats.blocks_optimized);
+    printf("Blocks JIT-compiled:   %" PRIu64 "\n", emu->stats.jit_blocks_compiled);
+    printf("TLB hits / misses:     %" PRIu64 " / %" PRIu64 "\n", emu->stats.tlb_hits, emu->stats.tlb_misses);
+    printf("Memory pages touched:  %zu (%zu KiB of a %" PRIu64 " KiB address space)\n",
+        emu->memory.pages_allocated, emu->memory.pages_allocated << (PAGE_SHIFT - 10), (uint64_t)emu->memory_size >> 10);
+    printf("Dirty pages:           %zu since the last checkpoint\n", emu->memory.dirty_count);
+    printf("Execution time:        %.6f s\n", seconds);
+    printf("Throughput:            %.2f MIPS\n", mips);
+    if (emu->stats.parse_seconds > 0.0) {
+        double parse_seconds = emu->stats.parse_seconds;
+        printf("Source parsed:         %" PRIu64 " lines, %" PRIu64 " bytes in %.6f s (%.0f lines/s, %.1f MB/s)\n",
+            emu->stats.source_lines, emu->stats.source_bytes, parse_seconds,
+            (double)emu->stats.source_lines / parse_seconds, (double)emu->stats.source_bytes / parse_seconds / 1e6);
+    }
+}
+
+// Function to run parsed instructions with the reference (non-decoded) loop
+void run_instruction_loop(Emulator* emu, Instruction* instructions, size_t instruction_count) {
+    uint64_t executed = 0;
+    double start = host_time_seconds();
+
+    emu->rip = 0;
+    while (emu->rip < instruction_count) {
+        if (instruction_limit && executed >= instruction_limit) {
+            fprintf(stderr, "Error: Instruction limit of %" PRIu64 " reached at rip=%" PRIu64 "\n", instruction_limit, emu->rip);
+            break;
+        }
+
+        Instruction* current_inst = &instructions[emu->rip];
+        execute_instruction(emu, current_inst, emu->rip);
+        executed++;
+
+        // Jumps update rip themselves; everything else falls through to the next instruction
+        if (!is_jump_instruction(current_inst->type)) {
+            emu->rip++;
+        }
+    }
+
+    emu->stats.instructions_executed += executed;
+    emu->stats.execution_seconds += host_time_seconds() - start;
+}
+
+// Function to pick the operand-form specialized variant of a generic ALU opcode
+static uint8_t specialize_opcode(uint8_t opcode, uint8_t form) {
+    OperandKind dst_kind = (OperandKind)OP_DST_KIND(form);
+    OperandKind src_kind = (OperandKind)OP_SRC_KIND(form);
+    static const uint8_t binary_base[OP_COUNT] = {
+#define BINARY_FORM_BASE(name, reads, writes, expression, flags) [OP_##name] = OP_##name##_RR,
+        BINARY_OPS(BINARY_FORM_BASE)
+#undef BINARY_FORM_BASE
+    };
+    static const uint8_t unary_base[OP_COUNT] = {
+#define UNARY_FORM_BASE(name, expression, reg_flags, mem_flags) [OP_##name] = OP_##name##_R,
+        UNARY_OPS(UNARY_FORM_BASE)
+#undef UNARY_FORM_BASE
+    };
+
+    int dst_index = dst_kind == OPERAND_REG ? 0 : dst_kind == OPERAND_MEM ? 1 : -1;
+    if (dst_index < 0) {
+        return opcode;
+    }
+    if (binary_base[opcode]) {
+        // Forms are laid out as RR, RI, RM, MR, MI, MM, RX, XR, XI; other register-based forms stay generic
+        int src_index = src_kind == OPERAND_REG ? 0 : src_kind == OPERAND_IMM ? 1 : 2;
+        if (form & OP_FORM_DST_INDIRECT) {
+            return src_index < 2 ? (uint8_t)(binary_base[opcode] + 7 + src_index) : opcode;
+        }
+        if (form & OP_FORM_SRC_INDIRECT) {
+            return dst_index == 0 ? (uint8_t)(binary_base[opcode] + 6) : opcode;
+        }
+        return (uint8_t)(binary_base[opcode] + dst_index * 3 + src_index);
+    }
+    if (unary_base[opcode]) {
+        return (uint8_t)(unary_base[opcode] + ((form & OP_FORM_DST_INDIRECT) ? 2 : dst_index));
+    }
+    return opcode;
+}
+
+// Function to pack a register-based memory operand for a decoded op; false if its displacement needs more than 32 bits
+static bool pack_memory_operand(const MemoryOperand* operand, uint64_t* packed) {
+    if (operand->displacement < INT32_MIN || operand->displacement > INT32_MAX) return false;
+    *packed = (uint64_t)(uint32_t)(int32_t)operand->displacement |
+              ((uint64_t)operand->form << 32) |
+              ((uint64_t)operand->base << 35) |
+              ((uint64_t)operand->index << 39) |
+              ((uint64_t)operand->scale_shift << 43) |
+              ((uint64_t)operand->has_base << 45) |
+              ((uint64_t)operand->has_index << 46);
+    return true;
+}
+
+// Function to lower one parsed instruction into a decoded op.
+// Anything the fast handlers do not cover is decoded as OP_SLOW and runs through execute_instruction.
+static void decode_instruction(const Instruction* inst, size_t index, DecodedOp* op) {
+    memset(op, 0, sizeof(*op));
+    op->index = (uint32_t)index;
+    op->opcode = OP_SLOW;
+
+    // Classify the destination operand
+    OperandKind dst_kind = OPERAND_NONE;
+    if (inst->dest_is_memory) {
+        dst_kind = OPERAND_MEM;
+        op->dst_value = inst->dest_mem_address;
+    }
+    else if (REG_PRESENT(inst->dest_reg)) {
+        op->dst = inst->dest_reg.index;
+        dst_kind = OPERAND_REG;
+    }
+
+    // Classify the source operand (same precedence as execute_instruction)
+    OperandKind src_kind = OPERAND_IMM;
+    op->src_value = inst->immediate;
+    if (inst->src_is_memory) {
+        src_kind = OPERAND_MEM;
+        op->src_value = inst->src_mem_address;
+    }
+    else if (REG_PRESENT(inst->src_reg)) {
+        op->src = inst->src_reg.index;
+        src_kind = OPERAND_REG;
+    }
+
+    bool narrow = false;
+
+    switch (inst->type) {
+    case INST_NOP:
+        op->opcode = OP_NOP;
+        return;
+
+    case INST_MOVDQU: case INST_MOVQ: case INST_PADDQ: case INST_PSUBQ: case INST_PAND: case INST_POR:
+    case INST_PXOR: case INST_PCMPEQB: case INST_PCMPEQQ: case INST_PMINUB: case INST_PMAXUB:
+        // Vector instructions leave the flags alone, so none of them needs OP_SLOW's flag materialization.
+        // Packed ops and MOVDQU get direct handlers: dst/src are vector registers, form the width in bytes,
+        // dst_value the kernel index or the packed store address and src_value the packed load address.
+        op->opcode = OP_VECTOR;
+        if (inst->type == INST_MOVQ) return;
+        op->dst = inst->vector_dest;
+        op->src = inst->vector_src;
+        op->form = inst->vector_bytes;
+        if (inst->type == INST_MOVDQU) {
+            if (inst->dest_is_memory) {
+                if (pack_memory_operand(&inst->dest_address, &op->dst_value)) op->opcode = OP_VSTORE;
+            }
+            else if (inst->src_is_memory) {
+                if (pack_memory_operand(&inst->src_address, &op->src_value)) op->opcode = OP_VLOAD;
+            }
+            return;
+        }
+        op->dst_value = inst->type - INST_PADDQ;
+        if (!inst->src_is_memory) {
+            op->opcode = OP_PACKED_V;
+        }
+        else if (pack_memory_operand(&inst->src_address, &op->src_value)) {
+            op->opcode = OP_PACKED_X;
+        }
+        return;
+
+    case INST_MOV:
+        if (dst_kind == OPERAND_NONE) return;
+        if (inst->src_is_string) {
+            if (dst_kind == OPERAND_MEM) return;  // String stores stay on the slow path
+            src_kind = OPERAND_IMM;
+            op->src_value = (uint64_t)inst->src_string[0];
+        }
+        op->opcode = OP_MOV;
+        break;
+
+    case INST_ADD:
+    case INST_SUB:
+    case INST_MUL:
+    case INST_DIV:
+    case INST_SHL:
+        if (dst_kind == OPERAND_NONE) return;
+        narrow = (dst_kind == OPERAND_REG && inst->dest_reg.width == 32);
+        op->opcode = inst->type == INST_ADD ? OP_ADD :
+                     inst->type == INST_SUB ? OP_SUB :
+                     inst->type == INST_MUL ? OP_MUL :
+                     inst->type == INST_DIV ? OP_DIV : OP_SHL;
+        break;
+
+    case INST_SHR:
+    case INST_ROL:
+    case INST_ROR:
+        if (dst_kind == OPERAND_NONE) return;
+        op->opcode = inst->type == INST_SHR ? OP_SHR : inst->type == INST_ROL ? OP_ROL : OP_ROR;
+        break;
+
+    case INST_INC:
+    case INST_DEC:
+    case INST_NEG:
+        if (dst_kind == OPERAND_NONE) return;
+        narrow = (dst_kind == OPERAND_REG && inst->dest_reg.width == 32);
+        src_kind = OPERAND_NONE;
+        op->opcode = inst->type == INST_INC ? OP_INC : inst->type == INST_DEC ? OP_DEC : OP_NEG;
+        break;
+
+    case INST_AND:
+    case INST_OR:
+    case INST_XOR:
+    case INST_NOT:
+        if (dst_kind == OPERAND_NONE) return;
+        narrow = (inst->dest_reg.width == 32);
+        if (inst->type == INST_NOT) src_kind = OPERAND_NONE;
+        op->opcode = inst->type == INST_AND ? OP_AND :
+                     inst->type == INST_OR ? OP_OR :
+                     inst->type == INST_XOR ? OP_XOR : OP_NOT;
+        break;
+
+    case INST_CMP:
+        // CMP only compares a register against a register or an immediate
+        if (dst_kind != OPERAND_REG) return;
+        if (src_kind == OPERAND_MEM) {
+            src_kind = OPERAND_IMM;
+            op->src_value = inst->immediate;
+        }
+        op->opcode = OP_CMP;
+        break;
+
+    case INST_PUSH:
+    case INST_POP:
+        // A 32-bit POP destination keeps the slow path for its size check
+        if (dst_kind == OPERAND_NONE) return;
+        if (inst->type == INST_POP && dst_kind == OPERAND_REG && inst->dest_reg.width == 32) return;
+        src_kind = OPERAND_NONE;
+        op->opcode = inst->type == INST_PUSH ? OP_PUSH : OP_POP;
+        break;
+
+    case INST_JMP: case INST_JE: case INST_JNE: case INST_JG: case INST_JGE:
+    case INST_JL: case INST_JLE: case INST_JA: case INST_JAE: case INST_JB:
+    case INST_JBE: case INST_JO: case INST_JNO: case INST_JS: case INST_JNS:
+    case INST_JP: case INST_JNP: {
+        // Targets were resolved by link_program
+        dst_kind = OPERAND_NONE;
+        src_kind = OPERAND_IMM;
+        op->src_value = inst->target_address;
+        op->opcode = (uint8_t)(OP_JMP + (inst->type - INST_JMP));
+        break;
+    }
+
+    default:
+        return;
+    }
+
+    // Register-based addresses are computed per execution from their packed form
+    uint8_t indirect = 0;
+    if (dst_kind == OPERAND_MEM && inst->dest_address.form != ADDRESS_ABSOLUTE) {
+        if (!pack_memory_operand(&inst->dest_address, &op->dst_value)) {
+            op->opcode = OP_SLOW;
+            return;
+        }
+        indirect |= OP_FORM_DST_INDIRECT;
+    }
+    if (src_kind == OPERAND_MEM && inst->src_address.form != ADDRESS_ABSOLUTE) {
+        if (!pack_memory_operand(&inst->src_address, &op->src_value)) {
+            op->opcode = OP_SLOW;
+            return;
+        }
+        indirect |= OP_FORM_SRC_INDIRECT;
+    }
+
+    op->form = OP_FORM(dst_kind, src_kind) | (narrow ? OP_FORM_NARROW : 0) | indirect;
+}
+
+// Function to check whether a decoded op closes its basic block
+static bool decoded_op_ends_block(const DecodedOp* op) {
+    return (op->opcode >= OP_JMP && op->opcode <= OP_JNP) || op->opcode >= OP_FIRST_FUSED;
+}
+
+// Function to move a block to the optimized tier: generic ALU ops get their operand-form
+// specialized handlers and a CMP/DEC directly before the closing jump is fused with it.
+// The jump op stays in place; the fused op closes the block and the jump is never dispatched.
+static void optimize_decoded_block(DecodedProgram* program, const DecodedBlock* block) {
+    static const uint8_t fused_cmp_rr[OP_COUNT] = {
+#define FUSED_CMP_RR_ENTRY(jump, condition) [OP_##jump] = OP_CMP_RR_##jump,
+        FUSED_RESULT_CONDITIONS(FUSED_CMP_RR_ENTRY)
+        FUSED_OVERFLOW_CONDITIONS(FUSED_CMP_RR_ENTRY)
+        FUSED_CARRY_CONDITIONS(FUSED_CMP_RR_ENTRY)
+#undef FUSED_CMP_RR_ENTRY
+    };
+    static const uint8_t fused_cmp_ri[OP_COUNT] = {
+#define FUSED_CMP_RI_ENTRY(jump, condition) [OP_##jump] = OP_CMP_RI_##jump,
+        FUSED_RESULT_CONDITIONS(FUSED_CMP_RI_ENTRY)
+        FUSED_OVERFLOW_CONDITIONS(FUSED_CMP_RI_ENTRY)
+        FUSED_CARRY_CONDITIONS(FUSED_CMP_RI_ENTRY)
+#undef FUSED_CMP_RI_ENTRY
+    };
+    static const uint8_t fused_dec_r[OP_COUNT] = {
+#define FUSED_DEC_R_ENTRY(jump, condition) [OP_##jump] = OP_DEC_R_##jump,
+        FUSED_RESULT_CONDITIONS(FUSED_DEC_R_ENTRY)
+#undef FUSED_DEC_R_ENTRY
+    };
+
+    DecodedOp* first = program->ops + block->first_op;
+    DecodedOp* op = first;
+
+    // 64-bit destinations get the handler specialized for their operand form;
+    // 32-bit destinations keep the generic handler that checks the result width
+    for (; op->opcode != OP_FALLTHROUGH && !decoded_op_ends_block(op); op++) {
+        if (!(op->form & OP_FORM_NARROW)) {
+            op->opcode = specialize_opcode(op->opcode, op->form);
+        }
+    }
+
+    // op is the block terminator; fuse it with the op before it when that pair has a superinstruction
+    if (op == first || op->opcode == OP_FALLTHROUGH) {
+        return;
+    }
+    DecodedOp* compare = op - 1;
+    uint8_t fused = 0;
+    switch (compare->opcode) {
+    case OP_CMP_RR: fused = fused_cmp_rr[op->opcode]; break;
+    case OP_CMP_RI: fused = fused_cmp_ri[op->opcode]; break;
+    case OP_DEC_R:  fused = fused_dec_r[op->opcode]; break;
+    default: break;
+    }
+    if (fused) {
+        compare->opcode = fused;
+        compare->dst_value = op->dst_value;  // Successor blocks
+    }
+}
+
+// Function to decode parsed instructions into basic blocks of compact ops.
+// Block leaders are the first instruction, every label and every instruction after a jump.
+void decode_program(DecodedProgram* program, Instruction* instructions, size_t instruction_count, const SymbolTable* symbols) {
+    DecodedOp* decoded = (DecodedOp*)malloc((instruction_count + 1) * sizeof(DecodedOp));
+    bool* leaders = (bool*)calloc(instruction_count + 1, sizeof(bool));
+    uint32_t* block_of = (uint32_t*)malloc((instruction_count + 1) * sizeof(uint32_t));
+    if (!decoded || !leaders || !block_of) {
+        fprintf(stderr, "Error: Memory allocation failed for decoded program\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < instruction_count; i++) {
+        decode_instruction(&instructions[i], i, &decoded[i]);
+    }
+
+    // Find block leaders
+    leaders[0] = true;
+    for (size_t i = 0; symbols && i < symbols->count; i++) {
+        if (symbols->symbols[i].kind == SYMBOL_CODE && symbols->symbols[i].value <= instruction_count) {
+            leaders[symbols->symbols[i].value] = true;
+        }
+    }
+    for (size_t i = 0; i < instruction_count; i++) {
+        if (is_jump_instruction(instructions[i].type)) {
+            leaders[instructions[i].target_address] = true;
+            leaders[i + 1] = true;
+        }
+    }
+
+    // Count blocks (plus the HALT block) and assign each leader its block index
+    size_t block_count = 0;
+    for (size_t i = 0; i < instruction_count; i++) {
+        if (leaders[i]) {
+            block_of[i] = (uint32_t)block_count++;
+        }
+    }
+    block_of[instruction_count] = (uint32_t)block_count++;
+
+    // Every block gets at most one extra terminator op, plus the final OP_HALT
+    program->ops = (DecodedOp*)malloc((instruction_count + block_count) * sizeof(DecodedOp));
+    program->blocks = (DecodedBlock*)calloc(block_count, sizeof(DecodedBlock));
+    if (!program->ops || !program->blocks) {
+        fprintf(stderr, "Error: Memory allocation failed for decoded program\n");
+        exit(1);
+    }
+
+    // Lay out the ops block by block
+    size_t op_count = 0;
+    size_t i = 0;
+    while (i < instruction_count) {
+        DecodedBlock* block = &program->blocks[block_of[i]];
+        block->first_op = (uint32_t)op_count;
+        block->first = (uint32_t)i;
+
+        size_t end = i;
+        bool closed = false;
+        do {
+            program->ops[op_count++] = decoded[end];
+            closed = decoded_op_ends_block(&decoded[end]);
+            end++;
+        } while (!closed && end < instruction_count && !leaders[end]);
+
+        if (closed) {
+            block->taken = block_of[instructions[end - 1].target_address];
+            block->fallthrough = block_of[end];
+        }
+        else {
+            // Straight-line block: close it with an explicit fall-through op
+            DecodedOp* terminator = &program->ops[op_count++];
+            memset(terminator, 0, sizeof(*terminator));
+            terminator->opcode = OP_FALLTHROUGH;
+            terminator->index = (uint32_t)end;
+            block->taken = block->fallthrough = block_of[end];
+        }
+        block->count = (uint32_t)(end - i);
+
+        // Cache the successors in the closing op so branches do not reload the block
+        program->ops[op_count - 1].dst_value = block->taken | ((uint64_t)block->fallthrough << 32);
+        i = end;
+    }
+
+    // Terminate the program with an empty HALT block
+    DecodedBlock* halt_block = &program->blocks[block_count - 1];
+    halt_block->first_op = (uint32_t)op_count;
+    halt_block->first = (uint32_t)instruction_count;
+    halt_block->taken = halt_block->fallthrough = (uint32_t)(block_count - 1);
+    memset(&program->ops[op_count], 0, sizeof(DecodedOp));
+    program->ops[op_count].opcode = OP_HALT;
+    program->ops[op_count].index = (uint32_t)instruction_count;
+    op_count++;
+
+    program->op_count = op_count;
+    program->block_count = block_count;
+    program->threaded = false;
+    program->instructions = instructions;
+    program->instruction_count = instruction_count;
+    program->jit_code = NULL;
+    program->jit_used = 0;
+
+    free(decoded);
+    free(leaders);
+    free(block_of);
+}
+
+// Function to free a decoded program
+void free_decoded_program(DecodedProgram* program) {
+    free(program->ops);
+    free(program->blocks);
+#ifdef JIT_SUPPORTED
+    jit_release(program);
+#endif
+    program->ops = NULL;
+    program->blocks = NULL;
+    program->op_count = 0;
+    program->block_count = 0;
+}
+
+// Function to compute the address of a packed address form (see PACKED_ADDRESS_FORM)
+static inline uint64_t packed_address(const Emulator* emu, uint64_t packed) {
+    const uint64_t* registers = emu->registers;
+    uint64_t displacement = (uint64_t)(int64_t)(int32_t)packed;
+    switch (PACKED_ADDRESS_FORM(packed)) {
+    case ADDRESS_BASE:
+        return registers[PACKED_ADDRESS_BASE(packed)];
+    case ADDRESS_BASE_DISP:
+        return registers[PACKED_ADDRESS_BASE(packed)] + displacement;
+    case ADDRESS_BASE_INDEX8:
+        return registers[PACKED_ADDRESS_BASE(packed)] + (registers[PACKED_ADDRESS_INDEX(packed)] << 3);
+    default:
+        return (PACKED_ADDRESS_HAS_BASE(packed) ? registers[PACKED_ADDRESS_BASE(packed)] : 0) +
+               (PACKED_ADDRESS_HAS_INDEX(packed) ? registers[PACKED_ADDRESS_INDEX(packed)] << PACKED_ADDRESS_SHIFT(packed) : 0) +
+               displacement;
+    }
+}
+
+// Memory operand addresses of a decoded op
+#define DECODED_DST_ADDRESS(emu, op) \
+    (((op)->form & OP_FORM_DST_INDIRECT) ? packed_address((emu), (op)->dst_value) : (op)->dst_value)
+#define DECODED_SRC_ADDRESS(emu, op) \
+    (((op)->form & OP_FORM_SRC_INDIRECT) ? packed_address((emu), (op)->src_value) : (op)->src_value)
+
+// Function to read the destination operand of a decoded op
+static inline uint64_t decoded_destination(Emulator* emu, const DecodedOp* op) {
+    if (OP_DST_KIND(op->form) == OPERAND_MEM) {
+        return read_memory(emu, DECODED_DST_ADDRESS(emu, op), sizeof(uint64_t));
+    }
+    return emu->registers[op->dst];
+}
+
+// Function to read the source operand of a decoded op
+static inline uint64_t decoded_source(Emulator* emu, const DecodedOp* op) {
+    switch (OP_SRC_KIND(op->form)) {
+    case OPERAND_REG:
+        return emu->registers[op->src];
+    case OPERAND_MEM:
+        return read_memory(emu, DECODED_SRC_ADDRESS(emu, op), sizeof(uint64_t));
+    default:
+        return op->src_value;
+    }
+}
+
+// Function to write the destination operand of a decoded op
+static inline void decoded_store(Emulator* emu, const DecodedOp* op, uint64_t value) {
+    if (OP_DST_KIND(op->form) == OPERAND_MEM) {
+        write_memory(emu, DECODED_DST_ADDRESS(emu, op), value, sizeof(uint64_t));
+    }
+    else {
+        emu->registers[op->dst] = value;
+    }
+}
+
+// Function to report a result that does not fit a 32-bit destination register
+static bool decoded_narrow_overflow(const DecodedProgram* program, const DecodedOp* op, uint64_t result, const char* operation) {
+    if (!(op->form & OP_FORM_NARROW) || result <= 0xFFFFFFFF) {
+        return false;
+    }
+    fprintf(stderr, "Error: %s result 0x%016" PRIx64 " exceeds 32-bit register size for %s\n",
+        operation, result, program->instructions[op->index].dest_reg_name);
+    return true;
+}
+
+// Functions to derive individual flags from the last recorded operation
+static inline bool lazy_zero(const Emulator* emu) {
+    return emu->lazy_flags.op == FLAGS_VALID ? emu->flags.zero : emu->lazy_flags.result == 0;
+}
+
+static inline bool lazy_sign(const Emulator* emu) {
+    return emu->lazy_flags.op == FLAGS_VALID ? emu->flags.sign : (emu->lazy_flags.result >> 63) & 1;
+}
+
+static inline bool lazy_parity(const Emulator* emu) {
+    return emu->lazy_flags.op == FLAGS_VALID ? emu->flags.parity : parity_even(emu->lazy_flags.result);
+}
+
+static inline bool lazy_carry(const Emulator* emu) {
+    const LazyFlags* lf = &emu->lazy_flags;
+    switch (lf->op) {
+    case FLAGS_ADD: return lf->result < lf->a;
+    case FLAGS_SUB: return lf->a < lf->b;
+    case FLAGS_MUL: return lf->result < lf->a || lf->result < lf->b;
+    case FLAGS_DIV: return false;
+    case FLAGS_INC: return lf->result < lf->a;
+    case FLAGS_DEC: return lf->a == 0;
+    case FLAGS_DEC_REG: return lf->b != 0;
+    case FLAGS_NEG: return lf->a != 0;
+    default:        return emu->flags.carry;
+    }
+}
+
+static inline bool lazy_overflow(const Emulator* emu) {
+    const LazyFlags* lf = &emu->lazy_flags;
+    switch (lf->op) {
+    case FLAGS_ADD: return (((lf->a ^ lf->result) & (lf->b ^ lf->result)) >> 63) & 1;
+    case FLAGS_SUB: return (((lf->a ^ lf->b) & (lf->a ^ lf->result)) >> 63) & 1;
+    case FLAGS_MUL: return multiply_overflow(lf->a, lf->b, lf->result, 1ULL << 63);
+    case FLAGS_DIV: return false;
+    case FLAGS_INC:
+    case FLAGS_DEC:
+    case FLAGS_DEC_REG: return ((lf->a ^ lf->result) >> 63) & 1;
+    case FLAGS_NEG: return lf->a == (1ULL << 63);
+    default:        return emu->flags.overflow;
+    }
+}
+
+// Function to write pending lazy flags back into emu->flags
+void materialize_flags(Emulator* emu) {
+    if (emu->lazy_flags.op == FLAGS_VALID) {
+        return;
+    }
+    emu->flags.zero = lazy_zero(emu);
+    emu->flags.sign = lazy_sign(emu);
+    emu->flags.carry = lazy_carry(emu);
+    emu->flags.overflow = lazy_overflow(emu);
+    emu->flags.parity = lazy_parity(emu);
+    emu->lazy_flags.op = FLAGS_VALID;
+}
+
+// Function to record a flag-producing operation instead of computing its flags
+static inline void record_flags(Emulator* emu, LazyFlagsOp op, uint64_t a, uint64_t b, uint64_t result) {
+    emu->lazy_flags.op = (uint8_t)op;
+    emu->lazy_flags.a = a;
+    emu->lazy_flags.b = b;
+    emu->lazy_flags.result = result;
+#if !LAZY_FLAGS
+    materialize_flags(emu);
+#endif
+}
+
+// Function to apply the ZF/SF/PF update of OR (other flags are left untouched)
+static inline void set_logic_flags(Emulator* emu, uint64_t result) {
+    materialize_flags(emu);
+    emu->flags.zero = (result == 0);
+    emu->flags.sign = (result >> 63) & 1;
+    emu->flags.parity = parity_even(result);
+}
+
+// Function to divide for a decoded op, aborting on division by zero
+static inline uint64_t decoded_divide(const DecodedOp* op, uint64_t dividend, uint64_t divisor) {
+    if (divisor == 0) {
+        fprintf(stderr, "Error: Division by zero at instruction %u\n", op->index);
+        exit(1);
+    }
+    return dividend / divisor;
+}
+
+// Functions to rotate a 64-bit value (count taken modulo 64)
+static inline uint64_t rotate_left(uint64_t value, uint64_t count) {
+    count &= 63;
+    return count ? (value << count) | (value >> (64 - count)) : value;
+}
+
+static inline uint64_t rotate_right(uint64_t value, uint64_t count) {
+    count &= 63;
+    return count ? (value >> count) | (value << (64 - count)) : value;
+}
+
+// x86-64 JIT for hot basic blocks.
+// A block is compiled only when every op is a 64-bit register/immediate MOV, ADD, SUB, AND, OR,
+// XOR, SHL, SHR or CMP closed by a jump, a fused CMP/Jcc or a fall-through; other blocks
+// (custom ops, INT, memory operands, 32-bit destinations) keep running in the interpreter,
+// which hands them to execute_instruction. Emulated registers stay in emu->registers.
+#ifdef JIT_SUPPORTED
+
+// Code buffer being filled for one block
+typedef struct {
+    uint8_t* code;
+    size_t length;
+} JitEmitter;
+
+// Scratch registers of the generated code (rbx = emu, r12 = iterations left, r13 = iterations pointer)
+enum { JIT_RAX = 0, JIT_RDX = 2 };
+
+// Worst-case bytes emitted per op, used to check the buffer before compiling a block
+#define JIT_MAX_OP_BYTES 96
+
+// Host condition codes (the low nibble of Jcc) indexed by OP_JMP..OP_JNP
+static const uint8_t jit_condition_codes[] = {
+    0x0,  // JMP (unused)
+    0x4,  // JE
+    0x5,  // JNE
+    0xF,  // JG
+    0xD,  // JGE
+    0xC,  // JL
+    0xE,  // JLE
+    0x7,  // JA
+    0x3,  // JAE
+    0x2,  // JB
+    0x6,  // JBE
+    0x0,  // JO
+    0x1,  // JNO
+    0x8,  // JS
+    0x9,  // JNS
+    0xA,  // JP
+    0xB   // JNP
+};
+
+typedef char jit_condition_count_check[(sizeof(jit_condition_codes) == OP_JNP - OP_JMP + 1) ? 1 : -1];
+
+// Functions to append raw bytes to the code buffer
+static void jit_emit_byte(JitEmitter* jit, uint8_t byte) {
+    jit->code[jit->length++] = byte;
+}
+
+static void jit_emit_u32(JitEmitter* jit, uint32_t value) {
+    memcpy(jit->code + jit->length, &value, sizeof(value));
+    jit->length += sizeof(value);
+}
+
+static void jit_emit_u64(JitEmitter* jit, uint64_t value) {
+    memcpy(jit->code + jit->length, &value, sizeof(value));
+    jit->length += sizeof(value);
+}
+
+// Function to emit a REX.W instruction with a [rbx + disp32] operand
+static void jit_emit_emu_operand(JitEmitter* jit, uint8_t opcode, uint8_t reg, size_t offset) {
+    jit_emit_byte(jit, 0x48);
+    jit_emit_byte(jit, opcode);
+    jit_emit_byte(jit, (uint8_t)(0x80 | (reg << 3) | 3));
+    jit_emit_u32(jit, (uint32_t)offset);
+}
+
+// Function to emit mov reg, imm64
+static void jit_emit_mov_imm(JitEmitter* jit, uint8_t reg, uint64_t value) {
+    jit_emit_byte(jit, 0x48);
+    jit_emit_byte(jit, (uint8_t)(0xB8 + reg));
+    jit_emit_u64(jit, value);
+}
+
+// Function to emit Jcc rel32 (or JMP rel32 when condition is negative) and return the offset to patch
+static size_t jit_emit_jump(JitEmitter* jit, int condition) {
+    if (condition < 0) {
+        jit_emit_byte(jit, 0xE9);
+    }
+    else {
+        jit_emit_byte(jit, 0x0F);
+        jit_emit_byte(jit, (uint8_t)(0x80 | condition));
+    }
+    jit_emit_u32(jit, 0);
+    return jit->length - 4;
+}
+
+// Function to point a rel32 emitted by jit_emit_jump at the current position
+static void jit_patch_jump(JitEmitter* jit, size_t patch) {
+    uint32_t rel = (uint32_t)(jit->length - (patch + 4));
+    memcpy(jit->code + patch, &rel, sizeof(rel));
+}
+
+// Byte offsets of emulator fields addressed by the generated code
+#define JIT_REGISTER_OFFSET(index) (offsetof(Emulator, registers) + (size_t)(index) * sizeof(uint64_t))
+#define JIT_LAZY_OFFSET(field) (offsetof(Emulator, lazy_flags) + offsetof(LazyFlags, field))
+
+// Function to load the source operand of a decoded op into rdx
+static void jit_emit_load_source(JitEmitter* jit, const DecodedOp* op) {
+    if (OP_SRC_KIND(op->form) == OPERAND_REG) {
+        jit_emit_emu_operand(jit, 0x8B, JIT_RDX, JIT_REGISTER_OFFSET(op->src));
+    }
+    else {
+        jit_emit_mov_imm(jit, JIT_RDX, op->src_value);
+    }
+}
+
+// Function to emit a call to a C helper taking (emu, value in rax)
+static void jit_emit_helper_call(JitEmitter* jit, const void* helper) {
+#ifdef _WIN32
+    static const uint8_t move_arguments[] = { 0x48, 0x89, 0xD9, 0x48, 0x89, 0xC2 };  // mov rcx, rbx; mov rdx, rax
+#else
+    static const uint8_t move_arguments[] = { 0x48, 0x89, 0xDF, 0x48, 0x89, 0xC6 };  // mov rdi, rbx; mov rsi, rax
+#endif
+    memcpy(jit->code + jit->length, move_arguments, sizeof(move_arguments));
+    jit->length += sizeof(move_arguments);
+    jit_emit_mov_imm(jit, JIT_RAX, (uint64_t)(uintptr_t)helper);
+    jit_emit_byte(jit, 0xFF);  // call rax
+    jit_emit_byte(jit, 0xD0);
+}
+
+// Function to emit the epilogue returning block index target in eax
+static void jit_emit_return(JitEmitter* jit, uint32_t target) {
+    static const uint8_t epilogue[] = {
+        0x4D, 0x89, 0x65, 0x00,     // mov [r13], r12
+#ifdef _WIN32
+        0x48, 0x83, 0xC4, 0x20,     // add rsp, 32
+#endif
+        0x41, 0x5D,                 // pop r13
+        0x41, 0x5C,                 // pop r12
+        0x5B,                       // pop rbx
+        0xC3                        // ret
+    };
+    jit_emit_byte(jit, 0xB8);       // mov eax, target
+    jit_emit_u32(jit, target);
+    memcpy(jit->code + jit->length, epilogue, sizeof(epilogue));
+    jit->length += sizeof(epilogue);
+}
+
+// Function to leave a block towards target; a jump back to the block itself loops in native code
+static void jit_emit_exit(JitEmitter* jit, uint32_t target, uint32_t self, size_t body) {
+    if (target == self) {
+        static const uint8_t next_iteration[] = {
+            0x4D, 0x85, 0xE4,               // test r12, r12
+            0x0F, 0x84, 8, 0, 0, 0,         // jz +8 (out of iterations)
+            0x49, 0xFF, 0xCC                // dec r12
+        };
+        memcpy(jit->code + jit->length, next_iteration, sizeof(next_iteration));
+        jit->length += sizeof(next_iteration);
+        jit_emit_byte(jit, 0xE9);           // jmp body
+        jit_emit_u32(jit, (uint32_t)(body - (jit->length + 4)));
+    }
+    jit_emit_return(jit, target);
+}
+
+// Helpers called from generated code for the rarer flag paths
+static void jit_logic_flags(Emulator* emu, uint64_t result) {
+    set_logic_flags(emu, result);
+}
+
+static bool jit_jump_taken(Emulator* emu, uint64_t opcode) {
+    materialize_flags(emu);
+    return jump_condition_met(emu, (InstructionType)(INST_JMP + (opcode - OP_JMP)));
+}
+
+// Function to check whether the JIT can translate a decoded op
+static bool jit_supports_op(const DecodedOp* op) {
+    switch (op->opcode) {
+    case OP_MOV_RR: case OP_MOV_RI:
+    case OP_ADD_RR: case OP_ADD_RI:
+    case OP_SUB_RR: case OP_SUB_RI:
+    case OP_AND_RR: case OP_AND_RI:
+    case OP_OR_RR:  case OP_OR_RI:
+    case OP_XOR_RR: case OP_XOR_RI:
+    case OP_SHL_RR: case OP_SHL_RI:
+    case OP_SHR_RR: case OP_SHR_RI:
+    case OP_CMP_RR: case OP_CMP_RI:
+    case OP_FALLTHROUGH:
+        return true;
+    default:
+        return (op->opcode >= OP_JMP && op->opcode <= OP_JNP) ||
+               (op->opcode >= OP_FIRST_FUSED && op->opcode < OP_DEC_R_JE);
+    }
+}
+
+// Function to map a fused CMP/Jcc opcode back to its jump opcode
+static uint8_t jit_fused_jump(uint8_t opcode) {
+    static const uint8_t fused_jump[OP_COUNT] = {
+#define JIT_FUSED_JUMP_ENTRY(jump, condition) [OP_CMP_RR_##jump] = OP_##jump, [OP_CMP_RI_##jump] = OP_##jump,
+        FUSED_RESULT_CONDITIONS(JIT_FUSED_JUMP_ENTRY)
+        FUSED_OVERFLOW_CONDITIONS(JIT_FUSED_JUMP_ENTRY)
+        FUSED_CARRY_CONDITIONS(JIT_FUSED_JUMP_ENTRY)
+#undef JIT_FUSED_JUMP_ENTRY
+    };
+    return fused_jump[opcode];
+}
+
+// Function to switch the JIT buffer between writable and executable
+static bool jit_protect(DecodedProgram* program, bool executable) {
+#ifdef _WIN32
+    DWORD previous;
+    return VirtualProtect(program->jit_code, JIT_BUFFER_SIZE, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &previous) != 0;
+#else
+    return mprotect(program->jit_code, JIT_BUFFER_SIZE, executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+// Function to reserve the executable buffer of a program
+static bool jit_reserve(DecodedProgram* program) {
+#ifdef _WIN32
+    program->jit_code = (uint8_t*)VirtualAlloc(NULL, JIT_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void* code = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    program->jit_code = code == MAP_FAILED ? NULL : (uint8_t*)code;
+#endif
+    program->jit_used = 0;
+    return program->jit_code != NULL;
+}
+
+// Function to translate a basic block to native code; returns NULL if the block stays interpreted
+static JitBlockFunction jit_compile_block(DecodedProgram* program, uint32_t block_index) {
+    const DecodedBlock* block = &program->blocks[block_index];
+    const DecodedOp* ops = program->ops + block->first_op;
+    size_t op_count = 0;
+
+    // The block must consist of supported ops up to and including its terminator
+    for (;;) {
+        const DecodedOp* op = &ops[op_count++];
+        if (!jit_supports_op(op)) {
+            return NULL;
+        }
+        if (op->opcode == OP_FALLTHROUGH || decoded_op_ends_block(op)) {
+            break;
+        }
+    }
+
+    if (!program->jit_code && !jit_reserve(program)) {
+        LOG_WARN("Warning: JIT buffer allocation failed, continuing in the interpreter\n");
+        jit_enabled = false;
+        return NULL;
+    }
+    if (program->jit_used + (op_count + 2) * JIT_MAX_OP_BYTES > JIT_BUFFER_SIZE || !jit_protect(program, false)) {
+        return NULL;
+    }
+
+    JitEmitter emitter = { program->jit_code + program->jit_used, 0 };
+    JitEmitter* jit = &emitter;
+
+    // Prologue: keep emu in rbx and the iteration budget in r12 (the stack stays 16-byte aligned for helper calls)
+    static const uint8_t prologue[] = {
+        0x53,                       // push rbx
+        0x41, 0x54,                 // push r12
+        0x41, 0x55,                 // push r13
+#ifdef _WIN32
+        0x48, 0x83, 0xEC, 0x20,     // sub rsp, 32 (shadow space)
+        0x48, 0x89, 0xCB,           // mov rbx, rcx
+        0x49, 0x89, 0xD5,           // mov r13, rdx
+#else
+        0x48, 0x89, 0xFB,           // mov rbx, rdi
+        0x49, 0x89, 0xF5,           // mov r13, rsi
+#endif
+        0x4D, 0x8B, 0x65, 0x00      // mov r12, [r13]
+    };
+    memcpy(jit->code, prologue, sizeof(prologue));
+    jit->length = sizeof(prologue);
+    size_t body = jit->length;
+
+    // Host flags still hold the result of the last emulated ADD, SUB or CMP
+    bool host_flags_live = false;
+
+    for (size_t i = 0; i < op_count; i++) {
+        const DecodedOp* op = &ops[i];
+        size_t dst = JIT_REGISTER_OFFSET(op->dst);
+
+        switch (op->opcode) {
+        case OP_MOV_RR:
+        case OP_MOV_RI:
+            jit_emit_load_source(jit, op);
+            jit_emit_emu_operand(jit, 0x89, JIT_RDX, dst);                         // mov [dst], rdx
+            continue;  // MOV leaves the host flags alone
+
+        case OP_ADD_RR: case OP_ADD_RI:
+        case OP_SUB_RR: case OP_SUB_RI:
+        case OP_CMP_RR: case OP_CMP_RI: {
+            bool add = op->opcode == OP_ADD_RR || op->opcode == OP_ADD_RI;
+            bool cmp = op->opcode == OP_CMP_RR || op->opcode == OP_CMP_RI;
+            jit_emit_emu_operand(jit, 0x8B, JIT_RAX, dst);                         // mov rax, [dst]
+            jit_emit_load_source(jit, op);
+            jit_emit_emu_operand(jit, 0x89, JIT_RAX, JIT_LAZY_OFFSET(a));          // lazy_flags.a = rax
+            jit_emit_emu_operand(jit, 0x89, JIT_RDX, JIT_LAZY_OFFSET(b));          // lazy_flags.b = rdx
+            jit_emit_byte(jit, 0x48);
+            jit_emit_byte(jit, add ? 0x01 : 0x29);                                 // add/sub rax, rdx
+            jit_emit_byte(jit, 0xD0);
+            if (!cmp) {
+                jit_emit_emu_operand(jit, 0x89, JIT_RAX, dst);                     // mov [dst], rax
+            }
+            jit_emit_emu_operand(jit, 0x89, JIT_RAX, JIT_LAZY_OFFSET(result));     // lazy_flags.result = rax
+            jit_emit_byte(jit, 0xC6);                                              // lazy_flags.op = ADD/SUB
+            jit_emit_byte(jit, 0x83);
+            jit_emit_u32(jit, (uint32_t)JIT_LAZY_OFFSET(op));
+            jit_emit_byte(jit, add ? FLAGS_ADD : FLAGS_SUB);
+            host_flags_live = true;
+            continue;
+        }
+
+        case OP_AND_RR: case OP_AND_RI:
+        case OP_OR_RR:  case OP_OR_RI:
+        case OP_XOR_RR: case OP_XOR_RI: {
+            uint8_t opcode = (op->opcode == OP_AND_RR || op->opcode == OP_AND_RI) ? 0x21 :
+                             (op->opcode == OP_OR_RR || op->opcode == OP_OR_RI) ? 0x09 : 0x31;
+            jit_emit_emu_operand(jit, 0x8B, JIT_RAX, dst);                         // mov rax, [dst]
+            jit_emit_load_source(jit, op);
+            jit_emit_byte(jit, 0x48);
+            jit_emit_byte(jit, opcode);                                            // and/or/xor rax, rdx
+            jit_emit_byte(jit, 0xD0);
+            jit_emit_emu_operand(jit, 0x89, JIT_RAX, dst);                         // mov [dst], rax
+            if (opcode == 0x09) {
+                jit_emit_helper_call(jit, (const void*)jit_logic_flags);
+            }
+            break;
+        }
+
+        case OP_SHL_RR: case OP_SHL_RI:
+        case OP_SHR_RR: case OP_SHR_RI: {
+            bool left = op->opcode == OP_SHL_RR || op->opcode == OP_SHL_RI;
+            jit_emit_emu_operand(jit, 0x8B, JIT_RAX, dst);                         // mov rax, [dst]
+            jit_emit_load_source(jit, op);
+            jit_emit_byte(jit, 0x48);                                              // mov rcx, rdx
+            jit_emit_byte(jit, 0x89);
+            jit_emit_byte(jit, 0xD1);
+            jit_emit_byte(jit, 0x48);                                              // shl/shr rax, cl (count & 63)
+            jit_emit_byte(jit, 0xD3);
+            jit_emit_byte(jit, left ? 0xE0 : 0xE8);
+            jit_emit_emu_operand(jit, 0x89, JIT_RAX, dst);                         // mov [dst], rax
+            break;
+        }
+
+        case OP_FALLTHROUGH:
+            jit_emit_exit(jit, block->fallthrough, block_index, body);
+            break;
+
+        case OP_JMP:
+            jit_emit_exit(jit, block->taken, block_index, body);
+            break;
+
+        default: {
+            // Conditional jump, alone or fused with the CMP before it
+            uint8_t jump = op->opcode;
+            size_t taken;
+            if (op->opcode >= OP_FIRST_FUSED) {
+                jump = jit_fused_jump(op->opcode);
+                jit_emit_emu_operand(jit, 0x8B, JIT_RAX, dst);                     // mov rax, [dst]
+                jit_emit_load_source(jit, op);
+                jit_emit_emu_operand(jit, 0x89, JIT_RAX, JIT_LAZY_OFFSET(a));
+                jit_emit_emu_operand(jit, 0x89, JIT_RDX, JIT_LAZY_OFFSET(b));
+                jit_emit_byte(jit, 0x48);                                          // sub rax, rdx
+                jit_emit_byte(jit, 0x29);
+                jit_emit_byte(jit, 0xD0);
+                jit_emit_emu_operand(jit, 0x89, JIT_RAX, JIT_LAZY_OFFSET(result));
+                jit_emit_byte(jit, 0xC6);
+                jit_emit_byte(jit, 0x83);
+                jit_emit_u32(jit, (uint32_t)JIT_LAZY_OFFSET(op));
+                jit_emit_byte(jit, FLAGS_SUB);
+                host_flags_live = true;
+            }
+            if (host_flags_live) {
+                taken = jit_emit_jump(jit, jit_condition_codes[jump - OP_JMP]);
+            }
+            else {
+                // Flags come from outside the block: evaluate them in C
+                jit_emit_mov_imm(jit, JIT_RAX, jump);
+                jit_emit_helper_call(jit, (const void*)jit_jump_taken);
+                jit_emit_byte(jit, 0x84);                                          // test al, al
+                jit_emit_byte(jit, 0xC0);
+                taken = jit_emit_jump(jit, 0x5);                                   // jnz taken
+            }
+            jit_emit_exit(jit, block->fallthrough, block_index, body);
+            jit_patch_jump(jit, taken);
+            jit_emit_exit(jit, block->taken, block_index, body);
+            break;
+        }
+        }
+        host_flags_live = false;
+    }
+
+    JitBlockFunction native = (JitBlockFunction)(void*)jit->code;
+    program->jit_used += (jit->length + 15) & ~(size_t)15;
+    if (!jit_protect(program, true)) {
+        return NULL;
+    }
+    return native;
+}
+
+// Function to release the executable buffer of a program
+void jit_release(DecodedProgram* program) {
+    if (program->jit_code) {
+#ifdef _WIN32
+        VirtualFree(program->jit_code, 0, MEM_RELEASE);
+#else
+        munmap(program->jit_code, JIT_BUFFER_SIZE);
+#endif
+    }
+    program->jit_code = NULL;
+    program->jit_used = 0;
+}
+
+#endif // JIT_SUPPORTED
+
+// Function to pick the entry count at which a block moves to its next tier
+static uint64_t next_promotion(const DecodedBlock* block) {
+    if (block->count == 0) {
+        return UINT64_MAX;  // The HALT block
+    }
+    switch (block->tier) {
+    case TIER_BASELINE:
+        return optimize_threshold;
+#ifdef JIT_SUPPORTED
+    case TIER_OPTIMIZED:
+        return jit_enabled ? jit_threshold : UINT64_MAX;
+    case TIER_NATIVE:
+        return 0;
+#endif
+    default:
+        return UINT64_MAX;
+    }
+}
+
+// Function to run a decoded program.
+// GCC and Clang dispatch through computed gotos (one indirect branch per handler); other compilers use a switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define THREADED_DISPATCH
+#endif
+
+void run_decoded_program(Emulator* emu, DecodedProgram* program) {
+#ifdef THREADED_DISPATCH
+    static const void* const handlers[OP_COUNT] = {
+#define DECODED_OPCODE_LABEL(name) &&handler_##name,
+        DECODED_OPCODES(DECODED_OPCODE_LABEL)
+#undef DECODED_OPCODE_LABEL
+#define BINARY_FORM_LABELS(name, reads, writes, expression, flags) \
+        &&handler_OP_##name##_RR, &&handler_OP_##name##_RI, &&handler_OP_##name##_RM, \
+        &&handler_OP_##name##_MR, &&handler_OP_##name##_MI, &&handler_OP_##name##_MM, \
+        &&handler_OP_##name##_RX, &&handler_OP_##name##_XR, &&handler_OP_##name##_XI,
+        BINARY_OPS(BINARY_FORM_LABELS)
+#undef BINARY_FORM_LABELS
+#define UNARY_FORM_LABELS(name, expression, reg_flags, mem_flags) &&handler_OP_##name##_R, &&handler_OP_##name##_M, &&handler_OP_##name##_X,
+        UNARY_OPS(UNARY_FORM_LABELS)
+#undef UNARY_FORM_LABELS
+#define FUSED_CMP_LABELS(jump, condition) &&handler_OP_CMP_RR_##jump, &&handler_OP_CMP_RI_##jump,
+#define FUSED_DEC_LABELS(jump, condition) &&handler_OP_DEC_R_##jump,
+        FUSED_RESULT_CONDITIONS(FUSED_CMP_LABELS)
+        FUSED_OVERFLOW_CONDITIONS(FUSED_CMP_LABELS)
+        FUSED_CARRY_CONDITIONS(FUSED_CMP_LABELS)
+        FUSED_RESULT_CONDITIONS(FUSED_DEC_LABELS)
+#undef FUSED_CMP_LABELS
+#undef FUSED_DEC_LABELS
+    };
+
+    // Resolve handler addresses once per program
+    if (!program->threaded) {
+        for (size_t i = 0; i < program->op_count; i++) {
+            program->ops[i].handler = handlers[program->ops[i].opcode];
+        }
+        program->threaded = true;
+    }
+#define HANDLER(name) handler_##name
+#define DISPATCH() { goto *op->handler; }
+#else
+#define HANDLER(name) case name
+#define DISPATCH() { continue; }
+#endif
+#define NEXT() { op++; DISPATCH(); }
+
+// Block entry does the per-block work: entry counting, the instruction limit (fuel) check
+// and handing blocks that reached their promotion point to the tier manager
+#define BEGIN_BLOCK(target) { \
+        DecodedBlock* next_block = blocks + (target); \
+        if (next_block->count > fuel) { block = next_block; goto out_of_fuel; } \
+        fuel -= next_block->count; \
+        if (++next_block->entries >= next_block->promote_at) { block = next_block; goto promote_block; } \
+        op = ops + next_block->first_op; \
+    }
+#define ENTER_BLOCK(target) { BEGIN_BLOCK(target); DISPATCH(); }
+// Taken and not-taken paths keep separate dispatch sites so each indirect branch predicts well
+#define JUMP_IF(condition) { \
+        if (condition) ENTER_BLOCK((uint32_t)op->dst_value); \
+        ENTER_BLOCK((uint32_t)(op->dst_value >> 32)); \
+    }
+
+// Operand accessors used by the specialized handlers (R = register, I = immediate, M = memory,
+// X = memory at a register-based address). A handler computes its destination address once.
+#define ADDRESS_R_DST 0
+#define ADDRESS_M_DST op->dst_value
+#define ADDRESS_X_DST packed_address(emu, op->dst_value)
+#define LOAD_R_DST emu->registers[op->dst]
+#define LOAD_M_DST read_memory(emu, dst_address, sizeof(uint64_t))
+#define LOAD_X_DST LOAD_M_DST
+#define LOAD_R_SRC emu->registers[op->src]
+#define LOAD_I_SRC op->src_value
+#define LOAD_M_SRC read_memory(emu, op->src_value, sizeof(uint64_t))
+#define LOAD_X_SRC read_memory(emu, packed_address(emu, op->src_value), sizeof(uint64_t))
+#define STORE_R(value) emu->registers[op->dst] = (value)
+#define STORE_M(value) write_memory(emu, dst_address, (value), sizeof(uint64_t))
+#define STORE_X(value) STORE_M(value)
+
+#define BINARY_FORM_HANDLER(name, form, d, s, reads, writes, expression, flags) \
+    HANDLER(OP_##name##_##form): { \
+        uint64_t dst_address = ADDRESS_##d##_DST; \
+        (void)dst_address; \
+        uint64_t a = (reads) ? LOAD_##d##_DST : 0; \
+        uint64_t b = LOAD_##s##_SRC; \
+        uint64_t result = (expression); \
+        (void)a; \
+        if (writes) STORE_##d(result); \
+        flags; \
+        NEXT(); \
+    }
+#define BINARY_FORM_HANDLERS(name, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, RR, R, R, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, RI, R, I, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, RM, R, M, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, MR, M, R, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, MI, M, I, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, MM, M, M, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, RX, R, X, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, XR, X, R, reads, writes, expression, flags) \
+    BINARY_FORM_HANDLER(name, XI, X, I, reads, writes, expression, flags)
+
+#define UNARY_FORM_HANDLER(name, form, d, expression, flags) \
+    HANDLER(OP_##name##_##form): { \
+        uint64_t dst_address = ADDRESS_##d##_DST; \
+        (void)dst_address; \
+        uint64_t a = LOAD_##d##_DST; \
+        uint64_t result = (expression); \
+        STORE_##d(result); \
+        flags; \
+        NEXT(); \
+    }
+#define UNARY_FORM_HANDLERS(name, expression, reg_flags, mem_flags) \
+    UNARY_FORM_HANDLER(name, R, R, expression, reg_flags) \
+    UNARY_FORM_HANDLER(name, M, M, expression, mem_flags) \
+    UNARY_FORM_HANDLER(name, X, X, expression, mem_flags)
+
+// Fused compare-and-branch: closes the block for itself and the jump it absorbed
+#define FUSED_BRANCH(condition) JUMP_IF(condition)
+#define FUSED_CMP_HANDLER(form, s, jump, condition) \
+    HANDLER(OP_CMP_##form##_##jump): { \
+        uint64_t a = emu->registers[op->dst]; \
+        uint64_t b = LOAD_##s##_SRC; \
+        record_flags(emu, FLAGS_SUB, a, b, a - b); \
+        FUSED_BRANCH(condition); \
+    }
+#define FUSED_CMP_HANDLERS(jump, condition) \
+    FUSED_CMP_HANDLER(RR, R, jump, condition) \
+    FUSED_CMP_HANDLER(RI, I, jump, condition)
+#define FUSED_DEC_HANDLERS(jump, condition) \
+    HANDLER(OP_DEC_R_##jump): { \
+        uint64_t a = emu->registers[op->dst]; \
+        uint64_t b = 1; \
+        emu->registers[op->dst] = a - 1; \
+        record_flags(emu, FLAGS_DEC_REG, a, lazy_carry(emu), a - 1); \
+        FUSED_BRANCH(condition); \
+    }
+
+    DecodedOp* ops = program->ops;
+    DecodedBlock* blocks = program->blocks;
+    DecodedBlock* block = blocks;  // Block that ran out of fuel or reached its promotion point
+    const DecodedOp* op = ops;
+    const uint64_t initial_fuel = instruction_limit ? instruction_limit : UINT64_MAX;
+    uint64_t fuel = initial_fuel;
+    double start = host_time_seconds();
+
+    // Reset block entry counts for this run
+    for (size_t i = 0; i < program->block_count; i++) {
+        blocks[i].entries = 0;
+        blocks[i].promote_at = next_promotion(&blocks[i]);
+    }
+
+    BEGIN_BLOCK(0);
+#ifdef THREADED_DISPATCH
+    DISPATCH();
+    {
+#else
+    for (;;) {
+        switch (op->opcode) {
+#endif
+    HANDLER(OP_HALT):
+        goto halt;
+
+    HANDLER(OP_SLOW):
+        materialize_flags(emu);
+        emu->rip = op->index;
+        execute_instruction(emu, &program->instructions[op->index], op->index);
+        NEXT();
+
+    HANDLER(OP_NOP):
+        NEXT();
+
+    HANDLER(OP_VECTOR):
+        execute_vector_instruction(emu, &program->instructions[op->index]);
+        NEXT();
+
+    HANDLER(OP_PACKED_V):
+        vector_kernels[op->dst_value](emu->vector[op->dst].bytes, emu->vector[op->src].bytes, op->form);
+        NEXT();
+
+    HANDLER(OP_PACKED_X): {
+        uint8_t buffer[32];
+        const uint8_t* source = read_vector_memory(emu, packed_address(emu, op->src_value), buffer, op->form);
+        if (source) vector_kernels[op->dst_value](emu->vector[op->dst].bytes, source, op->form);
+        NEXT();
+    }
+
+    HANDLER(OP_VLOAD): {
+        uint8_t buffer[32];
+        const uint8_t* source = read_vector_memory(emu, packed_address(emu, op->src_value), buffer, op->form);
+        if (source) memcpy(emu->vector[op->dst].bytes, source, op->form);
+        NEXT();
+    }
+
+    HANDLER(OP_VSTORE):
+        write_vector_memory(emu, packed_address(emu, op->dst_value), emu->vector[op->src].bytes, op->form);
+        NEXT();
+
+    HANDLER(OP_FALLTHROUGH):
+        ENTER_BLOCK((uint32_t)op->dst_value);
+
+    HANDLER(OP_MOV):
+        decoded_store(emu, op, decoded_source(emu, op));
+        NEXT();
+
+    HANDLER(OP_ADD): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t b = decoded_source(emu, op);
+        uint64_t result = a + b;
+        decoded_store(emu, op, result);
+        if (decoded_narrow_overflow(program, op, result, "Addition")) NEXT();
+        record_flags(emu, FLAGS_ADD, a, b, result);
+        NEXT();
+    }
+
+    HANDLER(OP_SUB): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t b = decoded_source(emu, op);
+        uint64_t result = a - b;
+        decoded_store(emu, op, result);
+        if (decoded_narrow_overflow(program, op, result, "Subtraction")) NEXT();
+        record_flags(emu, FLAGS_SUB, a, b, result);
+        NEXT();
+    }
+
+    HANDLER(OP_MUL): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t b = decoded_source(emu, op);
+        uint64_t result = a * b;
+        decoded_store(emu, op, result);
+        if (decoded_narrow_overflow(program, op, result, "Multiplication")) NEXT();
+        record_flags(emu, FLAGS_MUL, a, b, result);
+        NEXT();
+    }
+
+    HANDLER(OP_DIV): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t b = decoded_source(emu, op);
+        uint64_t result = decoded_divide(op, a, b);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "Division");
+        record_flags(emu, FLAGS_DIV, a, b, result);
+        NEXT();
+    }
+
+    HANDLER(OP_INC): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t result = a + 1;
+        decoded_store(emu, op, result);
+        if (decoded_narrow_overflow(program, op, result, "Increment")) NEXT();
+        record_flags(emu, FLAGS_INC, a, 1, result);
+        NEXT();
+    }
+
+    HANDLER(OP_DEC): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t result = a - 1;
+        decoded_store(emu, op, result);
+        if ((op->form & OP_FORM_NARROW) && result > 0xFFFFFFFF) {
+            LOG_WARN("Warning: Decrement result 0x%016" PRIx64 " wrapped around for 32-bit register %s\n",
+                result, program->instructions[op->index].dest_reg_name);
+        }
+        if (OP_DST_KIND(op->form) == OPERAND_MEM) {
+            record_flags(emu, FLAGS_DEC, a, 1, result);
+        }
+        else {
+            record_flags(emu, FLAGS_DEC_REG, a, lazy_carry(emu), result);
+        }
+        NEXT();
+    }
+
+    HANDLER(OP_NEG): {
+        uint64_t a = decoded_destination(emu, op);
+        uint64_t result = (uint64_t)(-(int64_t)a);
+        decoded_store(emu, op, result);
+        if (decoded_narrow_overflow(program, op, result, "Negation")) NEXT();
+        record_flags(emu, FLAGS_NEG, a, 0, result);
+        NEXT();
+    }
+
+    HANDLER(OP_CMP): {
+        uint64_t a = emu->registers[op->dst];
+        uint64_t b = decoded_source(emu, op);
+        record_flags(emu, FLAGS_SUB, a, b, a - b);
+        NEXT();
+    }
+
+    HANDLER(OP_AND): {
+        uint64_t result = decoded_destination(emu, op) & decoded_source(emu, op);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "AND");
+        NEXT();
+    }
+
+    HANDLER(OP_OR): {
+        uint64_t result = decoded_destination(emu, op) | decoded_source(emu, op);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "OR");
+        set_logic_flags(emu, result);
+        NEXT();
+    }
+
+    HANDLER(OP_XOR): {
+        uint64_t result = decoded_destination(emu, op) ^ decoded_source(emu, op);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "XOR");
+        NEXT();
+    }
+
+    HANDLER(OP_NOT): {
+        uint64_t result = ~decoded_destination(emu, op);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "NOT");
+        NEXT();
+    }
+
+    HANDLER(OP_SHL): {
+        uint64_t result = decoded_destination(emu, op) << (decoded_source(emu, op) & 63);
+        decoded_store(emu, op, result);
+        decoded_narrow_overflow(program, op, result, "SHL");
+        NEXT();
+    }
+
+    HANDLER(OP_SHR):
+        decoded_store(emu, op, decoded_destination(emu, op) >> (decoded_source(emu, op) & 63));
+        NEXT();
+
+    HANDLER(OP_ROL):
+        decoded_store(emu, op, rotate_left(decoded_destination(emu, op), decoded_source(emu, op)));
+        NEXT();
+
+    HANDLER(OP_ROR):
+        decoded_store(emu, op, rotate_right(decoded_destination(emu, op), decoded_source(emu, op)));
+        NEXT();
+
+    HANDLER(OP_PUSH):
+        push(emu, decoded_destination(emu, op));
+        NEXT();
+
+    HANDLER(OP_POP):
+        decoded_store(emu, op, pop(emu));
+        NEXT();
+
+    // Operand-form specialized handlers generated from BINARY_OPS and UNARY_OPS
+    BINARY_OPS(BINARY_FORM_HANDLERS)
+    UNARY_OPS(UNARY_FORM_HANDLERS)
+
+    // Fused CMP/Jcc and DEC/Jcc superinstructions
+    FUSED_RESULT_CONDITIONS(FUSED_CMP_HANDLERS)
+    FUSED_OVERFLOW_CONDITIONS(FUSED_CMP_HANDLERS)
+    FUSED_CARRY_CONDITIONS(FUSED_CMP_HANDLERS)
+    FUSED_RESULT_CONDITIONS(FUSED_DEC_HANDLERS)
+
+    HANDLER(OP_JMP): JUMP_IF(true);
+    HANDLER(OP_JE):  JUMP_IF(lazy_zero(emu));
+    HANDLER(OP_JNE): JUMP_IF(!lazy_zero(emu));
+    HANDLER(OP_JG):  JUMP_IF(!lazy_zero(emu) && lazy_sign(emu) == lazy_overflow(emu));
+    HANDLER(OP_JGE): JUMP_IF(lazy_sign(emu) == lazy_overflow(emu));
+    HANDLER(OP_JL):  JUMP_IF(lazy_sign(emu) != lazy_overflow(emu));
+    HANDLER(OP_JLE): JUMP_IF(lazy_zero(emu) || lazy_sign(emu) != lazy_overflow(emu));
+    HANDLER(OP_JA):  JUMP_IF(!lazy_carry(emu) && !lazy_zero(emu));
+    HANDLER(OP_JAE): JUMP_IF(!lazy_carry(emu));
+    HANDLER(OP_JB):  JUMP_IF(lazy_carry(emu));
+    HANDLER(OP_JBE): JUMP_IF(lazy_carry(emu) || lazy_zero(emu));
+    HANDLER(OP_JO):  JUMP_IF(lazy_overflow(emu));
+    HANDLER(OP_JNO): JUMP_IF(!lazy_overflow(emu));
+    HANDLER(OP_JS):  JUMP_IF(lazy_sign(emu));
+    HANDLER(OP_JNS): JUMP_IF(!lazy_sign(emu));
+    HANDLER(OP_JP):  JUMP_IF(lazy_parity(emu));
+    HANDLER(OP_JNP): JUMP_IF(!lazy_parity(emu));
+
+    // Tier manager: a block that reached its promotion point moves up as far as its entry count allows
+    promote_block: {
+        if (block->tier == TIER_BASELINE) {
+            optimize_decoded_block(program, block);
+#ifdef THREADED_DISPATCH
+            for (DecodedOp* rewritten = ops + block->first_op; ; rewritten++) {
+                rewritten->handler = handlers[rewritten->opcode];
+                if (rewritten->opcode == OP_FALLTHROUGH || decoded_op_ends_block(rewritten)) break;
+            }
+#endif
+            block->tier = TIER_OPTIMIZED;
+            emu->stats.blocks_optimized++;
+        }
+        block->promote_at = next_promotion(block);
+#ifdef JIT_SUPPORTED
+        if (block->tier == TIER_OPTIMIZED && block->entries >= block->promote_at) {
+            block->native = jit_compile_block(program, (uint32_t)(block - blocks));
+            if (block->native) {
+                block->tier = TIER_NATIVE;
+                emu->stats.jit_blocks_compiled++;
+                block->promote_at = 0;
+            }
+            else {
+                block->promote_at = UINT64_MAX;  // The JIT cannot translate it; stay optimized
+            }
+        }
+        if (block->tier != TIER_NATIVE) {
+            op = ops + block->first_op;
+            DISPATCH();
+        }
+
+        // The entry is already paid for; the native code may loop while the fuel lasts
+        uint64_t budget = fuel / block->count;
+        uint64_t iterations = budget;
+        uint32_t next = block->native(emu, &iterations);
+        fuel -= (budget - iterations) * block->count;
+        block->entries += budget - iterations;
+        ENTER_BLOCK(next);
+#else
+        op = ops + block->first_op;
+        DISPATCH();
+#endif
+    }
+#ifdef THREADED_DISPATCH
+    }
+#else
+        default:
+            goto halt;
+        }
+    }
+#endif
+
+out_of_fuel:
+    // Run the part of the block the fuel still pays for on the slow path, so the run stops at the same
+    // instruction as the reference loop. Only the last instruction of a block can jump, so these fall through.
+    materialize_flags(emu);
+    for (uint32_t i = 0; i < fuel; i++) {
+        emu->rip = block->first + i;
+        execute_instruction(emu, &program->instructions[block->first + i], block->first + i);
+    }
+    op = ops + block->first_op + fuel;
+    fuel = 0;
+    fprintf(stderr, "Error: Instruction limit of %" PRIu64 " reached at rip=%u\n", instruction_limit, op->index);
+
+halt:
+    materialize_flags(emu);
+
+    // The HALT block has no instructions and is not counted as an executed block
+    for (size_t i = 0; i + 1 < program->block_count; i++) {
+        emu->stats.blocks_executed += blocks[i].entries;
+    }
+    emu->stats.instructions_executed += initial_fuel - fuel;
+    emu->stats.execution_seconds += host_time_seconds() - start;
+    emu->rip = op->index;
+
+#undef HANDLER
+#undef DISPATCH
+#undef NEXT
+#undef JUMP_IF
+#undef BEGIN_BLOCK
+#undef ENTER_BLOCK
+#undef ADDRESS_R_DST
+#undef ADDRESS_M_DST
+#undef ADDRESS_X_DST
+#undef LOAD_R_DST
+#undef LOAD_M_DST
+#undef LOAD_X_DST
+#undef LOAD_R_SRC
+#undef LOAD_I_SRC
+#undef LOAD_M_SRC
+#undef LOAD_X_SRC
+#undef STORE_R
+#undef STORE_M
+#undef STORE_X
+#undef BINARY_FORM_HANDLER
+#undef BINARY_FORM_HANDLERS
+#undef UNARY_FORM_HANDLER
+#undef UNARY_FORM_HANDLERS
+#undef FUSED_BRANCH
+#undef FUSED_CMP_HANDLER
+#undef FUSED_CMP_HANDLERS
+#undef FUSED_DEC_HANDLERS
+}
+
+// Function to execute instructions from a file
+// Source file held in memory for the assembler: a read-only mapping of the file, or a heap copy of
+// input that cannot be mapped (pipes, empty files)
+typedef struct {
+    const char* text;
+    size_t length;
+    bool mapped;           // text is a file mapping rather than a heap buffer
+} SourceText;
+
+// Function to read a whole stream into a heap buffer for input that cannot be mapped
+static bool read_source_stream(FILE* file, SourceText* source) {
+    size_t capacity = 64 * 1024;
+    char* text = malloc(capacity);
+    size_t length = 0;
+    size_t got;
+    while (text && (got = fread(text + length, 1, capacity - length, file)) > 0) {
+        length += got;
+        if (length == capacity) {
+            capacity *= 2;
+            char* grown = realloc(text, capacity);
+            if (!grown) free(text);
+            text = grown;
+        }
+    }
+    if (!text) {
+        fprintf(stderr, "Error: Memory allocation failed for source text\n");
+        exit(1);
+    }
+    source->text = text;
+    source->length = length;
+    source->mapped = false;
+    return !ferror(file);
+}
+
+// Function to map a source file read-only into memory. The lexer tokenizes the mapped bytes in place, so the
+// file is never copied and lines have no length limit. Returns false if the file cannot be read.
+bool open_source_text(const char* path, SourceText* source) {
+    void* base;
+    size_t length;
+    if (map_file_private(path, false, true, &base, &length) && base) {
+        source->text = base;
+        source->length = length;
+        source->mapped = true;
+        return true;
+    }
+
+    FILE* file_stream = fopen(path, "rb");
+    if (!file_stream) return false;
+    bool ok = read_source_stream(file_stream, source);
+    fclose(file_stream);
+    return ok;
+}
+
+// Function to release the memory of a source file
+void close_source_text(SourceText* source) {
+    if (source->mapped) {
+        unmap_file(source->text, source->length);
+    }
+    else {
+        free((void*)source->text);
+    }
+    memset(source, 0, sizeof(*source));
+}
+
+// Function to take the next line of the source text and advance *position past its terminator.
+// The line excludes "\n" or "\r\n". Returns false at the end of the text.
+static bool next_source_line(const char** position, const char* end, StringView* line) {
+    const char* start = *position;
+    if (start >= end) return false;
+    const char* newline = memchr(start, '\n', (size_t)(end - start));
+    const char* stop = newline ? newline : end;
+    *position = newline ? newline + 1 : end;
+    if (stop > start && stop[-1] == '\r') stop--;
+    line->data = start;
+    line->length = (size_t)(stop - start);
+    return true;
+}
+
+// Function to parse one operand into a slot of an instruction. kinds is a mask of ACCEPT_* forms and
+// KEEP_* names. Returns false (after reporting the error) if the operand has a form the slot does not accept.
+static bool parse_operand(Instruction* inst, OperandSlot slot, StringView text, unsigned kinds, size_t line_num) {
+    static const char* const slot_names[] = { "destination", "source", "third" };
+    RegOperand* reg = slot == OPERAND_SLOT_DEST ? &inst->dest_reg : slot == OPERAND_SLOT_SRC ? &inst->src_reg : &inst->aux_reg;
+    char* name = slot == OPERAND_SLOT_DEST ? inst->dest_reg_name : slot == OPERAND_SLOT_SRC ? inst->src_reg_name : inst->aux_reg_name;
+    const char* open = memchr(text.data, '[', text.length);
+    const char* close = open ? memchr(open, ']', (size_t)(text.data + text.length - open)) : NULL;
+    unsigned keep;
+
+    RegOperand decoded = get_register_operand(text);
+    if ((kinds & ACCEPT_REG) && REG_PRESENT(decoded)) {
+        *reg = decoded;
+        keep = KEEP_REG_NAME;
+    }
+    else if ((kinds & ACCEPT_MEM) && close) {
+        if (close == open + 1) {
+            fprintf(stderr, "Error: Invalid memory address format '%.*s' at line %zu\n", VIEW_ARGS(text), line_num);
+            return false;
+        }
+        StringView address = { open + 1, (size_t)(close - open - 1) };
+        if (slot == OPERAND_SLOT_DEST) {
+            parse_memory_address(address, &inst->dest_address, &inst->dest_mem_address, line_num);
+            inst->dest_is_memory = true;
+        }
+        else if (slot == OPERAND_SLOT_SRC) {
+            parse_memory_address(address, &inst->src_address, &inst->src_mem_address, line_num);
+            inst->src_is_memory = true;
+        }
+        else {
+            parse_memory_address(address, &inst->aux_address, &inst->aux_mem_address, line_num);
+            inst->aux_is_memory = true;
+        }
+        keep = KEEP_MEM_NAME;
+    }
+    else if ((kinds & ACCEPT_STRING) && text.data[0] == '"') {
+        // Quotes removed; an unterminated string runs to the end of the token
+        StringView string = { text.data + 1, text.length - 1 };
+        if (string.length > 0 && string.data[string.length - 1] == '"') string.length--;
+        copy_view(inst->src_string, sizeof(inst->src_string), string);
+        inst->src_is_string = true;
+        return true;
+    }
+    else if (kinds & (ACCEPT_IMM | ACCEPT_EXACT_IMM)) {
+        uint64_t value;
+        if (kinds & ACCEPT_EXACT_IMM) {
+            if (parse_view_integer(text, 0, &value) != text.length) {
+                fprintf(stderr, "Error: Invalid %s operand '%.*s' at line %zu\n", slot_names[slot], VIEW_ARGS(text), line_num);
+                return false;
+            }
+            if (slot == OPERAND_SLOT_SRC) inst->src_immediate = 1;
+        }
+        else {
+            bool hex = text.length > 1 && text.data[0] == '0' && (text.data[1] == 'x' || text.data[1] == 'X');
+            parse_view_integer(text, hex ? 16 : 10, &value);
+        }
+        if (slot == OPERAND_SLOT_AUX) inst->aux_immediate = value;
+        else inst->immediate = value;
+        keep = KEEP_IMM_NAME;
+    }
+    else {
+        fprintf(stderr, "Error: Invalid %s operand '%.*s' at line %zu\n", slot_names[slot], VIEW_ARGS(text), line_num);
+        return false;
+    }
+    if (kinds & keep) {
+        copy_view(name, sizeof(inst->dest_reg_name), text);
+    }
+    return true;
+}
+
+// Function to parse the operands of an instruction into its destination, source and third slot by the
+// rules of its opcode table entry. Operands past the last slot the instruction uses are ignored.
+static bool parse_operands(Instruction* inst, const OpcodeInfo* info, const StringView* operands, size_t operand_count, size_t line_num) {
+    for (size_t i = 0; i < operand_count && i < 3 && info->rules[i]; i++) {
+        if (!parse_operand(inst, (OperandSlot)i, operands[i], info->rules[i], line_num)) return false;
+    }
+    return true;
+}
+
+// Program assembled from a source file: linked instructions, their labels and the memory its data directives wrote
+typedef struct {
+    Instruction* instructions;
+    size_t instruction_count;
+    SymbolTable symbols;
+    DataExtent* data_extents;
+    size_t data_extent_count;
+} AssembledProgram;
+
+// Function to release an assembled program
+static void free_assembled_program(AssembledProgram* program) {
+    free(program->instructions);
+    free_symbol_table(&program->symbols);
+    free(program->data_extents);
+    memset(program, 0, sizeof(*program));
+}
+
+// Function to assemble a source file. The file is mapped into memory and parsed in a single pass over
+// string views into the mapping: lines and tokens are never copied, and only names an instruction keeps
+// (registers, labels) are stored in it. Data directives are assembled into memory as they are read.
+// Returns false if the program has unknown or duplicate labels or data errors; the program is filled in either way.
+static bool assemble_source_file(Emulator* emu, const char* filename, AssembledProgram* program) {
+    double parse_start = host_time_seconds();
+    SourceText source;
+    if (!open_source_text(filename, &source)) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        exit(1);
+    }
+
+    // Every line holds at most one instruction, so counting lines sizes the instruction array once
+    size_t line_total = 1;
+    for (const char* c = source.text; (c = memchr(c, '\n', (size_t)(source.text + source.length - c))) != NULL; c++) {
+        line_total++;
+    }
+
+    // Dynamic allocation for instructions and labels; the instructions start zeroed
+    size_t instruction_capacity = line_total > INITIAL_CAPACITY ? line_total : INITIAL_CAPACITY;
+    size_t instruction_count = 0;
+    Instruction* instructions = calloc(instruction_capacity, sizeof(Instruction));
+    if (!instructions) {
+        fprintf(stderr, "Error: Memory allocation failed for instructions\n");
+        exit(1);
+    }
+
+    // Code and data labels share one symbol table; a name can only be defined once
+    SymbolTable symbols;
+    memset(&symbols, 0, sizeof(symbols));
+    size_t label_errors = 0;
+
+    // Data directives are assembled into memory as they are read
+    size_t data_errors = 0;
+    DataSection data;
+    memset(&data, 0, sizeof(data));
+    data.location = DATA_BASE_ADDRESS;
+
+    const char* position = source.text;
+    const char* end = source.text + source.length;
+    StringView line;
+    size_t line_num = 0;
+    while (next_source_line(&position, end, &line)) {
+        line_num++;
+
+        // Blank and comment-only lines have no tokens
+        StringView rest = line;
+        StringView token = next_source_token(&rest);
+        if (token.length == 0) continue;
+
+        // Data directive without a label
+        if (is_data_directive(token)) {
+            data_errors += !assemble_data_directive(emu, &data, token, rest, line_num);
+            continue;
+        }
+
+        // Check if the line starts with a label (ends with ':')
+        if (token.data[token.length - 1] == ':') {
+            token.length--;
+
+            // A label in front of a data directive names the data's address
+            StringView after_label = rest;
+            StringView directive = next_source_token(&after_label);
+            if (is_data_directive(directive)) {
+                label_errors += !add_data_label(&symbols, &data, token, line_num);
+                data_errors += !assemble_data_directive(emu, &data, directive, after_label, line_num);
+                continue;
+            }
+            label_errors += !define_symbol(&symbols, token, SYMBOL_CODE, instruction_count, line_num);
+
+            // An instruction may follow the label on the same line
+            if (directive.length == 0) continue;
+            token = directive;
+            rest = after_label;
+        }
+        // REP/REPE/REPNE prefix the string instruction that follows
+        uint8_t rep_prefix = REP_NONE;
+        if (view_equals_nocase(token, "REP")) rep_prefix = REP_PLAIN;
+        else if (view_equals_nocase(token, "REPE") || view_equals_nocase(token, "REPZ")) rep_prefix = REP_EQUAL;
+        else if (view_equals_nocase(token, "REPNE") || view_equals_nocase(token, "REPNZ")) rep_prefix = REP_NOT_EQUAL;
+        if (rep_prefix != REP_NONE) {
+            token = next_source_token(&rest);
+            InstructionType prefixed = get_instruction_type(token);
+            if (prefixed < INST_MOVSB || prefixed > INST_SCASB) {
+                fprintf(stderr, "Error: Repeat prefix without a string instruction at line %zu\n", line_num);
+                continue;
+            }
+            // REP on a compare repeats while equal, as on x86
+            if (rep_prefix == REP_PLAIN && (prefixed == INST_CMPSB || prefixed == INST_SCASB)) rep_prefix = REP_EQUAL;
+        }
+
+        // Get instruction type
+        InstructionType type = get_instruction_type(token);
+        if (type == INST_NOP && !view_equals_nocase(token, "NOP")) {
+            // "name db ..." labels data without a colon
+            StringView after_name = rest;
+            StringView directive = next_source_token(&after_name);
+            if (is_data_directive(directive)) {
+                label_errors += !add_data_label(&symbols, &data, token, line_num);
+                data_errors += !assemble_data_directive(emu, &data, directive, after_name, line_num);
+                continue;
+            }
+            fprintf(stderr, "Error: Unknown instruction '%.*s' at line %zu\n", VIEW_ARGS(token), line_num);
+            continue;
+        }
+
+        // Initialize the Instruction struct in place at the end of the list, which is still zeroed
+        Instruction* inst = &instructions[instruction_count];
+        inst->type = type;
+        inst->immediate = 0;
+        inst->format = HEX; // Default to HEX as per user request
+        inst->rep_prefix = rep_prefix;
+
+        // Up to three operands; anything after them is ignored
+        StringView operands[3];
+        size_t operand_count = 0;
+        while (operand_count < 3 && (operands[operand_count] = next_source_token(&rest)).length > 0) {
+            operand_count++;
+        }
+
+        // Parse operands by the syntax of the instruction; an instruction with invalid operands is left out
+        const OpcodeInfo* info = &opcode_table[type];
+        bool valid = operand_count >= info->required;
+        if (!valid) {
+            fprintf(stderr, "Error: '%s' needs %d operand%s at line %zu\n", info->mnemonic, info->required, info->required == 1 ? "" : "s", line_num);
+        }
+        else if (info->syntax == SYNTAX_OPERANDS) {
+            valid = parse_operands(inst, info, operands, operand_count, line_num);
+        }
+        else if (info->syntax == SYNTAX_INTERRUPT) {
+            // Interrupt number and optional function number
+            uint64_t* values[2] = { &inst->immediate, &inst->function };
+            for (size_t i = 0; i < operand_count && i < 2; i++) {
+                bool hex = operands[i].length > 1 && operands[i].data[0] == '0' && (operands[i].data[1] == 'x' || operands[i].data[1] == 'X');
+                parse_view_integer(operands[i], hex ? 16 : 10, values[i]);
+            }
+        }
+        else if (info->syntax == SYNTAX_LABEL) {
+            copy_view(inst->label, sizeof(inst->label), operands[0]);
+        }
+        else if (info->syntax == SYNTAX_VECTOR) {
+            valid = parse_vector_operands(inst, operands[0], operands[1], line_num);
+        }
+        if (!valid) {
+            memset(inst, 0, sizeof(Instruction));
+            continue;
+        }
+        instruction_count++;
+    }
+
+    // Parse throughput of the front end: mapping, lexing and parsing, before labels are linked
+    double parse_seconds = host_time_seconds() - parse_start;
+    emu->stats.source_lines += line_num;
+    emu->stats.source_bytes += source.length;
+    emu->stats.parse_seconds += parse_seconds;
+    LOG_INFO("Parsed %zu lines (%zu bytes) in %.3f ms: %.0f lines/s, %.1f MB/s\n", line_num, source.length, parse_seconds * 1e3,
+        parse_seconds > 0.0 ? (double)line_num / parse_seconds : 0.0, parse_seconds > 0.0 ? (double)source.length / parse_seconds / 1e6 : 0.0);
+    close_source_text(&source);
+
+    // Resolve jump targets and data label references once; a program with unknown or duplicate labels or data
+    // errors is not run
+    size_t unresolved = link_program(instructions, instruction_count, &symbols);
+    unresolved += resolve_data_references(emu, instructions, instruction_count, &data, &symbols);
+    LOG_INFO("Symbols: %zu labels, %zu bytes of names\n", symbols.count, symbols.strings_length);
+    if (data.bytes > 0) {
+        LOG_INFO("Data: %" PRIu64 " bytes assembled into memory, %zu labels\n", data.bytes, data.label_count);
+    }
+
+    program->instructions = instructions;
+    program->instruction_count = instruction_count;
+    program->symbols = symbols;
+    program->data_extents = data.extents;
+    program->data_extent_count = data.extent_count;
+    data.extents = NULL;
+    free_data_section(&data);
+    return unresolved == 0 && label_errors == 0 && data_errors == 0;
+}
+
+// Function to run a linked program run_count times from the state it was loaded in. A decoded program
+// is used as given (a compiled program's); otherwise the instructions are decoded here.
+static void run_program(Emulator* emu, Instruction* instructions, size_t instruction_count, const SymbolTable* symbols, DecodedProgram* decoded) {
+    // Diffs exported after the run are relative to the state left by parsing
+    checkpoint_emulator(emu);
+
+    // Batch runs restart from the state left by parsing, reset by a copy-on-write restore
+    EmulatorSnapshot* initial_state = run_count > 1 ? snapshot_emulator(emu) : NULL;
+
+    // Second pass: execute instructions using rip
+    if (tracing_enabled || reference_engine) {
+        // Tracing needs the per-instruction reference loop
+        for (uint64_t run = 0; run < run_count; run++) {
+            if (run > 0) restore_emulator(emu, initial_state);
+            run_instruction_loop(emu, instructions, instruction_count);
+        }
+    }
+    else {
+        DecodedProgram program;
+        if (!decoded) decode_program(&program, instructions, instruction_count, symbols);
+        for (uint64_t run = 0; run < run_count; run++) {
+            if (run > 0) restore_emulator(emu, initial_state);
+            run_decoded_program(emu, decoded ? decoded : &program);
+        }
+        if (!decoded) free_decoded_program(&program);
+    }
+    free_snapshot(initial_state);
+}
+
+// Function to assemble a source file and run it; a compiled program (.spx) is run without the assembler.
+// Returns false if the program could not be loaded and was not run.
+bool execute_file_instructions(Emulator* emu, const char* filename) {
+    if (is_compiled_program_file(filename)) {
+        return run_compiled_program(emu, filename);
+    }
+    AssembledProgram program;
+    bool assembled = assemble_source_file(emu, filename, &program);
+    if (assembled) {
+        run_program(emu, program.instructions, program.instruction_count, &program.symbols, NULL);
+    }
+    else {
+        fprintf(stderr, "Error: Program not executed because of label or data errors\n");
+    }
+    free_assembled_program(&program);
+    return assembled;
+}
+
+// Compiled program file (.spx) written by --compile: a program parsed, linked and decoded once, which runs
+// without the assembler. The file is mapped private and copy-on-write, and its sections are used in place:
+//   SpxHeader
+//   Instruction[instruction_count]   linked instructions (slow path, tracing and the reference engine)
+//   DecodedOp[op_count]              decoded ops with jump targets resolved to blocks; handler addresses are
+//                                    filled in when the program runs
+//   DecodedBlock[block_count]        basic blocks and their successors
+//   Symbol[symbol_count]             labels; names are offsets into the string table
+//   char[string_size]                interned label names
+//   SpxExtent[extent_count]          data image: each range of memory the data directives wrote
+//   extent bytes                     (none for an all-zero extent)
+// Sections are arrays of this build's structures in host byte order, 64-byte aligned. The header records the
+// format version and the structure sizes and enum counts, so a file only loads into a build that matches them.
+#define SPX_MAGIC "SPXPROG"      // 8 bytes with the terminator
+#define SPX_VERSION 1
+#define SPX_ALIGNMENT 64
+
+// Section of a compiled program file
+typedef struct {
+    uint64_t offset;             // From the start of the file
+    uint64_t count;              // Elements (bytes for the string table)
+} SpxSection;
+
+// Header of a compiled program file
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t instruction_size;   // Layout of the build that wrote the file
+    uint32_t op_size;
+    uint32_t block_size;
+    uint32_t symbol_size;
+    uint32_t opcode_count;       // OP_COUNT
+    uint32_t instruction_types;  // Entries of the opcode table
+    uint64_t file_size;
+    SpxSection instructions;
+    SpxSection ops;
+    SpxSection blocks;
+    SpxSection symbols;
+    SpxSection strings;
+    SpxSection extents;
+} SpxHeader;
+
+// Data image extent of a compiled program file
+typedef struct {
+    uint64_t address;
+    uint64_t length;
+    uint64_t offset;             // File offset of the bytes; 0 for an extent that is all zero
+} SpxExtent;
+
+// Function to fill in the layout fields of a compiled program header
+static void spx_layout(SpxHeader* header) {
+    memcpy(header->magic, SPX_MAGIC, sizeof(header->magic));
+    header->version = SPX_VERSION;
+    header->header_size = sizeof(SpxHeader);
+    header->instruction_size = sizeof(Instruction);
+    header->op_size = sizeof(DecodedOp);
+    header->block_size = sizeof(DecodedBlock);
+    header->symbol_size = sizeof(Symbol);
+    header->opcode_count = OP_COUNT;
+    header->instruction_types = (uint32_t)(sizeof(opcode_table) / sizeof(opcode_table[0]));
+}
+
+// Function to place a section of count elements of size bytes at the end of the file layout
+static SpxSection spx_section(uint64_t* file_size, uint64_t count, size_t size) {
+    SpxSection section;
+    section.offset = (*file_size + SPX_ALIGNMENT - 1) & ~(uint64_t)(SPX_ALIGNMENT - 1);
+    section.count = count;
+    *file_size = section.offset + count * size;
+    return section;
+}
+
+// Function to write zero padding up to a file offset
+static void spx_pad(FILE* file, uint64_t* written, uint64_t offset) {
+    static const uint8_t zeros[SPX_ALIGNMENT];
+    if (offset > *written) fwrite(zeros, 1, (size_t)(offset - *written), file);
+    *written = offset;
+}
+
+// Function to copy emulated memory into a buffer page by page; pages never written read as zero.
+// Returns true if any byte is non-zero.
+static bool read_data_image(Emulator* emu, uint64_t address, uint8_t* buffer, size_t length) {
+    bool nonzero = false;
+    while (length > 0) {
+        size_t offset = (size_t)(address & PAGE_OFFSET_MASK);
+        size_t chunk = (size_t)PAGE_SIZE - offset;
+        if (chunk > length) chunk = length;
+        const uint8_t* page = memory_page(emu, address, false);
+        if (page) {
+            memcpy(buffer, page + offset, chunk);
+            for (size_t i = 0; i < chunk && !nonzero; i++) nonzero = buffer[i] != 0;
+        }
+        else {
+            memset(buffer, 0, chunk);
+        }
+        address += chunk;
+        buffer += chunk;
+        length -= chunk;
+    }
+    return nonzero;
+}
+
+// Function to write an assembled program as a compiled program file. Returns false if it cannot be written.
+static bool write_compiled_program(Emulator* emu, AssembledProgram* assembled, const char* path) {
+    DecodedProgram program;
+    decode_program(&program, assembled->instructions, assembled->instruction_count, &assembled->symbols);
+
+    // Read the data image back from memory, now that label items are patched; all-zero extents keep no bytes
+    uint64_t image_bytes = 0;
+    for (size_t i = 0; i < assembled->data_extent_count; i++) image_bytes += assembled->data_extents[i].length;
+    uint8_t* image = malloc(image_bytes ? (size_t)image_bytes : 1);
+    SpxExtent* extents = calloc(assembled->data_extent_count ? assembled->data_extent_count : 1, sizeof(SpxExtent));
+    if (!image || !extents) {
+        fprintf(stderr, "Error: Memory allocation failed for the data image\n");
+        exit(1);
+    }
+
+    SpxHeader header;
+    memset(&header, 0, sizeof(header));
+    spx_layout(&header);
+    uint64_t file_size = sizeof(SpxHeader);
+    header.instructions = spx_section(&file_size, assembled->instruction_count, sizeof(Instruction));
+    header.ops = spx_section(&file_size, program.op_count, sizeof(DecodedOp));
+    header.blocks = spx_section(&file_size, program.block_count, sizeof(DecodedBlock));
+    header.symbols = spx_section(&file_size, assembled->symbols.count, sizeof(Symbol));
+    header.strings = spx_section(&file_size, assembled->symbols.strings_length, 1);
+    header.extents = spx_section(&file_size, assembled->data_extent_count, sizeof(SpxExtent));
+    uint8_t* bytes = image;
+    for (size_t i = 0; i < assembled->data_extent_count; i++) {
+        const DataExtent* extent = &assembled->data_extents[i];
+        extents[i].address = extent->address;
+        extents[i].length = extent->length;
+        if (read_data_image(emu, extent->address, bytes, (size_t)extent->length)) {
+            extents[i].offset = spx_section(&file_size, extent->length, 1).offset;
+        }
+        bytes += extent->length;
+    }
+    header.file_size = file_size;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open compiled program file %s\n", path);
+        free(image);
+        free(extents);
+        free_decoded_program(&program);
+        return false;
+    }
+    uint64_t written = sizeof(header);
+    fwrite(&header, sizeof(header), 1, file);
+
+    // Pointers and run-time state are cleared: handlers are resolved and tiers counted afresh by each run
+    spx_pad(file, &written, header.instructions.offset);
+    for (size_t i = 0; i < assembled->instruction_count; i++) {
+        Instruction inst = assembled->instructions[i];
+        inst.immediate_string = NULL;
+        fwrite(&inst, sizeof(inst), 1, file);
+    }
+    written += header.instructions.count * sizeof(Instruction);
+    spx_pad(file, &written, header.ops.offset);
+    for (size_t i = 0; i < program.op_count; i++) {
+        DecodedOp op = program.ops[i];
+        op.handler = NULL;
+        fwrite(&op, sizeof(op), 1, file);
+    }
+    written += header.ops.count * sizeof(DecodedOp);
+    spx_pad(file, &written, header.blocks.offset);
+    for (size_t i = 0; i < program.block_count; i++) {
+        DecodedBlock block = program.blocks[i];
+        block.entries = 0;
+        block.promote_at = 0;
+        block.tier = TIER_BASELINE;
+        block.native = NULL;
+        fwrite(&block, sizeof(block), 1, file);
+    }
+    written += header.blocks.count * sizeof(DecodedBlock);
+    spx_pad(file, &written, header.symbols.offset);
+    fwrite(assembled->symbols.symbols, sizeof(Symbol), assembled->symbols.count, file);
+    written += header.symbols.count * sizeof(Symbol);
+    spx_pad(file, &written, header.strings.offset);
+    fwrite(assembled->symbols.strings, 1, assembled->symbols.strings_length, file);
+    written += header.strings.count;
+    spx_pad(file, &written, header.extents.offset);
+    fwrite(extents, sizeof(SpxExtent), assembled->data_extent_count, file);
+    written += header.extents.count * sizeof(SpxExtent);
+    bytes = image;
+    for (size_t i = 0; i < assembled->data_extent_count; i++) {
+        if (extents[i].offset) {
+            spx_pad(file, &written, extents[i].offset);
+            fwrite(bytes, 1, (size_t)extents[i].length, file);
+            written += extents[i].length;
+        }
+        bytes += extents[i].length;
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write compiled program file %s\n", path);
+    }
+    else {
+        printf("Compiled %zu instructions (%zu ops, %zu blocks, %zu labels, %" PRIu64 " data bytes) into %s: %" PRIu64 " bytes\n",
+            assembled->instruction_count, program.op_count, program.block_count, assembled->symbols.count, image_bytes, path, file_size);
+    }
+    free(image);
+    free(extents);
+    free_decoded_program(&program);
+    return ok;
+}
+
+// Function to assemble a source file and write it as a compiled program file without running it
+bool compile_program_file(Emulator* emu, const char* source_path, const char* output_path) {
+    AssembledProgram program;
+    bool ok = assemble_source_file(emu, source_path, &program);
+    if (!ok) {
+        fprintf(stderr, "Error: Program not compiled because of label or data errors\n");
+    }
+    else {
+        ok = write_compiled_program(emu, &program, output_path);
+    }
+    free_assembled_program(&program);
+    return ok;
+}
+
+// Function to check whether a file is a compiled program (by its magic)
+bool is_compiled_program_file(const char* path) {
+    char magic[sizeof(((SpxHeader*)0)->magic)];
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    bool compiled = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, SPX_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return compiled;
+}
+
+// Function to check that a section lies inside the file and is aligned for its elements
+static bool spx_section_valid(const SpxSection* section, size_t size, uint64_t file_size) {
+    return section->offset % SPX_ALIGNMENT == 0 && section->offset <= file_size &&
+           section->count <= (file_size - section->offset) / size;
+}
+
+// Function to check that a string field is terminated inside its buffer
+#define SPX_TERMINATED(field) (memchr((field), '\0', sizeof(field)) != NULL)
+
+// Function to check that a memory operand's registers and scale are in range
+static bool spx_memory_operand_valid(const MemoryOperand* operand) {
+    return operand->base < 16 && operand->index < 16 && operand->scale_shift < 4 && SPX_TERMINATED(operand->label);
+}
+
+// Function to check the width of a vector access: 16 (XMM) or 32 (YMM) bytes, the size of the handlers' buffers
+static bool spx_vector_width_valid(unsigned bytes) {
+    return bytes == 16 || bytes == 32;
+}
+
+// Function to validate a mapped compiled program: the header must match this build, and every index the
+// engines follow without checks (blocks, ops, jump targets, registers, names) must be in range
+static bool validate_compiled_program(const uint8_t* base, size_t length, const char* path) {
+    const SpxHeader* header = (const SpxHeader*)base;
+    SpxHeader expected;
+    memset(&expected, 0, sizeof(expected));
+    spx_layout(&expected);
+    if (length < sizeof(SpxHeader) || memcmp(header->magic, SPX_MAGIC, sizeof(header->magic)) != 0) {
+        fprintf(stderr, "Error: %s is not a compiled program\n", path);
+        return false;
+    }
+    if (header->version != SPX_VERSION || header->header_size != expected.header_size ||
+        header->instruction_size != expected.instruction_size || header->op_size != expected.op_size ||
+        header->block_size != expected.block_size || header->symbol_size != expected.symbol_size ||
+        header->opcode_count != expected.opcode_count || header->instruction_types != expected.instruction_types) {
+        fprintf(stderr, "Error: %s was compiled by another version of the emulator (format %u); compile it again\n", path, header->version);
+        return false;
+    }
+    if (header->file_size != length ||
+        !spx_section_valid(&header->instructions, sizeof(Instruction), length) ||
+        !spx_section_valid(&header->ops, sizeof(DecodedOp), length) ||
+        !spx_section_valid(&header->blocks, sizeof(DecodedBlock), length) ||
+        !spx_section_valid(&header->symbols, sizeof(Symbol), length) ||
+        !spx_section_valid(&header->strings, 1, length) ||
+        !spx_section_valid(&header->extents, sizeof(SpxExtent), length) ||
+        header->ops.count == 0 || header->blocks.count == 0 || header->instructions.count >= UINT32_MAX) {
+        fprintf(stderr, "Error: Compiled program %s is truncated or damaged\n", path);
+        return false;
+    }
+
+    const Instruction* instructions = (const Instruction*)(base + header->instructions.offset);
+    const DecodedOp* ops = (const DecodedOp*)(base + header->ops.offset);
+    const DecodedBlock* blocks = (const DecodedBlock*)(base + header->blocks.offset);
+    const Symbol* symbols = (const Symbol*)(base + header->symbols.offset);
+    const char* strings = (const char*)(base + header->strings.offset);
+    const SpxExtent* extents = (const SpxExtent*)(base + header->extents.offset);
+    uint64_t instruction_count = header->instructions.count;
+    bool valid = true;
+    for (uint64_t i = 0; i < instruction_count && valid; i++) {
+        const Instruction* inst = &instructions[i];
+        valid = (unsigned)inst->type < header->instruction_types && inst->rep_prefix <= REP_NOT_EQUAL &&
+                inst->dest_reg.index < 16 && inst->src_reg.index < 16 && inst->aux_reg.index < 16 &&
+                inst->vector_dest < 16 && inst->vector_src < 16 &&
+                (opcode_table[inst->type].syntax == SYNTAX_VECTOR ? spx_vector_width_valid(inst->vector_bytes) : inst->vector_bytes == 0) &&
+                spx_memory_operand_valid(&inst->dest_address) && spx_memory_operand_valid(&inst->src_address) &&
+                spx_memory_operand_valid(&inst->aux_address) &&
+                (!is_jump_instruction(inst->type) || inst->target_address <= instruction_count) &&
+                SPX_TERMINATED(inst->label) && SPX_TERMINATED(inst->dest_reg_name) && SPX_TERMINATED(inst->src_reg_name) &&
+                SPX_TERMINATED(inst->aux_reg_name) && SPX_TERMINATED(inst->src_string);
+    }
+    // Only HALT and a fall-through into the HALT block stand after the last instruction; every other op's index
+    // is read back as an instruction by the slow path
+    const uint64_t kernel_count = sizeof(scalar_vector_kernels) / sizeof(scalar_vector_kernels[0]);
+    for (uint64_t i = 0; i < header->ops.count && valid; i++) {
+        const DecodedOp* op = &ops[i];
+        bool closes = op->opcode == OP_FALLTHROUGH || decoded_op_ends_block(op);
+        bool after_last = op->opcode == OP_HALT || op->opcode == OP_FALLTHROUGH;
+        valid = op->opcode < OP_COUNT && (op->index < instruction_count || (after_last && op->index == instruction_count)) &&
+                op->dst < 16 && op->src < 16 &&
+                (!closes || ((uint32_t)op->dst_value < header->blocks.count && (op->dst_value >> 32) < header->blocks.count));
+        switch (op->opcode) {
+        case OP_PACKED_V: case OP_PACKED_X:
+            valid = valid && op->dst_value < kernel_count && spx_vector_width_valid(op->form);
+            break;
+        case OP_VLOAD: case OP_VSTORE:
+            valid = valid && spx_vector_width_valid(op->form);
+            break;
+        default:
+            break;
+        }
+    }
+    // The last op closes its block, so no block runs off the end of the ops
+    const DecodedOp* last = &ops[header->ops.count - 1];
+    valid = valid && (last->opcode == OP_HALT || last->opcode == OP_FALLTHROUGH || decoded_op_ends_block(last));
+    for (uint64_t i = 0; i < header->blocks.count && valid; i++) {
+        const DecodedBlock* block = &blocks[i];
+        valid = block->first_op < header->ops.count && block->taken < header->blocks.count &&
+                block->fallthrough < header->blocks.count && (uint64_t)block->first + block->count <= instruction_count;
+    }
+    valid = valid && ops[blocks[header->blocks.count - 1].first_op].opcode == OP_HALT;
+    for (uint64_t i = 0; i < header->symbols.count && valid; i++) {
+        valid = symbols[i].name < header->strings.count && memchr(strings + symbols[i].name, '\0', (size_t)(header->strings.count - symbols[i].name)) != NULL;
+    }
+    for (uint64_t i = 0; i < header->extents.count && valid; i++) {
+        valid = extents[i].offset == 0 || (extents[i].offset <= length && extents[i].length <= length - extents[i].offset);
+    }
+    if (!valid) {
+        fprintf(stderr, "Error: Compiled program %s is damaged\n", path);
+    }
+    return valid;
+}
+
+// Function to run a compiled program file: maps it, writes its data image into memory and runs its decoded
+// ops in place, without the assembler. Returns false if the file cannot be loaded.
+bool run_compiled_program(Emulator* emu, const char* path) {
+    double start = host_time_seconds();
+    size_t length;
+    // Private and copy-on-write: ops and blocks are updated in place as the tiers promote them, and those
+    // pages become private copies
+    void* view;
+    if (!map_file_private(path, true, false, &view, &length) || !view) {
+        fprintf(stderr, "Error: Could not map compiled program %s\n", path);
+        return false;
+    }
+    uint8_t* base = view;
+    if (!validate_compiled_program(base, length, path)) {
+        unmap_file(base, length);
+        return false;
+    }
+    const SpxHeader* header = (const SpxHeader*)base;
+
+    // Data image
+    const SpxExtent* extents = (const SpxExtent*)(base + header->extents.offset);
+    for (uint64_t i = 0; i < header->extents.count; i++) {
+        if (extents[i].address > emu->memory_size || extents[i].length > emu->memory_size - extents[i].address) {
+            fprintf(stderr, "Error: Data of compiled program %s does not fit in memory at 0x%" PRIx64 "\n", path, extents[i].address);
+            unmap_file(base, length);
+            return false;
+        }
+        write_memory_block(emu, extents[i].address, extents[i].offset ? base + extents[i].offset : NULL, (size_t)extents[i].length);
+    }
+
+    // Labels without a hash index: only the decoder's block leaders read them
+    SymbolTable symbols;
+    memset(&symbols, 0, sizeof(symbols));
+    symbols.symbols = (Symbol*)(base + header->symbols.offset);
+    symbols.count = (size_t)header->symbols.count;
+    symbols.strings = (char*)(base + header->strings.offset);
+    symbols.strings_length = (size_t)header->strings.count;
+
+    Instruction* instructions = (Instruction*)(base + header->instructions.offset);
+    DecodedProgram program;
+    memset(&program, 0, sizeof(program));
+    program.ops = (DecodedOp*)(base + header->ops.offset);
+    program.op_count = (size_t)header->ops.count;
+    program.blocks = (DecodedBlock*)(base + header->blocks.offset);
+    program.block_count = (size_t)header->blocks.count;
+    program.threaded = false;
+    program.instructions = instructions;
+    program.instruction_count = (size_t)header->instructions.count;
+    LOG_INFO("Loaded compiled program %s (%zu instructions, %zu ops) in %.3f ms\n", path, program.instruction_count,
+        program.op_count, (host_time_seconds() - start) * 1e3);
+
+    run_program(emu, instructions, program.instruction_count, &symbols, &program);
+#ifdef JIT_SUPPORTED
+    jit_release(&program);
+#endif
+    unmap_file(base, length);
+    return true;
+}
+
+
+// Advanced memory operation demonstration
+void demonstrate_memory_operations(Emulator* emu) {
+    // Write to memory
+    uint64_t value = 0xDEADBEEFCAFEBABE;
+    write_memory(emu, 0, value, sizeof(value));
+    LOG_TRACE("Memory Operation: Written 0x%016" PRIx64 " to memory address 0x0\n", value);
+
+    // Simulate stack operations
+    Instruction stack_instructions[] = {
+        {INST_PUSH, "", REG64(REG_RAX), REG_NONE, REG_NONE, 0, HEX},  // Push RAX to stack (Hex)
+        {INST_POP, "", REG64(REG_RBX), REG_NONE, REG_NONE, 0, HEX}    // Pop top of stack to RBX (Hex)
+    };
+
+    size_t stack_instruction_count = sizeof(stack_instructions) / sizeof(Instruction);
+    for (size_t i = 0; i < stack_instruction_count; i++) {
+        execute_instruction(emu, &stack_instructions[i], i + 1);
+    }
+}
+
+void run_comprehensive_example(Emulator* emu) {
+    // Function implementation
+    // Example:
+    // Labels for jumps are added to a symbol table from the LABEL entries of the list below
+
+    // Define a list of instructions
+    Instruction instructions[] = {
+        // Data Movement
+        {INST_MOV, "", REG64(REG_RAX), REG_NONE, REG_NONE, 0xA, HEX},          // rax = 0xA (10 in hex)
+        {INST_MOV, "", REG64(REG_RBX), REG_NONE, REG_NONE, 0x5, HEX},          // rbx = 0x5
+        {INST_MOV, "", REG64(REG_RCX), REG_NONE, REG_NONE, 0x3, HEX},          // rcx = 0x3
+
+        // Arithmetic
+        {INST_ADD, "", REG64(REG_RAX), REG64(REG_RBX), REG_NONE, 0, HEX},       // rax = rax + rbx
+        {INST_SUB, "", REG64(REG_RAX), REG_NONE, REG_NONE, 0x2, HEX},          // rax = rax - 0x2
+
+        // Continuing the example program
+        {INST_MUL, "", REG64(REG_RAX), REG64(REG_RCX), REG_NONE, 0, HEX},       // rax = rax * rcx
+
+        // Custom Instructions
+
+        // MIRROR Instruction
+        {INST_MIRROR, "", REG64(REG_RDX), REG64(REG_RAX), REG_NONE, 0, HEX},    // rdx = mirror of rax
+
+        // MOD Instruction
+        {INST_MOD, "", REG64(REG_RAX), REG_NONE, REG_NONE, 0x4, HEX},          // rax = rax % 0x4
+
+        // POW Instruction
+        {INST_POW, "", REG64(REG_RAX), REG_NONE, REG_NONE, 0x2, HEX},          // rax = rax ^ 0x2
+
+        // ROOT instruction (cube root of rax)
+        {INST_ROOT, "", REG64(REG_RDX), REG64(REG_RAX), REG64(REG_RCX), 0, HEX}, // rdx = cube root of rax
+
+        // AVG instruction
+        {INST_AVG, "", REG64(REG_RCX), REG64(REG_RAX), REG64(REG_RBX), 0, HEX},  // rcx = average of rax, rbx, rcx
+
+        // MAX instruction
+        {INST_MAX, "", REG64(REG_RCX), REG64(REG_RAX), REG64(REG_RBX), 0, HEX},  // rcx = max of rax, rbx, rcx
+
+        // MIN instruction
+        {INST_MIN, "", REG64(REG_RCX), REG64(REG_RAX), REG64(REG_RBX), 0, HEX},  // rcx = min of rax, rbx, rcx
+
+        // ISPRIME Instruction
+        {INST_ISPRIME, "", REG64(REG_RDI), REG64(REG_RAX), REG_NONE, 0, HEX},  // rdi = 0 as rax = 0xA (10 in hex)
+
+        // Logical Operations
+        {INST_AND, "", REG64(REG_RAX), REG64(REG_RBX), REG_NONE, 0, HEX},      // Bitwise AND
+
+        // Comparison and Conditional Jump
+        {INST_CMP, "", REG64(REG_RBX), REG64(REG_RCX), REG_NONE, 0, HEX},      // Compare rbx and rcx
+        {INST_JE, "END", REG_NONE, REG_NONE, REG_NONE, 0, HEX},               // Jump to END if equal
+        {INST_ADD, "", REG64(REG_RCX), REG64(REG_RBX), REG_NONE, 0, HEX},       // rcx = rcx + rbx
+        {INST_LABEL, "END", REG_NONE, REG_NONE, REG_NONE, 0, HEX},            // Label: END
+        {INST_NOP, "", REG_NONE, REG_NONE, REG_NONE, 0, HEX}                  // NOP
+    };
+
+    size_t instruction_count = sizeof(instructions) / sizeof(Instruction);
+
+    // Add labels to the symbol table
+    SymbolTable symbols;
+    memset(&symbols, 0, sizeof(symbols));
+    for (size_t i = 0; i < instruction_count; i++) {
+        if (instructions[i].type == INST_LABEL) {
+            define_symbol(&symbols, view_of(instructions[i].label), SYMBOL_CODE, i, 0);
+        }
+    }
+
+    // Resolve jump targets before running
+    link_program(instructions, instruction_count, &symbols);
+
+    // Execute instructions using rip
+    emu->rip = 0;
+    while (emu->rip < instruction_count) {
+        Instruction* current_inst = &instructions[emu->rip];
+        execute_instruction(emu, current_inst, emu->rip);
+
+        // Jumps update rip themselves
+        if (!is_jump_instruction(current_inst->type)) {
+            emu->rip++; // Move to the next instruction
+        }
+    }
+    free_symbol_table(&symbols);
+
+    // Note: Final emulator state will be printed by main function based on mode
+}
+
+// Function to parse a --log-level name
+LogLevel parse_log_level(const char* name) {
+    static const char* const level_names[] = { "error", "warn", "info", "trace" };
+    for (int level = LOG_LEVEL_ERROR; level <= LOG_LEVEL_TRACE; level++) {
+        if (strcasecmp(name, level_names[level]) == 0) {
+            return (LogLevel)level;
+        }
+    }
+    fprintf(stderr, "Error: Unknown log level '%s' (expected error, warn, info or trace)\n", name);
+    exit(1);
+}
+
+// Function to parse the unsigned number (decimal, 0x hex or 0 octal) given to a numeric option
+uint64_t parse_number_option(const char* option, const char* text) {
+    char* end;
+    errno = 0;
+    uint64_t value = strtoull(text, &end, 0);
+    if (end == text || *end != '\0' || errno == ERANGE || strchr(text, '-')) {
+        fprintf(stderr, "Error: Invalid value '%s' for %s (expected an unsigned number)\n", text, option);
+        exit(1);
+    }
+    return value;
+}
+
+// Function to parse a --simd instruction set name
+VectorIsa parse_vector_isa(const char* name) {
+    static const char* const isa_names[] = { "scalar", "sse2", "avx2" };
+    for (int isa = VECTOR_ISA_SCALAR; isa <= VECTOR_ISA_AVX2; isa++) {
+        if (strcasecmp(name, isa_names[isa]) == 0) {
+            return (VectorIsa)isa;
+        }
+    }
+    fprintf(stderr, "Error: Unknown vector instruction set '%s' (expected scalar, sse2 or avx2)\n", name);
+    exit(1);
+}
+
+// Main function to demonstrate emulator capabilities
+int main(int argc, char* argv[]) {
+
+    // Parse command-line options; the first non-option argument is the instruction file
+    const char* file_arg = NULL;
+    bool log_level_set = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            stats_enabled = true;
+        }
+        else if (strcmp(argv[i], "--reference") == 0) {
+            reference_engine = true;
+        }
+        else if (strcmp(argv[i], "--no-jit") == 0) {
+            jit_enabled = false;
+        }
+        else if (strcmp(argv[i], "--optimize-threshold") == 0 && i + 1 < argc) {
+            optimize_threshold = parse_number_option("--optimize-threshold", argv[++i]);
+        }
+        else if (strcmp(argv[i], "--jit-threshold") == 0 && i + 1 < argc) {
+            jit_threshold = parse_number_option("--jit-threshold", argv[++i]);
+        }
+        else if (strcmp(argv[i], "--max-instructions") == 0 && i + 1 < argc) {
+            instruction_limit = parse_number_option("--max-instructions", argv[++i]);
+        }
+        else if (strcmp(argv[i], "--memory-size") == 0 && i + 1 < argc) {
+            address_space_size = parse_number_option("--memory-size", argv[++i]);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            run_count = parse_number_option("--repeat", argv[++i]);
+            if (run_count == 0) run_count = 1;
+        }
+        else if (strcmp(argv[i], "--diff-out") == 0 && i + 1 < argc) {
+            diff_output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stack-base") == 0 && i + 1 < argc) {
+            stack_base_address = parse_number_option("--stack-base", argv[++i]);
+        }
+        else if (strcmp(argv[i], "--load-image") == 0 && i + 1 < argc) {
+            // FILE or FILE@ADDR; the address defaults to 0
+            static char image_path[1024];
+            snprintf(image_path, sizeof(image_path), "%s", argv[++i]);
+            char* at = strrchr(image_path, '@');
+            if (at) {
+                *at = '\0';
+                image_load_address = parse_number_option("--load-image", at + 1);
+            }
+            image_load_path = image_path;
+        }
+        else if (strcmp(argv[i], "--dump-memory") == 0 && i + 1 < argc) {
+            memory_dump_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            log_level = parse_log_level(argv[++i]);
+            log_level_set = true;
+        }
+        else if (strcmp(argv[i], "--simd") == 0 && i + 1 < argc) {
+            vector_isa_limit = parse_vector_isa(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--compile") == 0 && i + 1 < argc) {
+            compile_output_path = argv[++i];
+        }
+        else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--stats] [--reference] [--no-jit] [--optimize-threshold N] [--jit-threshold N] [--max-instructions N] [--memory-size BYTES] [--stack-base ADDR] [--load-image FILE[@ADDR]] [--dump-memory FILE] [--repeat N] [--diff-out FILE] [--log-level error|warn|info|trace] [--simd scalar|sse2|avx2] [--compile OUT.spx] [file.asm|file.spx]\n", argv[0]);
+            exit(1);
+        }
+        else if (!file_arg) {
+            file_arg = argv[i];
+        }
+    }
+
+    // Create emulator with a sparse address space; the stack lives in it
+    Emulator* emu = create_emulator(address_space_size, STACK_SIZE);
+    if (stack_base_address != UINT64_MAX) {
+        set_stack_region(emu, stack_base_address, emu->stack_size);
+    }
+    if (image_load_path) {
+        double start = host_time_seconds();
+        if (!load_memory_image(emu, image_load_path, image_load_address)) {
+            exit(1);
+        }
+        LOG_INFO("Mapped memory image %s at 0x%" PRIx64 " in %.1f us\n", image_load_path, image_load_address,
+            (host_time_seconds() - start) * 1e6);
+    }
+
+    // Prepare The INTs
+    initialize_interrupt_handlers();
+
+    // Packed instructions use the widest host vector unit allowed
+    VectorIsa vector_isa = select_vector_kernels(vector_isa_limit);
+    LOG_INFO("Vector kernels: %s\n", vector_isa_names[vector_isa]);
+
+    // Compile mode writes the source file as a compiled program and does not run it
+    if (compile_output_path) {
+        if (!file_arg) {
+            fprintf(stderr, "Error: --compile needs a source file\n");
+            destroy_emulator(emu);
+            exit(1);
+        }
+        bool compiled = compile_program_file(emu, file_arg, compile_output_path);
+        destroy_emulator(emu);
+        return compiled ? 0 : 1;
+    }
+
+    // User interaction for tracing and file input
+    char mode;
+    char filename[256] = "";
+
+    printf("Choose mode:\n");
+    printf("T - Trace execution (show states before and after each instruction)\n");
+    printf("R - Run without tracing\n");
+    printf("Enter mode (T/R): ");
+
+    // Check return value of scanf
+    if (scanf(" %c", &mode) != 1) {
+        fprintf(stderr, "Error: Failed to read mode. Defaulting to Run without tracing.\n");
+        tracing_enabled = false;
+    }
+    else {
+        if (mode == 'T' || mode == 't') {
+            tracing_enabled = true;
+        }
+        else if (mode == 'R' || mode == 'r') {
+            tracing_enabled = false;
+        }
+        else {
+            fprintf(stderr, "Invalid mode selected. Defaulting to Run without tracing.\n");
+            tracing_enabled = false;
+        }
+    }
+
+    // Trace mode shows every instruction's log messages unless a level was given explicitly
+    if (tracing_enabled && !log_level_set) {
+        log_level = LOG_LEVEL_TRACE;
+    }
+
+    // Clear input buffer to handle next input correctly
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+
+    // Check for filename argument
+    if (file_arg) {
+        strncpy(filename, file_arg, sizeof(filename) - 1);
+        filename[sizeof(filename) - 1] = '\0';
+    }
+    else {
+        printf("Enter the path to the .asm file (or press Enter to skip): ");
+        if (fgets(filename, sizeof(filename), stdin) != NULL) {
+            // Remove newline character
+            filename[strcspn(filename, "\r\n")] = 0;
+        }
+    }
+
+    // Prevent executing the emulator executable as an instruction file
+    if (strlen(filename) > 0) {
+        // Get the executable's filename
+        const char* exec_name = argv[0];
+        // Extract the basename
+        const char* base_exec = strrchr(exec_name, '\\');
+        if (!base_exec) base_exec = strrchr(exec_name, '/');
+        if (base_exec) base_exec++; else base_exec = exec_name;
+
+        // Extract the basename from the user-provided filename
+        const char* user_base = strrchr(filename, '\\');
+        if (!user_base) user_base = strrchr(filename, '/');
+        if (user_base) user_base++; else user_base = filename;
+
+        // Compare case-insensitively
+        if (strcasecmp(base_exec, user_base) == 0) {
+            fprintf(stderr, "Error: The instruction file cannot be the emulator executable.\n");
+            destroy_emulator(emu);
+            exit(1);
+        }
+    }
+
+    if (strlen(filename) > 0) {
+        printf("\n=== Executing Instructions from File: %s ===\n", filename);
+        if (!execute_file_instructions(emu, filename)) {
+            // Nothing ran, so there is no state, diff or dump to report
+            destroy_emulator(emu);
+            return 1;
+        }
+    }
+    else {
+        printf("\n=== Running Comprehensive Emulator Example ===\n");
+        run_comprehensive_example(emu);
+    }
+
+    // Demonstrate memory and stack operations
+    // Uncomment the following line to demonstrate memory operations
+    // demonstrate_memory_operations(emu);
+
+    // If not tracing, print the final state
+    if (!tracing_enabled) {
+        printf("\n=== Final Emulator State ===\n");
+        print_emulator_state(emu, "Final State");
+    }
+
+    if (stats_enabled) {
+        print_execution_stats(emu);
+    }
+
+    if (diff_output_path) {
+        export_state_diff(emu, diff_output_path);
+    }
+
+    if (memory_dump_path && !memory_dumped_by_program) {
+        dump_memory_image(emu, memory_dump_path, 0, memory_image_end(emu));
+    }
+
+    // Clean up
+    destroy_emulator(emu);
+#endif
+    return 0;
+
+}